@@ -3,125 +3,178 @@
  *
  * Created: 21.06.2017 12:50:56
  *  Author: mburger
- */ 
+ */
  #include <avr/io.h>
  #include "ButtonHandler.h"
+#if BUTTON_USE_INTERRUPTS == 1
+ #include <avr/interrupt.h>
+ #include "task.h"
+ #include "queue.h"
+ #include "timers.h"
+ #include "benchClock.h"
+#endif
 
- #define Button1_Value (PORTF.IN & PIN4_bm) >> PIN4_bp
- #define Button2_Value (PORTF.IN & PIN5_bm) >> PIN5_bp
- #define Button3_Value (PORTF.IN & PIN6_bm) >> PIN6_bp
- #define Button4_Value (PORTF.IN & PIN7_bm) >> PIN7_bp
+ typedef struct {
+	PORT_t *port;
+	uint8_t pin_bm;		// low active
+ } buttonPin_t;
 
- #define BUTTON_PRESS_SHORT			100
- #define BUTTON_PRESS_LONG			500
+ // One entry per button, index = button_t. With interrupts all of them have to be on PORTF.
+ static const buttonPin_t buttonPins[BUTTON_COUNT] = {
+	{&PORTF, PIN4_bm}, //SW1
+	{&PORTF, PIN5_bm}, //SW2
+	{&PORTF, PIN6_bm}, //SW3
+	{&PORTF, PIN7_bm}, //SW4
+ };
 
- 
+ static buttonEngine_t buttonEngine;
 
- void initButtons(void) {
-	PORTF.DIRCLR = PIN4_bm; //SW1
-	PORTF.DIRCLR = PIN5_bm; //SW2
-	PORTF.DIRCLR = PIN6_bm; //SW3
-	PORTF.DIRCLR = PIN7_bm; //SW4
+ // Bit n set: button n is pressed right now (not debounced)
+ static uint8_t readButtons(void) {
+	uint8_t sample = 0;
+	for(uint8_t b = 0; b < BUTTON_COUNT; b++) {
+		if((buttonPins[b].port->IN & buttonPins[b].pin_bm) == 0) {
+			sample |= 1 << b;
+		}
+	}
+	return sample;
  }
 
- button_press_t b1Status;
- button_press_t b2Status;
- button_press_t b3Status;
- button_press_t b4Status;
+#if BUTTON_USE_INTERRUPTS == 1
+ #define BUTTON_SAMPLE_PERIOD_MS	BUTTON_SAMPLE_MS
 
- void updateButtons(void) {
-	static uint16_t b1Count = 0;
-	static uint16_t b2Count = 0;
-	static uint16_t b3Count = 0;
-	static uint16_t b4Count = 0;
-	if(Button1_Value == 0) {
-		if(b1Count < 60000) {
-			b1Count++;
-		}
-	} else {
-		if(b1Count > (BUTTON_PRESS_SHORT / (1000/BUTTON_UPDATE_FREQUENCY_HZ))) {
-			if(b1Count > (BUTTON_PRESS_LONG / (1000/BUTTON_UPDATE_FREQUENCY_HZ))) {
-				//Button was pressed Long
-				b1Status = LONG_PRESSED;
-			} else {
-				//Button was pressed Short	
-				b1Status = SHORT_PRESSED;
-			}
-		} else {
-			b1Status = NOT_PRESSED;
-		}
-		b1Count = 0;
+ static void buttonTimerCallback(TimerHandle_t timer);
+
+ static QueueHandle_t buttonQueue;
+ static StaticQueue_t buttonQueueBuffer;
+ static uint8_t buttonQueueStorage[BUTTON_QUEUE_DEPTH * sizeof(buttonEvent_t)];
+ static TimerHandle_t buttonTimer;
+ static StaticTimer_t buttonTimerBuffer;
+ static buttonStats_t buttonStats;
+ static volatile uint8_t buttonSampling = 0;	// timer is running or about to
+ static volatile uint8_t buttonEdgePending = 0;	// buttonEdgeCycles holds an edge the timer has not taken yet
+ static uint32_t buttonEdgeCycles;				// bench clock (low 32 bit) of the first edge since the last sample
+#else
+ #define BUTTON_SAMPLE_PERIOD_MS	(1000 / BUTTON_UPDATE_FREQUENCY_HZ)
+
+ static button_press_t buttonStatus[BUTTON_COUNT];
+#endif
+
+ void initButtons(void) {
+	for(uint8_t b = 0; b < BUTTON_COUNT; b++) {
+		buttonPins[b].port->DIRCLR = buttonPins[b].pin_bm;
 	}
-	if(Button2_Value == 0) {
-		if(b2Count < 60000) {
-			b2Count++;
+	buttonEngineInit(&buttonEngine, BUTTON_COUNT, BUTTON_LONG_MS / BUTTON_SAMPLE_PERIOD_MS,
+		BUTTON_REPEAT_MS / BUTTON_SAMPLE_PERIOD_MS, BUTTON_CHORD_MS / BUTTON_SAMPLE_PERIOD_MS);
+#if BUTTON_USE_INTERRUPTS == 1
+	buttonQueue = xQueueCreateStatic(BUTTON_QUEUE_DEPTH, sizeof(buttonEvent_t), buttonQueueStorage, &buttonQueueBuffer);
+	buttonTimer = xTimerCreateStatic("buttons", BUTTON_SAMPLE_MS / portTICK_RATE_MS, pdFALSE, NULL, buttonTimerCallback, &buttonTimerBuffer);
+	for(uint8_t b = 0; b < BUTTON_COUNT; b++) {
+		volatile uint8_t *pinCtrl = &buttonPins[b].port->PIN0CTRL;
+		uint8_t pin = 0;
+		while(!(buttonPins[b].pin_bm & (1 << pin))) {
+			pin++;
 		}
-	} else {
-		if(b2Count > (BUTTON_PRESS_SHORT / (1000/BUTTON_UPDATE_FREQUENCY_HZ))) {
-			if(b2Count > (BUTTON_PRESS_LONG / (1000/BUTTON_UPDATE_FREQUENCY_HZ))) {
-				//Button was pressed Long
-				b2Status = LONG_PRESSED;
-				} else {
-				//Button was pressed Short
-				b2Status = SHORT_PRESSED;
-			}
-		} else {
-			b2Status = NOT_PRESSED;			
-		}
-		b2Count = 0;
+		pinCtrl[pin] = (pinCtrl[pin] & ~PORT_ISC_gm) | PORT_ISC_BOTHEDGES_gc;
+		buttonPins[b].port->INT0MASK |= buttonPins[b].pin_bm;
 	}
-	if(Button3_Value == 0) {
-		if(b3Count < 60000) {
-			b3Count++;
-		}
-	} else {
-		if(b3Count > (BUTTON_PRESS_SHORT / (1000/BUTTON_UPDATE_FREQUENCY_HZ))) {
-			if(b3Count > (BUTTON_PRESS_LONG / (1000/BUTTON_UPDATE_FREQUENCY_HZ))) {
-				//Button was pressed Long
-				b3Status = LONG_PRESSED;
-				} else {
-				//Button was pressed Short
-				b3Status = SHORT_PRESSED;
-			}
+	PORTF.INTFLAGS = PORT_INT0IF_bm;
+	PORTF.INTCTRL = (PORTF.INTCTRL & ~PORT_INT0LVL_gm) | PORT_INT0LVL_LO_gc;
+#endif
+ }
+
+#if BUTTON_USE_INTERRUPTS == 1
+ // Any edge on a button starts the sampling, the timer keeps itself running
+ // until the engine is idle again. Bounces while sampling only count edges.
+ // The first edge since the last sample is timestamped for the latency.
+ ISR(PORTF_INT0_vect) {
+	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+	buttonStats.edges++;
+	if(!buttonEdgePending) {
+		buttonEdgeCycles = (uint32_t) ullBenchClockCycles();
+		buttonEdgePending = 1;
+	}
+	if(!buttonSampling) {
+		buttonSampling = 1;
+		xTimerStartFromISR(buttonTimer, &xHigherPriorityTaskWoken);
+	}
+ }
+
+ // Runs in the timer daemon every BUTTON_SAMPLE_MS while a button is touched.
+ // Event timestamps are the bench clock of the edge (buttonEngine.h). An edge
+ // between taking it and reading the pins falls back to the time of the sample.
+ static void buttonTimerCallback(TimerHandle_t timer) {
+	buttonEvent_t events[3 * BUTTON_COUNT];
+	uint8_t count;
+	uint32_t now = (uint32_t) ullBenchClockCycles();
+	uint32_t edge = now;
+
+	taskENTER_CRITICAL();
+	if(buttonEdgePending) {
+		edge = buttonEdgeCycles;
+		buttonEdgePending = 0;
+	}
+	taskEXIT_CRITICAL();
+	count = buttonEngineSample(&buttonEngine, readButtons(), now, edge, events, 3 * BUTTON_COUNT);
+	buttonStats.debounceRuns++;
+	for(uint8_t i = 0; i < count; i++) {
+		if(xQueueSend(buttonQueue, &events[i], 0) == pdPASS) {
+			buttonStats.events++;
 		} else {
-			b3Status = NOT_PRESSED;
+			buttonStats.dropped++;
 		}
-		b3Count = 0;
 	}
-	if(Button4_Value == 0) {
-		if(b4Count < 60000) {
-			b4Count++;
-		}
-	} else {
-		if(b4Count > (BUTTON_PRESS_SHORT / (1000/BUTTON_UPDATE_FREQUENCY_HZ))) {
-			if(b4Count > (BUTTON_PRESS_LONG / (1000/BUTTON_UPDATE_FREQUENCY_HZ))) {
-				//Button was pressed Long
-				b4Status = LONG_PRESSED;
-				} else {
-				//Button was pressed Short
-				b4Status = SHORT_PRESSED;
-			}
-		} else {
-			b4Status = NOT_PRESSED;
+	if(!buttonEngineIdle(&buttonEngine)) {
+		xTimerStart(timer, 0);
+		return;
+	}
+	taskENTER_CRITICAL();
+	buttonSampling = 0;
+	taskEXIT_CRITICAL();
+	if(readButtons() != 0) {
+		// pressed between the sample and clearing buttonSampling, the ISR did not start the timer
+		buttonSampling = 1;
+		xTimerStart(timer, 0);
+	}
+ }
+
+ BaseType_t getButtonEvent(buttonEvent_t *event, TickType_t ticksToWait) {
+	return xQueueReceive(buttonQueue, event, ticksToWait);
+ }
+
+ void getButtonStats(buttonStats_t *stats) {
+	taskENTER_CRITICAL();
+	*stats = buttonStats;
+	taskEXIT_CRITICAL();
+ }
+#endif
+
+ void updateButtons(void) {
+#if BUTTON_USE_INTERRUPTS == 0
+	static uint32_t sampleCount = 0;
+	buttonEvent_t events[3 * BUTTON_COUNT];
+	uint8_t count;
+
+	for(uint8_t b = 0; b < BUTTON_COUNT; b++) {
+		buttonStatus[b] = NOT_PRESSED;
+	}
+	count = buttonEngineSample(&buttonEngine, readButtons(), sampleCount, sampleCount, events, 3 * BUTTON_COUNT);
+	sampleCount++;
+	for(uint8_t i = 0; i < count; i++) {
+		if(events[i].type == BUTTON_EVENT_SHORT) {
+			buttonStatus[events[i].button] = SHORT_PRESSED;
+		} else if(events[i].type == BUTTON_EVENT_LONG) {
+			buttonStatus[events[i].button] = LONG_PRESSED;
 		}
-		b4Count = 0;
 	}
+#endif
  }
 
  button_press_t getButtonPress(button_t button) {
-	switch(button) {
-		case BUTTON1:
-			return b1Status;
-		break;
-		case BUTTON2:
-			return b2Status;
-		break;
-		case BUTTON3:
-			return b3Status;
-		break;
-		case BUTTON4:
-			return b4Status;
-		break;
+#if BUTTON_USE_INTERRUPTS == 0
+	if(button < BUTTON_COUNT) {
+		return buttonStatus[button];
 	}
+#endif
 	return NOT_PRESSED;
- }
\ No newline at end of file
+ }
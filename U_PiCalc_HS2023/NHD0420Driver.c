@@ -8,7 +8,9 @@
 //  #include <avr/interrupt.h>
 #include <stdarg.h>
 #include <string.h>
+#include <stdlib.h>
 #include "avr_compiler.h"
+#include <util/delay.h>
 //#include "pmic_driver.h"
 #include "TC_driver.h"
 //#include "clksys_driver.h"
@@ -22,76 +24,231 @@
 //#include "stack_macros.h"
 
 #include "NHD0420Driver.h"
+#include "NHD0420Hal.h"
+#include "traceRecorder.h"
+#include "stackConfig.h"
+#include "errorHandler.h"
+#include "init.h"
  
 #define EG_DISPLAY_DELAY 1
 #define EG_DISPLAY_CLEAR 2
 EventGroupHandle_t egDisplayTiming;
-
+static StaticEventGroup_t egDisplayTimingBuffer;
+
+#if DISPLAY_USE_FRAMEBUFFER == 1
+// Writers format on their own stack and copy the text into this framebuffer inside a
+// critical section, then bump the sequence counter of the line. The display task
+// copies a line without blocking anybody and takes it again if the counter moved.
+static char displayFrame[4][20];
+static volatile uint8_t displayFrameSeq[4];
+#else
 xQueueHandle displayLineQueue;
+static StaticQueue_t displayLineQueueBuffer;
+static uint8_t displayLineQueueStorage[DISPLAY_QUEUE_DEPTH * sizeof(displayLine_t)];
+// Writes that found the queue full are merged into this per-line buffer instead of
+// blocking. Until the display task applied it, all writes go there so the order of
+// the writes is kept. The last write to a cell wins.
+static char displayLate[4][20];
+static uint32_t displayLateMask[4];		// bit n: cell n holds a late write
+static uint8_t displayLateActive = 0;
+#endif
+static uint8_t displayLinePending = 0;	// bit n: line n was written in this refresh window
+
+static StaticTask_t displayTcb;
+static StackType_t displayStack[STACK_SIZE_DISPLAY];
+
+// DDRAM start address of each line
+static const uint8_t displayLineAddress[4] = {0x00, 0x40, 0x14, 0x54};
+static uint8_t displayCursor = 0xFF;	// DDRAM address the controller writes to next, 0xFF = unknown
+static displayStats_t displayStats;
+static uint16_t displayFrameBytes;
+static uint8_t displayBusyFlagReady = 0;	// Set after the init sequence, cleared if the busy flag never clears
+static TaskHandle_t displayTask = NULL;
+#if DISPLAY_DELAY_NOTIFY == 1
+static TaskHandle_t displayDelayTask = NULL;	// task waiting in delayUS, woken by the TCF0 ISR
+#endif
+
+#if DISPLAY_USE_TX_ENGINE == 1
+// Transmit engine: the TCF0 overflow ISR clocks one nibble per interrupt out of
+// this ring and reprograms TCF0 with the wait the controller needs afterwards.
+#define TX_FLAG_RS		0x01	// data register (character) instead of command
+#define TX_FLAG_LONG	0x02	// wait is in DIV1024 counts instead of DIV64 counts (32us / 2us at 32MHz)
+#define TX_STATE_HIGH	0		// next interrupt sends the high nibble of the tail entry
+#define TX_STATE_LOW	1		// next interrupt sends the low nibble
+
+typedef struct {
+	uint8_t value;
+	uint8_t flags;
+	uint8_t wait;
+} displayTxOp_t;
+
+static displayTxOp_t displayTxRing[DISPLAY_TX_BUFFER_SIZE];
+static volatile uint8_t displayTxHead = 0;		// written by the task
+static volatile uint8_t displayTxTail = 0;		// written by the ISR
+static volatile uint8_t displayTxState = TX_STATE_HIGH;
+static volatile uint8_t displayTxActive = 0;	// ISR owns TCF0
+static uint8_t displayTxReady = 0;				// init sequence done, frames go through the engine
+#endif
 
  
-static void ftoa_fixed(char *buffer, double value);
 static void ftoa_sci(char *buffer, double value);
 
 void vDisplayUpdateTask(void *pvParameters);
 static int display_vprintf(int line, int pos, char const *fmt, va_list arg);
 
 
+#if DISPLAY_USE_TX_ENGINE == 1
+static void _displayTxStep(BaseType_t *pxHigherPriorityTaskWoken);
+#endif
+static uint32_t _displayElapsedUS(TickType_t startTick, uint16_t startCnt);
+
 ISR(TCF0_OVF_vect) {
 	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-	xEventGroupSetBitsFromISR(egDisplayTiming, EG_DISPLAY_DELAY,&xHigherPriorityTaskWoken);
-	TC0_ConfigClockSource(&TCF0, TC_CLKSEL_OFF_gc); //Disable Timer
-	TCF0.INTCTRLA = 0x00;
+	traceISR_ENTER(TRACE_ISR_DISPLAY_TIMER);
+#if DISPLAY_USE_TX_ENGINE == 1
+	if(displayTxActive) {
+		// the display task is woken at the next tick at the latest, like the delayUS path
+		_displayTxStep(&xHigherPriorityTaskWoken);
+	} else
+#endif
+	{
+#if DISPLAY_DELAY_NOTIFY == 1
+		vTaskNotifyGiveFromISR(displayDelayTask, &xHigherPriorityTaskWoken);
+#else
+		xEventGroupSetBitsFromISR(egDisplayTiming, EG_DISPLAY_DELAY,&xHigherPriorityTaskWoken);
+#endif
+		TC0_ConfigClockSource(&TCF0, TC_CLKSEL_OFF_gc); //Disable Timer
+		TCF0.INTCTRLA = 0x00;
+	}
+	traceISR_EXIT(TRACE_ISR_DISPLAY_TIMER);
 }
 
  void delayUS(uint32_t us) {
+	TickType_t startTick = xTaskGetTickCount();
+	uint16_t startCnt = TCC0.CNT;
+	uint32_t lateUS;
+
 	if(us < 2) {
 		us = 2;
 	}	
-	TCF0.INTCTRLA = 0x01;
 	TCF0.CNT = 0;
 	TC0_ConfigWGM(&TCF0, TC_WGMODE_NORMAL_gc);
-	if(us < 0xFFFF*2) {
-		TC_SetPeriod(&TCF0, us/2);
-		TC0_ConfigClockSource(&TCF0, TC_CLKSEL_DIV64_gc); //Enable Timer with Prescaler 65 = 2us
+#if DISPLAY_DELAY_NOTIFY == 1
+	if(us < DISPLAY_DELAY_SPIN_US) {
+		// Shorter than a trip through the scheduler, poll the overflow flag instead
+		TCF0.INTCTRLA = 0x00;
+		TCF0.INTFLAGS = TC0_OVFIF_bm;
+		TC_SetPeriod(&TCF0, ulClockUSToCounts(us, 64));
+		TC0_ConfigClockSource(&TCF0, TC_CLKSEL_DIV64_gc);
+		while(!(TCF0.INTFLAGS & TC0_OVFIF_bm)) {
+			nop();
+		}
+		TC0_ConfigClockSource(&TCF0, TC_CLKSEL_OFF_gc);
+		TCF0.INTFLAGS = TC0_OVFIF_bm;
+		taskENTER_CRITICAL();
+		displayStats.delaySpins++;
+		taskEXIT_CRITICAL();
+		return;
+	}
+	ulTaskNotifyTake(pdTRUE, 0);	// drop the notification of an earlier delay that timed out
+	displayDelayTask = xTaskGetCurrentTaskHandle();
+#endif
+	TCF0.INTCTRLA = 0x01;
+	if(ulClockUSToCounts(us, 64) < 0xFFFF) {
+		TC_SetPeriod(&TCF0, ulClockUSToCounts(us, 64));
+		TC0_ConfigClockSource(&TCF0, TC_CLKSEL_DIV64_gc); //Enable Timer with Prescaler 64 = 2us at 32MHz
 	} else if((us/1000) < 1000) {
-		TC_SetPeriod(&TCF0, (us/32));
-		TC0_ConfigClockSource(&TCF0, TC_CLKSEL_DIV1024_gc); //Enable Timer with Prescaler 1024 = 32us
+		TC_SetPeriod(&TCF0, ulClockUSToCounts(us, 1024));
+		TC0_ConfigClockSource(&TCF0, TC_CLKSEL_DIV1024_gc); //Enable Timer with Prescaler 1024 = 32us at 32MHz
 	}
+#if DISPLAY_DELAY_NOTIFY == 1
+	ulTaskNotifyTake(pdTRUE, 500 / portTICK_RATE_MS); //Wait 500ms at a maximum
+#else
 	xEventGroupWaitBits(egDisplayTiming, EG_DISPLAY_DELAY, pdTRUE, pdFALSE, 500 / portTICK_RATE_MS ); //Wait 500ms at a maximum
+#endif
+	lateUS = _displayElapsedUS(startTick, startCnt);
+	lateUS = lateUS > us ? lateUS - us : 0;
+
+	taskENTER_CRITICAL();
+	displayStats.delaySleeps++;
+	displayStats.delayLateUSTotal += lateUS;
+	displayStats.lastDelayLateUS = lateUS;
+	if(lateUS > displayStats.maxDelayLateUS) {
+		displayStats.maxDelayLateUS = lateUS;
+	}
+	taskEXIT_CRITICAL();
  }
  void setPort(uint8_t data) {
-	data &= 0x0F;
-	data <<= 4;
-	PORTA.OUT &= (data | 0x0F);
-	PORTA.OUT |= data;
+	halDisplayPort(data);
  }
  void setRS(char value) {
-	if(value > 0) {
-		PORTD.OUTSET = PIN0_bm;
-	} else {
-		PORTD.OUTCLR = PIN0_bm;
-	}
+	halDisplayRS(value);
  }
  void setRW(char value) {
-	if(value > 0) {
-		PORTD.OUTSET = PIN1_bm;
-		} else {
-		PORTD.OUTCLR = PIN1_bm;
-	}
+	halDisplayRW(value);
  }
  void setE(char value) {
-	if(value > 0) {
-		PORTD.OUTSET = PIN2_bm;
-		} else {
-		PORTD.OUTCLR = PIN2_bm;
-	}
+	halDisplayE(value);
  }
  void Nybble() {
 	setE(1);	
-	delayUS(1);	
+	if(displayBusyFlagReady) {
+		delay_us(1); // E pulse width is 450ns, no need to go through TCF0
+	} else {
+		delayUS(1);
+	}
 	setE(0);
  }
+
+#if DISPLAY_USE_BUSY_FLAG == 1
+ // Reads the busy flag (DB7) over the 4-bit bus. PORTA upper nibble is an
+ // input only while E is pulsed. Needs the RW line wired to PD1.
+ static uint8_t _displayReadBusy(void) {
+	uint8_t status;
+	PORTA.DIRCLR = PIN4_bm | PIN5_bm | PIN6_bm | PIN7_bm;
+	setRS(0);
+	setRW(1);
+	setE(1);
+	delay_us(1);
+	status = PORTA.IN & PIN7_bm;	// high nibble: BF and AC6..4
+	setE(0);
+	delay_us(1);
+	setE(1);						// low nibble: AC3..0, ignored
+	delay_us(1);
+	setE(0);
+	setRW(0);
+	PORTA.DIRSET = PIN4_bm | PIN5_bm | PIN6_bm | PIN7_bm;
+	return status;
+ }
+#endif
+
+ // Waits until the controller is ready for the next command. With the busy flag
+ // this returns as soon as the controller is done, otherwise (or if the flag does
+ // not clear within DISPLAY_BUSY_TIMEOUT_US) the worst case time is waited.
+ static void _displayWaitReady(uint16_t worstCaseUS) {
+#if DISPLAY_USE_BUSY_FLAG == 1
+	if(displayBusyFlagReady) {
+		uint8_t busy;
+		// TCF0 times the timeout like the spin path of delayUS, a read takes a few us
+		TCF0.INTCTRLA = 0x00;
+		TCF0.CNT = 0;
+		TC0_ConfigWGM(&TCF0, TC_WGMODE_NORMAL_gc);
+		TCF0.INTFLAGS = TC0_OVFIF_bm;
+		TC_SetPeriod(&TCF0, ulClockUSToCounts(DISPLAY_BUSY_TIMEOUT_US, 64));
+		TC0_ConfigClockSource(&TCF0, TC_CLKSEL_DIV64_gc);
+		do {
+			busy = _displayReadBusy();
+		} while(busy && !(TCF0.INTFLAGS & TC0_OVFIF_bm));
+		TC0_ConfigClockSource(&TCF0, TC_CLKSEL_OFF_gc);
+		TCF0.INTFLAGS = TC0_OVFIF_bm;
+		if(!busy) {
+			return;
+		}
+		displayBusyFlagReady = 0;
+	}
+#endif
+	delayUS(worstCaseUS);
+ }
  void command(char i) {
 	setPort((i>>4)&0x0F);
 	setRS(0);
@@ -108,57 +265,155 @@ ISR(TCF0_OVF_vect) {
 	setPort(i & 0x0F);
 	Nybble();
  }
+#if DISPLAY_USE_TX_ENGINE == 1
+ static void _displayTxStart(uint8_t wait, uint8_t flags) {
+	TCF0.CNT = 0;
+	TC_SetPeriod(&TCF0, wait > 0 ? wait : 1);
+	if(flags & TX_FLAG_LONG) {
+		TC0_ConfigClockSource(&TCF0, TC_CLKSEL_DIV1024_gc); //32us at 32MHz
+	} else {
+		TC0_ConfigClockSource(&TCF0, TC_CLKSEL_DIV64_gc); //2us at 32MHz
+	}
+ }
+
+ // Runs in the TCF0 overflow ISR. One nibble per call, the timer is then
+ // reprogrammed with the time the controller needs before the next nibble.
+ static void _displayTxStep(BaseType_t *pxHigherPriorityTaskWoken) {
+	displayTxOp_t *op = &displayTxRing[displayTxTail];
+	switch(displayTxState) {
+		case TX_STATE_HIGH:
+			if(displayTxTail == displayTxHead) {
+				// ring empty and the wait of the last entry elapsed
+				TC0_ConfigClockSource(&TCF0, TC_CLKSEL_OFF_gc);
+				TCF0.INTCTRLA = 0x00;
+				displayTxActive = 0;
+				vTaskNotifyGiveFromISR(displayTask, pxHigherPriorityTaskWoken);
+				break;
+			}
+			setRS(op->flags & TX_FLAG_RS);
+			setPort(op->value >> 4);
+			setE(1);
+			delay_us(1);
+			setE(0);
+			displayTxState = TX_STATE_LOW;
+			_displayTxStart(1, 0);
+			break;
+		case TX_STATE_LOW:
+			setPort(op->value & 0x0F);
+			setE(1);
+			delay_us(1);
+			setE(0);
+			displayTxTail = (displayTxTail + 1) % DISPLAY_TX_BUFFER_SIZE;
+			displayTxState = TX_STATE_HIGH;
+			_displayTxStart(op->wait, op->flags);
+			break;
+	}
+ }
+
+ // Sends everything in the ring and blocks until the ISR is done.
+ static void _displayTxFlush(void) {
+	if(displayTxHead == displayTxTail) {
+		return;
+	}
+	ulTaskNotifyTake(pdTRUE, 0);	// drop the notification of a delayUS that timed out
+	setRW(0);
+	displayTxState = TX_STATE_HIGH;
+	displayTxActive = 1;
+	TC0_ConfigWGM(&TCF0, TC_WGMODE_NORMAL_gc);
+	TCF0.INTCTRLA = 0x01;
+	_displayTxStart(1, 0);
+	if(ulTaskNotifyTake(pdTRUE, 100 / portTICK_RATE_MS) == 0) {
+		// ISR got lost, take the timer back
+		TC0_ConfigClockSource(&TCF0, TC_CLKSEL_OFF_gc);
+		TCF0.INTCTRLA = 0x00;
+		displayTxActive = 0;
+		displayTxTail = displayTxHead;
+	}
+ }
+
+ static void _displayTxPush(uint8_t value, uint8_t flags, uint16_t worstCaseUS) {
+	uint8_t next = (displayTxHead + 1) % DISPLAY_TX_BUFFER_SIZE;
+	if(next == displayTxTail) {
+		_displayTxFlush();
+	}
+	uint32_t wait = ulClockUSToCounts(worstCaseUS, 64);
+	if(wait > 255) {
+		flags |= TX_FLAG_LONG;
+		wait = ulClockUSToCounts(worstCaseUS, 1024);
+	}
+	displayTxRing[displayTxHead].wait = wait;
+	displayTxRing[displayTxHead].value = value;
+	displayTxRing[displayTxHead].flags = flags;
+	displayTxHead = next;
+ }
+#endif
+
+ // Sends a command (rs = 0) or a character (rs = 1) and makes sure the
+ // controller had worstCaseUS to process it before the next one is sent.
+ static void _displaySend(uint8_t value, uint8_t rs, uint16_t worstCaseUS) {
+#if DISPLAY_USE_TX_ENGINE == 1
+	if(displayTxReady) {
+		_displayTxPush(value, rs ? TX_FLAG_RS : 0, worstCaseUS);
+		return;
+	}
+#endif
+	if(rs) {
+		write(value);
+	} else {
+		command(value);
+	}
+	_displayWaitReady(worstCaseUS);
+ }
+
  void displayHome() {
 	 command(0x02);
  }
  void _displayClear() {
-	 command(0x01);
-	 delayUS(2000);
+	 _displaySend(0x01, 0, 2000);
+	 displayCursor = 0x00;
  }
  
  void vInitDisplay() {
-	PORTA.DIRSET = PIN4_bm;
-	PORTA.DIRSET = PIN5_bm;
-	PORTA.DIRSET = PIN6_bm;
-	PORTA.DIRSET = PIN7_bm;
-	PORTD.DIRSET = PIN0_bm;
-	PORTD.DIRSET = PIN1_bm;
-	PORTD.DIRSET = PIN2_bm;
+	PORTA.DIRSET = PIN4_bm | PIN5_bm | PIN6_bm | PIN7_bm;
+	PORTD.DIRSET = PIN0_bm | PIN1_bm | PIN2_bm;
 	PORTA.OUT &= 0x0F;
 	PORTD.OUT &= 0xF8;
 
-	if((displayLineQueue = xQueueCreate(DISPLAY_QUEUE_DEPTH, sizeof(displayLine_t))) == NULL)
+#if DISPLAY_USE_FRAMEBUFFER == 1
+	memset(displayFrame, 0x20, sizeof(displayFrame));
+#else
+	if((displayLineQueue = xQueueCreateStatic(DISPLAY_QUEUE_DEPTH, sizeof(displayLine_t), displayLineQueueStorage, &displayLineQueueBuffer)) == NULL)
 	{
 		//error(ERR_QUEUE_CREATE_HANDLE_NULL);
 	}
+	vQueueSetQueueNumber(displayLineQueue, TRACE_QUEUE_DISPLAY);
+#endif
 	
-	egDisplayTiming = xEventGroupCreate();
+	egDisplayTiming = xEventGroupCreateStatic(&egDisplayTimingBuffer);
+	vEventGroupSetNumber(egDisplayTiming, TRACE_EG_DISPLAY);
 	
 
-	xTaskCreate(vDisplayUpdateTask, (const char*) "dispUpdate", configMINIMAL_STACK_SIZE+150, NULL, 1, NULL);	
+	displayTask = xTaskCreateStatic(vDisplayUpdateTask, (const char*) "dispUpdate", STACK_SIZE_DISPLAY, NULL, 1, displayStack, &displayTcb);
+	vStackMonitorAdd(displayTask, STACK_SIZE_DISPLAY);
  }
  
  void _displaySetPos(int line, int pos) {
-	 switch(line) {
-		 case 0:
-		 command(0x80 + 0x00 + pos);
-		 break;
-		 case 1:
-		 command(0x80 + 0x40 + pos);
-		 break;
-		 case 2:
-		 command(0x80 + 0x14 + pos);
-		 break;
-		 case 3:
-		 command(0x80 + 0x54 + pos);
-		 break;
-	 }
-	 delayUS(39);
+	 _displaySend(0x80 + displayLineAddress[line] + pos, 0, 39);
+	 displayCursor = displayLineAddress[line] + pos;
+	 displayFrameBytes++;
  }
 
  void _displayWriteChar(char c) {
-	 write(c);
-	 delayUS(43);
+	 _displaySend(c, 1, 43);
+	 // the address counter increments after each write, 0x27 -> 0x40 and 0x67 -> 0x00 in 2-line mode
+	 if(displayCursor == 0x27) {
+		 displayCursor = 0x40;
+	 } else if(displayCursor == 0x67) {
+		 displayCursor = 0x00;
+	 } else if(displayCursor != 0xFF) {
+		 displayCursor++;
+	 }
+	 displayFrameBytes++;
  }
  
  void _displayWriteString(char* s) {
@@ -175,35 +430,111 @@ ISR(TCF0_OVF_vect) {
 	 _displayWriteString(s);
  }
 
+ // Sends only the cells that differ from what is already on the glass. The cursor
+ // is only moved if the next changed cell is not where the controller writes anyway.
+ // Unchanged cells between two changed ones are always jumped over: a set-position
+ // (39us) is cheaper than rewriting even a single cell (43us).
+ static void _displayWriteChanges(char lines[4][20], char glass[4][20]) {
+	 for(uint8_t line = 0; line < 4; line++) {
+		 for(uint8_t pos = 0; pos < 20; pos++) {
+			 if(lines[line][pos] == glass[line][pos]) {
+				 continue;
+			 }
+			 if(displayLineAddress[line] + pos != displayCursor) {
+				 _displaySetPos(line, pos);
+			 }
+			 _displayWriteChar(lines[line][pos]);
+			 glass[line][pos] = lines[line][pos];
+		 }
+	 }
+ }
+
+ // Time since (startTick, startCnt) in us, TCC0 is the tick timer (CPU clock / 64)
+ static uint32_t _displayElapsedUS(TickType_t startTick, uint16_t startCnt) {
+	 TickType_t tick = xTaskGetTickCount();
+	 uint16_t cnt = TCC0.CNT;
+	 return (uint32_t)(tick - startTick) * 1000UL * portTICK_PERIOD_MS
+		 + ulClockCountsToUS(cnt, CLOCK_TICK_PRESCALER) - ulClockCountsToUS(startCnt, CLOCK_TICK_PRESCALER);
+ }
+
+ void vDisplayGetStats(displayStats_t *stats) {
+	 taskENTER_CRITICAL();
+	 *stats = displayStats;
+	 taskEXIT_CRITICAL();
+	 stats->pathRAM = DISPLAY_PATH_RAM;
+ }
+
+#if DISPLAY_USE_FRAMEBUFFER == 0
+ // Copies a queued write into the lines of the next refresh
+ static void _displayApplyLine(char lines[4][20], displayLine_t *newLine) {
+	 for(uint8_t i = 0; (i + newLine->displayPos < 20) && (newLine->displayBuffer[i] != 0x00); i++) {
+		 lines[newLine->displayLine][i + newLine->displayPos] = newLine->displayBuffer[i];
+	 }
+ }
+#endif
+
  void vDisplayUpdateTask(void *pvParameters) {
 	 int i = 0;
-	 int j = 0;
 	 char displayLines[4][20];
+	 char glassLines[4][20];	// What is currently shown on the display
 	 for(int i = 0; i < 4;i++) {
 		for(int j = 0; j < 20; j ++) {
 			displayLines[i][j] = 0x20;
+			glassLines[i][j] = 0x20;
 		}
 	 }
+#if DISPLAY_USE_FRAMEBUFFER == 1
+	 uint8_t frameSeqSeen[4] = {0, 0, 0, 0};
+#else
+	 int j = 0;
 	 displayLine_t newLine;
+#endif
+	 TickType_t frameStartTick;
+	 uint16_t frameStartCnt;
+	 uint32_t frameUS;
 
 	 delayUS(40000);
 	 setPort(0x03);
 	 delayUS(5000);
 	 Nybble();
-	 delayUS(160);
+	 delayUS(4100); // the first 8 bit function set takes 4.1ms, the second 100us
 	 Nybble();
 	 delayUS(160);
 	 Nybble();
 	 delayUS(160);
 	 setPort(0x02);
 	 Nybble();
-	 command(0x28);
-	 command(0x10);
-	 command(0x0C); //Cursor and Blinking off
-	 command(0x06);
+	 delayUS(39);
+	 _displaySend(0x28, 0, 39);
+	 _displaySend(0x10, 0, 39);
+	 _displaySend(0x0C, 0, 39); //Cursor and Blinking off
+	 _displaySend(0x06, 0, 39);
+#if DISPLAY_USE_BUSY_FLAG == 1
+	 displayBusyFlagReady = 1; // BF is valid after the function set
+#endif
+	 _displayClear(); // the glass buffer starts with spaces
+#if DISPLAY_USE_TX_ENGINE == 1
+	 displayTxReady = 1;
+#endif
 	 
 	 for(;;) {		 
 		 vTaskDelay(DISPLAY_UPDATE_TIME_MS/portTICK_RATE_MS);
+#if DISPLAY_USE_FRAMEBUFFER == 1
+		 for(i = 0; i < 4; i++) {
+			 uint8_t seq;
+			 if(displayFrameSeq[i] == frameSeqSeen[i]) {
+				 continue;	// line not written since the last refresh
+			 }
+			 taskENTER_CRITICAL();
+			 displayLinePending &= ~(1 << i);
+			 taskEXIT_CRITICAL();
+			 do {
+				 seq = displayFrameSeq[i];
+				 memcpy(displayLines[i], displayFrame[i], 20);
+			 } while(seq != displayFrameSeq[i]);
+			 frameSeqSeen[i] = seq;
+		 }
+#else
 		 if(xEventGroupGetBits(egDisplayTiming) && EG_DISPLAY_CLEAR != 0x00) {
 			xEventGroupClearBits(egDisplayTiming, EG_DISPLAY_CLEAR);
 			for(i = 0; i < 4;i++) {
@@ -214,22 +545,68 @@ ISR(TCF0_OVF_vect) {
 		 }
 		 while(uxQueueMessagesWaiting(displayLineQueue) > 0) {
 			 if(xQueueReceive(displayLineQueue, &newLine, portMAX_DELAY)) {	
-				i=0;			
-				while((i+newLine.displayPos < 20) && (newLine.displayBuffer[i] != 0x00)) {				
-					displayLines[newLine.displayLine][i+newLine.displayPos] = newLine.displayBuffer[i];
-					i++;
-				}
+				_displayApplyLine(displayLines, &newLine);
 			 }
 		 }
-		 for(i = 0; i < 4; i++) {
-			 _displayWriteStringAtPos(i,0,&displayLines[i][0]);
+		 // The scheduler lock keeps the writers out while the queue is emptied and the
+		 // late writes are applied. Queue calls must not run in a critical section.
+		 vTaskSuspendAll();
+		 if(displayLateActive) {
+			 // writers stopped queueing when the queue ran full, take what they queued before
+			 while(xQueueReceive(displayLineQueue, &newLine, 0) == pdPASS) {
+				 _displayApplyLine(displayLines, &newLine);
+			 }
+			 for(i = 0; i < 4; i++) {
+				 for(j = 0; j < 20; j++) {
+					 if(displayLateMask[i] & (1UL << j)) {
+						 displayLines[i][j] = displayLate[i][j];
+					 }
+				 }
+				 displayLateMask[i] = 0;
+			 }
+			 displayLateActive = 0;
+		 }
+		 xTaskResumeAll();
+		 taskENTER_CRITICAL();
+		 displayLinePending = 0;
+		 taskEXIT_CRITICAL();
+#endif
+		 frameStartTick = xTaskGetTickCount();
+		 frameStartCnt = TCC0.CNT;
+		 displayFrameBytes = 0;
+		 vDisplayBusMark();
+		 _displayWriteChanges(displayLines, glassLines);
+#if DISPLAY_USE_TX_ENGINE == 1
+		 _displayTxFlush();
+#endif
+		 frameUS = _displayElapsedUS(frameStartTick, frameStartCnt);
+
+		 taskENTER_CRITICAL();
+		 displayStats.frames++;
+		 displayStats.bytesTotal += displayFrameBytes;
+		 displayStats.lastFrameBytes = displayFrameBytes;
+		 displayStats.lastFrameUS = frameUS;
+		 displayStats.busUSTotal += frameUS;
+		 displayStats.busyFlagActive = displayBusyFlagReady;
+		 if(frameUS > displayStats.maxFrameUS) {
+			 displayStats.maxFrameUS = frameUS;
 		 }
+		 taskEXIT_CRITICAL();
 	 }
  }
  
 
 void vDisplayClear() {
+#if DISPLAY_USE_FRAMEBUFFER == 1
+	for(uint8_t line = 0; line < 4; line++) {
+		taskENTER_CRITICAL();
+		memset(displayFrame[line], 0x20, 20);
+		displayFrameSeq[line]++;
+		taskEXIT_CRITICAL();
+	}
+#else
 	xEventGroupSetBits(egDisplayTiming, EG_DISPLAY_CLEAR);
+#endif
 }
 
 void vDisplayWriteStringAtPos(int line, int pos, char const *fmt, ...) {
@@ -239,112 +616,313 @@ void vDisplayWriteStringAtPos(int line, int pos, char const *fmt, ...) {
 	va_end(arg);	
 }
  
-static int display_vprintf(int line, int pos, char const *fmt, va_list arg) {
-	int int_temp;
-	char char_temp;
-	char *string_temp;
-	double double_temp;
-	char ch;
-	int length = 0;
+// Appends c if there is room, returns the new length
+static uint8_t display_put(char *out, uint8_t length, uint8_t size, char c) {
+	if(length < size) {
+		out[length] = c;
+		length++;
+	}
+	return length;
+}
 
-	static char buffer[20];
-	static char str[20];
-	for(int i = 0; i < 20; i++) {
-		buffer[i] = 0x00;
+static uint8_t display_puts(char *out, uint8_t length, uint8_t size, const char *s) {
+	while(*s != '\0') {
+		length = display_put(out, length, size, *s++);
 	}
-	for(int i = 0; i < 20; i++) {
-		str[i] = 0x00;
-	}
-	while ((ch = *fmt++)!=false) {
-		if ( '%' == ch ) {
-			switch (ch = *fmt++) {
-				/* %% - print out a single %    */
-				case '%':
-				str[length] = '%';
-				length++;
-				break;
+	return length;
+}
 
-				/* %c: print out a character    */
-				case 'c':
-				char_temp = va_arg(arg, int);
-				str[length] = char_temp;
-				length++;
-				break;
+/* Fixed-point conversion of a float with the given number of decimals using only
+ * integer operations: the IEEE 754 bits are split into an integer part and a
+ * 32 bit binary fraction, the decimals are then taken from the fraction by
+ * multiplying with 10. Returns the number of characters (buffer >= 22 bytes).
+ */
+static uint8_t display_ftoa(char *buffer, float value, uint8_t decimals) {
+	union {
+		float f;
+		uint32_t u;
+	} bits;
+	uint8_t length = 0;
+	int16_t exponent;
+	uint32_t mantissa;
+	uint32_t intPart;
+	uint32_t fracPart;
+	uint32_t pow10 = 1;
+	uint32_t before;
+
+	bits.f = value;
+	exponent = (int16_t)((bits.u >> 23) & 0xFF) - 127;
+	mantissa = bits.u & 0x007FFFFFUL;
+	if(decimals > 9) {
+		decimals = 9;
+	}
+	if(bits.u & 0x80000000UL) {
+		buffer[length++] = '-';
+	}
+	if(exponent == 128) {
+		strcpy(&buffer[length], mantissa ? "nan" : "inf");
+		return length + 3;
+	}
+	if(exponent > 31) {
+		strcpy(&buffer[length], "ovf");
+		return length + 3;
+	}
+	if(exponent == -127) {
+		exponent = -126;	// denormal, no implicit leading 1
+	} else {
+		mantissa |= 0x00800000UL;
+	}
 
-				/* %s: print out a string       */
-				case 's':
-				string_temp = va_arg(arg, char *);
-				for(int i = 0; i < strlen(string_temp);i++) {
-					str[length+i] = string_temp[i];
-				}
-				length += strlen(string_temp);
-				break;
+	if(exponent >= 23) {
+		intPart = mantissa << (exponent - 23);
+		fracPart = 0;
+	} else if(exponent >= 0) {
+		intPart = mantissa >> (23 - exponent);
+		fracPart = mantissa << (9 + exponent);	// the integer bits are shifted out
+	} else {
+		intPart = 0;
+		if(9 + exponent >= 0) {
+			fracPart = mantissa << (9 + exponent);
+		} else if(9 + exponent > -32) {
+			fracPart = mantissa >> -(9 + exponent);
+		} else {
+			fracPart = 0;
+		}
+	}
 
-				/* %d: print out an int         */
-				case 'd':
-				int_temp = va_arg(arg, int);
-				itoa(int_temp, buffer, 10);
-				for(int i = 0; i < strlen(buffer);i++) {
-					str[length+i] = buffer[i];
-				}
-				length += strlen(buffer);
-				break;
+	// round to the last printed decimal
+	for(uint8_t i = 0; i < decimals; i++) {
+		pow10 *= 10;
+	}
+	before = fracPart;
+	fracPart += 0x80000000UL / pow10;
+	if(fracPart < before) {
+		intPart++;
+	}
 
-				/* %x: print out an int in hex  */
-				case 'x':
-				int_temp = va_arg(arg, int);
-				itoa(int_temp, buffer, 16);
-				for(int i = 0; i < strlen(buffer);i++) {
-					str[length+i] = buffer[i];
-				}
-				length += strlen(buffer);
-				break;
+	ultoa(intPart, &buffer[length], 10);
+	length += strlen(&buffer[length]);
+	if(decimals > 0) {
+		buffer[length++] = '.';
+		for(uint8_t i = 0; i < decimals; i++) {
+			uint64_t x = (uint64_t) fracPart * 10;
+			buffer[length++] = '0' + (uint8_t)(x >> 32);
+			fracPart = (uint32_t) x;
+		}
+	}
+	buffer[length] = '\0';
+	return length;
+}
 
-				case 'f':
-				double_temp = va_arg(arg, double);
-				ftoa_fixed(buffer, double_temp);
-				for(int i = 0; i < strlen(buffer);i++) {
-					str[length+i] = buffer[i];
-				}
-				length += strlen(buffer);
-				break;
+/* Reentrant printf subset that writes at most size characters to out (not
+ * terminated). Supports %%, %c, %s, %d, %u, %x (with l and .N = minimum digits),
+ * %f (.N = decimals, default 4) and %e. A '\n' ends the string.
+ * Returns the number of characters written.
+ */
+static uint8_t display_format(char *out, uint8_t size, char const *fmt, va_list arg) {
+	char buffer[24];
+	uint8_t length = 0;
+	char ch;
 
-				case 'e':
-				double_temp = va_arg(arg, double);
-				ftoa_sci(buffer, double_temp);
-				for(int i = 0; i < strlen(buffer);i++) {
-					str[length+i] = buffer[i];
-				}
-				length += strlen(buffer);
-				break;
+	while ((ch = *fmt++) != '\0') {
+		if(ch == '\n') {
+			break;
+		}
+		if(ch != '%') {
+			length = display_put(out, length, size, ch);
+			continue;
+		}
+		int8_t precision = -1;
+		uint8_t isLong = 0;
+		if(*fmt == '.') {
+			fmt++;
+			precision = 0;
+			while(*fmt >= '0' && *fmt <= '9') {
+				precision = precision * 10 + (*fmt++ - '0');
 			}
 		}
-		else {
-			str[length] = ch;
-			if(str[length] == '\n') {
-				str[length] = '\0';				
+		if(*fmt == 'l') {
+			fmt++;
+			isLong = 1;
+		}
+		switch (ch = *fmt++) {
+			/* %% - print out a single %    */
+			case '%':
+			length = display_put(out, length, size, '%');
+			break;
+
+			/* %c: print out a character    */
+			case 'c':
+			length = display_put(out, length, size, (char) va_arg(arg, int));
+			break;
+
+			/* %s: print out a string       */
+			case 's':
+			length = display_puts(out, length, size, va_arg(arg, char *));
+			break;
+
+			/* %d, %u, %x: print out an int */
+			case 'd':
+			case 'u':
+			case 'x':
+			if(ch == 'd') {
+				long value = isLong ? va_arg(arg, long) : va_arg(arg, int);
+				if(value < 0) {
+					length = display_put(out, length, size, '-');
+					value = -value;
+				}
+				ultoa((unsigned long) value, buffer, 10);
+			} else {
+				unsigned long value = isLong ? va_arg(arg, unsigned long) : va_arg(arg, unsigned int);
+				ultoa(value, buffer, ch == 'x' ? 16 : 10);
 			}
-			length++;
+			for(int8_t i = strlen(buffer); i < precision; i++) {
+				length = display_put(out, length, size, '0');
+			}
+			length = display_puts(out, length, size, buffer);
+			break;
+
+			/* %f: fixed point, integer arithmetic only */
+			case 'f':
+			display_ftoa(buffer, (float) va_arg(arg, double), precision < 0 ? 4 : precision);
+			length = display_puts(out, length, size, buffer);
+			break;
+
+			case 'e':
+			ftoa_sci(buffer, va_arg(arg, double));
+			length = display_puts(out, length, size, buffer);
+			break;
+
+			case '\0':
+			return length;
 		}
 	}
-	if(length + pos >= 20) {
-		length = 20-pos;
+	return length;
+}
+
+static int display_vprintf(int line, int pos, char const *fmt, va_list arg) {
+	uint8_t length = 0;
+	TickType_t startTick = xTaskGetTickCount();
+	uint16_t startCnt = TCC0.CNT;
+	uint32_t writeUS;
+#if DISPLAY_USE_FRAMEBUFFER == 1
+	char text[20];
+
+	if(line < 0 || line > 3 || pos < 0 || pos >= 20) {
+		return 0;
+	}
+	length = display_format(text, 20 - pos, fmt, arg);
+	taskENTER_CRITICAL();
+	memcpy(&displayFrame[line][pos], text, length);
+	displayFrameSeq[line]++;
+	if(displayLinePending & (1 << line)) {
+		displayStats.coalesced++;
 	}
+	displayLinePending |= 1 << line;
+	taskEXIT_CRITICAL();
+#else
 	displayLine_t newLine;
+
 	for(int i = 0; i < 20; i++) {
 		newLine.displayBuffer[i] = 0x00;
 	}
+	if(pos < 20) {
+		length = display_format((char *) newLine.displayBuffer, 20 - pos, fmt, arg);
+	}
 	newLine.displayLine = line;
 	newLine.displayPos = pos;
-	for(int i = 0; i < length;i++) {
-		newLine.displayBuffer[i] = str[i];
-	}	
-	xQueueSend(displayLineQueue, (void *) &newLine, portMAX_DELAY);
-	
-	
+	// Queue or late buffer is decided with the scheduler locked, so no other writer
+	// and not the display task gets in between. Only the counters need a critical
+	// section, queue calls must not run in one.
+	UBaseType_t waiting = 0;
+	uint8_t late;
+	vTaskSuspendAll();
+	if(!displayLateActive) {
+		if(xQueueSend(displayLineQueue, (void *) &newLine, 0) == pdPASS) {
+			waiting = uxQueueMessagesWaiting(displayLineQueue);
+		} else {
+			displayLateActive = 1;
+		}
+	}
+	late = displayLateActive;
+	if(late) {
+		for(uint8_t i = 0; (i + pos < 20) && (newLine.displayBuffer[i] != 0x00); i++) {
+			displayLate[line][i + pos] = newLine.displayBuffer[i];
+			displayLateMask[line] |= 1UL << (i + pos);
+		}
+	}
+	xTaskResumeAll();
+
+	taskENTER_CRITICAL();
+	if(waiting > displayStats.queuePeak) {
+		displayStats.queuePeak = waiting;
+	}
+	if(late) {
+		displayStats.overflows++;
+	}
+	if(displayLinePending & (1 << line)) {
+		displayStats.coalesced++;
+	}
+	displayLinePending |= 1 << line;
+	taskEXIT_CRITICAL();
+#endif
+	writeUS = _displayElapsedUS(startTick, startCnt);
+
+	taskENTER_CRITICAL();
+	displayStats.writes++;
+	displayStats.lastWriteUS = writeUS;
+	if(writeUS > displayStats.maxWriteUS) {
+		displayStats.maxWriteUS = writeUS;
+	}
+	taskEXIT_CRITICAL();
+
+	return length;
+}
+
+uint8_t uxDisplayFormat(char *out, uint8_t size, char const *fmt, va_list arg) {
+	return display_format(out, size, fmt, arg);
+}
+
+uint32_t ulDisplayElapsedUS(TickType_t startTick, uint16_t startCnt) {
+	return _displayElapsedUS(startTick, startCnt);
+}
+
+#if DISPLAY_FORMAT_BENCHMARK == 1
+#include <stdio.h>
+
+static uint8_t display_snprintf(char *out, uint8_t size, char const *fmt, ...) {
+	va_list arg;
+	uint8_t length;
+	va_start(arg, fmt);
+	length = display_format(out, size, fmt, arg);
+	va_end(arg);
 	return length;
 }
 
+void vDisplayFormatBenchmark(uint16_t runs, uint32_t *formatUS, uint32_t *sprintfUS) {
+	char out[24];
+	float value = 3.14159265;
+	TickType_t startTick;
+	uint16_t startCnt;
+
+	startTick = xTaskGetTickCount();
+	startCnt = TCC0.CNT;
+	for(uint16_t i = 0; i < runs; i++) {
+		display_snprintf(out, 20, "PI: %.8f", value);
+		display_snprintf(out, 20, "Time: %.6d ms", (int) i);
+	}
+	*formatUS = _displayElapsedUS(startTick, startCnt);
+
+	startTick = xTaskGetTickCount();
+	startCnt = TCC0.CNT;
+	for(uint16_t i = 0; i < runs; i++) {
+		sprintf(out, "PI: %.8f", value);
+		sprintf(out, "Time: %.6d ms", (int) i);
+	}
+	*sprintfUS = _displayElapsedUS(startTick, startCnt);
+}
+#endif
+
 static int normalize(double *val) {
     int exponent = 0;
     double value = *val;
@@ -362,60 +940,6 @@ static int normalize(double *val) {
     return exponent;
 }
 
-static void ftoa_fixed(char *buffer, double value) {  
-    /* carry out a fixed conversion of a double value to a string, with a precision of 5 decimal digits. 
-     * Values with absolute values less than 0.000001 are rounded to 0.0
-     * Note: this blindly assumes that the buffer will be large enough to hold the largest possible result.
-     * The largest value we expect is an IEEE 754 double precision real, with maximum magnitude of approximately
-     * e+308. The C standard requires an implementation to allow a single conversion to produce up to 512 
-     * characters, so that's what we really expect as the buffer size.     
-     */
-
-    int exponent = 0;
-    int places = 0;
-    static const int width = 4;
-
-    if (value == 0.0) {
-        buffer[0] = '0';
-        buffer[1] = '\0';
-        return;
-    }         
-
-    if (value < 0.0) {
-        *buffer++ = '-';
-        value = -value;
-    }
-
-    exponent = normalize(&value);
-
-    while (exponent > 0) {
-        int digit = value * 10;
-        *buffer++ = digit + '0';
-        value = value * 10 - digit;
-        ++places;
-        --exponent;
-    }
-
-    if (places == 0)
-        *buffer++ = '0';
-
-    *buffer++ = '.';
-
-    while (exponent < 0 && places < width) {
-        *buffer++ = '0';
-        --exponent;
-        ++places;
-    }
-
-    while (places < width) {
-        int digit = value * 10.0;
-        *buffer++ = digit + '0';
-        value = value * 10.0 - digit;
-        ++places;
-    }
-    *buffer = '\0';
-}
-
 void ftoa_sci(char *buffer, double value) {
     int exponent = 0;    
     static const int width = 4;
@@ -0,0 +1,78 @@
+/*
+ * NHD0420Hal.c
+ *
+ * Created: 19.10.2026 03:17:35
+ *  Author: agent
+ */ 
+#include "avr_compiler.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "NHD0420Hal.h"
+#include "uartDriver.h"
+#include "init.h"
+
+#if DISPLAY_BUS_CAPTURE == 1
+
+typedef struct {
+	uint8_t bus;		//DB7..4 in bits 3..0, DISPLAY_BUS_xxx flags
+	uint16_t deltaUS;	//Time since the previous entry, saturated at 0xFFFF
+} displayBusEntry_t;
+
+static displayBusEntry_t busCapture[DISPLAY_BUS_CAPTURE_SIZE];
+static uint16_t busCaptureCount = 0;
+static uint32_t busLastUS = 0;
+
+// us since start, TCC0 is the tick timer (CPU clock / 64). Callable from tasks and ISRs.
+static uint32_t _busNowUS(void) {
+	UBaseType_t mask = portSET_INTERRUPT_MASK_FROM_ISR();
+	TickType_t tick = xTaskGetTickCountFromISR();
+	uint16_t cnt = TCC0.CNT;
+	if((TCC0.INTFLAGS & TC0_OVFIF_bm) && cnt < TCC0.PER / 2) {
+		tick++;	// overflow happened, tick interrupt still pending
+	}
+	portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+	return (uint32_t) tick * 1000UL * portTICK_PERIOD_MS + ulClockCountsToUS(cnt, CLOCK_TICK_PRESCALER);
+}
+
+static void _busRecord(uint8_t bus) {
+	uint32_t now = _busNowUS();
+	uint32_t delta = now - busLastUS;
+	UBaseType_t mask;
+
+	mask = portSET_INTERRUPT_MASK_FROM_ISR();
+	if(busCaptureCount < DISPLAY_BUS_CAPTURE_SIZE) {	// stops when full, the start of the trace is the interesting part
+		busCapture[busCaptureCount].bus = bus;
+		busCapture[busCaptureCount].deltaUS = delta > 0xFFFF ? 0xFFFF : (uint16_t) delta;
+		busCaptureCount++;
+		busLastUS = now;
+	}
+	portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+}
+
+void vDisplayBusLatch(uint8_t bus) {
+	_busRecord(bus);
+}
+
+void vDisplayBusMark(void) {
+	_busRecord(DISPLAY_BUS_MARK);
+}
+
+// "BUS1" <u16 count> then count x (u8 bus, u16 deltaUS), little endian.
+// The capture is restarted afterwards.
+void vDisplayBusDump(void) {
+	uint16_t count = busCaptureCount;
+
+	vInitUart();
+	vUartLock();
+	vUartPrint("BUS1");
+	vUartWrite(&count, sizeof(count));
+	for(uint16_t i = 0; i < count; i++) {
+		vUartWrite(&busCapture[i].bus, 1);
+		vUartWrite(&busCapture[i].deltaUS, 2);
+	}
+	vUartUnlock();
+	busLastUS = _busNowUS();
+	busCaptureCount = 0;
+}
+
+#endif
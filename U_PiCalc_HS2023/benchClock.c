@@ -0,0 +1,78 @@
+/*
+ * benchClock.c
+ *
+ * Created: 19.10.2026 03:25:37
+ *  Author: agent
+ */ 
+#include "benchClock.h"
+
+#if defined(__AVR__) || HOSTSIM == 1
+#include "avr_compiler.h"
+#include "FreeRTOS.h"
+#include "TC_driver.h"
+
+static volatile uint32_t benchClockHigh = 0;	// TCD1 overflows, bits 32..63
+
+void vBenchClockInit(void) {
+	TC0_ConfigClockSource(&TCD0, TC_CLKSEL_OFF_gc);
+	TC1_ConfigClockSource(&TCD1, TC_CLKSEL_OFF_gc);
+	TCD0.CNT = 0;
+	TCD1.CNT = 0;
+	TCD0.PER = 0xFFFF;
+	TCD1.PER = 0xFFFF;
+	EVSYS.CH0MUX = EVSYS_CHMUX_TCD0_OVF_gc;
+	TC1_ConfigClockSource(&TCD1, TC_CLKSEL_EVCH0_gc);
+	TC1_SetOverflowIntLevel(&TCD1, TC_OVFINTLVL_LO_gc);
+	TC0_ConfigClockSource(&TCD0, TC_CLKSEL_DIV1_gc);
+}
+
+ISR(TCD1_OVF_vect) {
+	benchClockHigh++;
+}
+
+uint64_t ullBenchClockCycles(void) {
+	UBaseType_t mask = portSET_INTERRUPT_MASK_FROM_ISR();
+	uint32_t high = benchClockHigh;
+	uint16_t mid = TCD1.CNT;
+	uint16_t low = TCD0.CNT;
+	uint16_t midAgain = TCD1.CNT;
+	if(midAgain != mid) {
+		// TCD0 wrapped between the reads, the low word belongs to the new value
+		mid = midAgain;
+		low = TCD0.CNT;
+	}
+	if((TCD1.INTFLAGS & TC1_OVFIF_bm) && mid < 0x8000) {
+		high++;	// TCD1 wrapped, its interrupt is still pending
+	}
+	portCLEAR_INTERRUPT_MASK_FROM_ISR(mask);
+	return ((uint64_t) high << 32) | ((uint32_t) mid << 16) | low;
+}
+
+uint64_t ullBenchClockUS(void) {
+	return ullBenchClockCycles() / (BENCH_CLOCK_HZ / 1000000UL);
+}
+
+#else
+#include <time.h>
+
+static uint64_t benchClockStart = 0;
+
+static uint64_t _benchClockNowNS(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t) now.tv_sec * 1000000000ULL + (uint64_t) now.tv_nsec;
+}
+
+void vBenchClockInit(void) {
+	benchClockStart = _benchClockNowNS();
+}
+
+uint64_t ullBenchClockCycles(void) {
+	return _benchClockNowNS() - benchClockStart;
+}
+
+uint64_t ullBenchClockUS(void) {
+	return ullBenchClockCycles() / (BENCH_CLOCK_HZ / 1000000UL);
+}
+
+#endif
@@ -0,0 +1,124 @@
+/*
+ * buttonEngine.c
+ *
+ * Created: 19.10.2026 03:23:47
+ *  Author: agent
+ */ 
+#include "buttonEngine.h"
+
+void buttonEngineInit(buttonEngine_t *engine, uint8_t count, uint16_t longSamples, uint16_t repeatSamples, uint16_t chordSamples) {
+	if(count > BUTTON_ENGINE_MAX) {
+		count = BUTTON_ENGINE_MAX;
+	}
+	engine->count = count;
+	engine->state = 0;
+	engine->cnt0 = 0;
+	engine->cnt1 = 0;
+	engine->longSent = 0;
+	engine->chorded = 0;
+	engine->edgeLatched = 0;
+	engine->longSamples = longSamples;
+	engine->repeatSamples = repeatSamples > 0 ? repeatSamples : 1;
+	engine->chordSamples = chordSamples;
+	for(uint8_t b = 0; b < BUTTON_ENGINE_MAX; b++) {
+		engine->held[b] = 0;
+		engine->quiet[b] = 0;
+		engine->edge[b] = 0;
+	}
+}
+
+static uint8_t buttonEngineAdd(buttonEvent_t *events, uint8_t n, uint8_t maxEvents, uint8_t button, uint8_t type, uint32_t timestamp) {
+	if(n < maxEvents) {
+		events[n].button = button;
+		events[n].type = type;
+		events[n].timestamp = timestamp;
+		n++;
+	}
+	return n;
+}
+
+uint8_t buttonEngineSample(buttonEngine_t *engine, uint8_t sample, uint32_t now, uint32_t edge, buttonEvent_t *events, uint8_t maxEvents) {
+	uint8_t mask = (uint8_t)((1U << engine->count) - 1);
+	uint8_t delta;
+	uint8_t toggle;
+	uint8_t pressed;
+	uint8_t n = 0;
+
+	// Vertical counter: a bit of delta that stays set for 4 samples toggles the state,
+	// any sample that agrees with the state resets that input's counter.
+	delta = (sample & mask) ^ engine->state;
+	engine->cnt1 = (engine->cnt1 ^ engine->cnt0) & delta;
+	engine->cnt0 = ~engine->cnt0 & delta;
+	toggle = delta & ~(engine->cnt0 | engine->cnt1);
+	engine->state ^= toggle;
+
+	// The first disagreeing sample latches the edge, bounces keep it. 4 agreeing
+	// samples in a row were a glitch, the next change latches again.
+	for(uint8_t b = 0; b < engine->count; b++) {
+		uint8_t bit = 1 << b;
+		if(delta & bit) {
+			if(!(engine->edgeLatched & bit)) {
+				engine->edgeLatched |= bit;
+				engine->edge[b] = edge;
+			}
+			engine->quiet[b] = 0;
+		} else if((engine->edgeLatched & bit) && ++engine->quiet[b] >= 4) {
+			engine->edgeLatched &= ~bit;
+		}
+	}
+	engine->edgeLatched &= ~toggle;
+
+	// Per-press state and hold times are brought up to this sample before any chord
+	// scan reads them, inputs that go down together must not see each other's old press.
+	pressed = toggle & engine->state;
+	engine->longSent &= ~pressed;
+	engine->chorded &= ~pressed;
+	for(uint8_t b = 0; b < engine->count; b++) {
+		uint8_t bit = 1 << b;
+		if(pressed & bit) {
+			engine->held[b] = 0;
+		} else if((engine->state & bit) && engine->held[b] < 0xFFFF) {
+			engine->held[b]++;
+		}
+	}
+
+	for(uint8_t b = 0; b < engine->count; b++) {
+		uint8_t bit = 1 << b;
+		if(toggle & bit) {
+			if(engine->state & bit) {
+				n = buttonEngineAdd(events, n, maxEvents, b, BUTTON_EVENT_PRESS, engine->edge[b]);
+				// chord: another input went down shortly before and is not in a chord yet
+				for(uint8_t o = 0; o < engine->count; o++) {
+					uint8_t other = 1 << o;
+					if(o != b && (engine->state & other) && !(engine->chorded & other) && !(engine->longSent & other)
+						&& engine->held[o] <= engine->chordSamples) {
+						engine->chorded |= bit | other;
+						n = buttonEngineAdd(events, n, maxEvents, bit | other, BUTTON_EVENT_CHORD, engine->edge[b]);
+						break;
+					}
+				}
+			} else {
+				n = buttonEngineAdd(events, n, maxEvents, b, BUTTON_EVENT_RELEASE, engine->edge[b]);
+				if(!(engine->longSent & bit) && !(engine->chorded & bit)) {
+					n = buttonEngineAdd(events, n, maxEvents, b, BUTTON_EVENT_SHORT, engine->edge[b]);
+				}
+			}
+		} else if(engine->state & bit) {
+			if(engine->chorded & bit) {
+				continue;
+			}
+			if(engine->held[b] == engine->longSamples) {
+				engine->longSent |= bit;
+				n = buttonEngineAdd(events, n, maxEvents, b, BUTTON_EVENT_LONG, now);
+			} else if(engine->held[b] > engine->longSamples && engine->held[b] < 0xFFFF
+				&& (engine->held[b] - engine->longSamples) % engine->repeatSamples == 0) {
+				n = buttonEngineAdd(events, n, maxEvents, b, BUTTON_EVENT_REPEAT, now);
+			}
+		}
+	}
+	return n;
+}
+
+uint8_t buttonEngineIdle(const buttonEngine_t *engine) {
+	return engine->state == 0 && engine->cnt0 == 0 && engine->cnt1 == 0;
+}
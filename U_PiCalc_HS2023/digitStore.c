@@ -0,0 +1,106 @@
+/*
+ * digitStore.c
+ *
+ * Created: 19.10.2026 03:19:59
+ *  Author: agent
+ */ 
+#include "avr_compiler.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "NHD0420Driver.h"
+#include "digitStore.h"
+
+#if DIGIT_STORE_HEX == 1
+#define DIGIT_MAX	15
+#else
+#define DIGIT_MAX	9
+#endif
+
+// Digit 2n in the high nibble of byte n, digit 2n+1 in the low nibble
+static uint8_t digitStore[(DIGIT_STORE_CAPACITY + 1) / 2];
+static volatile uint16_t digitCount = 0;	// written last, readers only look below it
+static digitStoreStats_t digitStats;
+
+void vDigitStoreReset(void) {
+	taskENTER_CRITICAL();
+	digitCount = 0;
+	digitStats.appends = 0;
+	digitStats.appendUSTotal = 0;
+	digitStats.rejected = 0;
+	taskEXIT_CRITICAL();
+}
+
+uint8_t xDigitStoreAppend(uint8_t digit) {
+	uint16_t index = digitCount;
+	if(digit > DIGIT_MAX || index >= DIGIT_STORE_CAPACITY) {
+		digitStats.rejected++;
+		return pdFALSE;
+	}
+	if(index & 0x01) {
+		digitStore[index >> 1] |= digit;
+	} else {
+		digitStore[index >> 1] = digit << 4;
+	}
+	taskENTER_CRITICAL();
+	digitCount = index + 1;
+	taskEXIT_CRITICAL();
+	return pdTRUE;
+}
+
+uint16_t uxDigitStoreAppendString(const char *digits, uint16_t length) {
+	TickType_t startTick = xTaskGetTickCount();
+	uint16_t startCnt = TCC0.CNT;
+	uint16_t stored = 0;
+
+	for(uint16_t i = 0; i < length; i++) {
+		char c = digits[i];
+		uint8_t digit = 0xFF;
+		if(c >= '0' && c <= '9') {
+			digit = c - '0';
+		} else if(c >= 'A' && c <= 'F') {
+			digit = c - 'A' + 10;
+		}
+		if(xDigitStoreAppend(digit)) {
+			stored++;
+		}
+	}
+	digitStats.appends += stored;
+	digitStats.appendUSTotal += ulDisplayElapsedUS(startTick, startCnt);
+	return stored;
+}
+
+uint16_t uxDigitStoreCount(void) {
+	uint16_t count;
+	taskENTER_CRITICAL();
+	count = digitCount;
+	taskEXIT_CRITICAL();
+	return count;
+}
+
+uint8_t ucDigitStoreGet(uint16_t index) {
+	if(index >= uxDigitStoreCount()) {
+		return 0;
+	}
+	if(index & 0x01) {
+		return digitStore[index >> 1] & 0x0F;
+	}
+	return digitStore[index >> 1] >> 4;
+}
+
+char cDigitStoreGetChar(uint16_t index) {
+	uint8_t digit;
+	if(index >= uxDigitStoreCount()) {
+		return ' ';
+	}
+	digit = ucDigitStoreGet(index);
+	return digit < 10 ? '0' + digit : 'A' + digit - 10;
+}
+
+void vDigitStoreGetStats(digitStoreStats_t *stats) {
+	taskENTER_CRITICAL();
+	*stats = digitStats;
+	stats->count = digitCount;
+	taskEXIT_CRITICAL();
+	stats->capacity = DIGIT_STORE_CAPACITY;
+	stats->bytes = (stats->count + 1) / 2;
+}
@@ -104,6 +104,14 @@ void CCPWrite( volatile uint8_t * address, uint8_t value )
 	// Restore global interrupt setting from scratch register.
         asm("out  0x3F, R1");
 
+#elif !defined __AVR__
+	// Host build against tools/hostmock: the mock checks the CCP timing and
+	// applies both writes right away, so the result reads back like on the target.
+	AVR_ENTER_CRITICAL_REGION( );
+	vMockRegWrite( MOCK_IO( CCP ), CCP_IOREG_gc );
+	vMockRegWrite( MOCK_IO( *address ), value );
+	AVR_LEAVE_CRITICAL_REGION( );
+
 #elif defined __GNUC__
 	AVR_ENTER_CRITICAL_REGION( );
 	volatile uint8_t * tmpAddr = address;
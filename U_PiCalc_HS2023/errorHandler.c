@@ -6,12 +6,20 @@
  */ 
 
  #include "avr_compiler.h"
+ #include <avr/eeprom.h>
  #include "FreeRTOS.h"
  #include "task.h"
  #include "queue.h"
  #include "event_groups.h"
+ #include "timers.h"
  #include "stack_macros.h"
  #include "errorHandler.h"
+ #include "NHD0420Driver.h"
+ #include "ButtonHandler.h"
+ #include "stackConfig.h"
+ #include "uartDriver.h"
+ #include "mem_check.h"
+ #include "utils.h"
 
 
  typedef void tskTCB;
@@ -20,6 +28,7 @@
  // local prototypes
  void vApplicationStackOverflowHook( xTaskHandle *pxTask, signed portCHAR *pcTaskName );
  void vApplicationMallocFailedHook( void );
+ static uint16_t prvStackUnused(void *task);
 
  //----------------------------------------------
  // catch heap overflow
@@ -50,31 +59,137 @@
  //
  void errorNonFatal(uint8_t errCode)
  {
-	 (void)errCode;
+	 vInitUart();
+	 vUartLock();
+	 vUartPrint("ERR ");
+	 vUartPrintNumber(errCode);
+	 vUartPrint("\r\n");
+	 vUartUnlock();
+ }
+
+ //----------------------------------------------
+ //
+ // crash record
+ //
+ // error() fills crashRecord, which is in .noinit and survives the
+ // software reset, and copies it to the EEPROM for power cycles.
+ // Nothing is logged before an error happens.
+ //
+ #define CRASH_RECORD_MAGIC	0xC7A5
 
-	 uint8_t a=42; (void)a;
+ static crashRecord_t crashRecord __attribute__((section(".noinit")));
+ static crashRecord_t EEMEM crashRecordEeprom;
+ static uint8_t crashResetReason = 0;
+ static uint8_t crashValid = 0;
 
+ static uint8_t prvCrashChecksum(const crashRecord_t *record)
+ {
+	 const uint8_t *bytes = (const uint8_t *) record;
+	 uint8_t sum = 0;
+	 for(uint8_t i = 0; i < offsetof(crashRecord_t, checksum); i++)
+	 {
+		 sum += bytes[i];
+	 }
+	 return ~sum;
+ }
+
+ static uint8_t prvCrashRecordValid(const crashRecord_t *record)
+ {
+	 return record->magic == CRASH_RECORD_MAGIC && record->checksum == prvCrashChecksum(record);
+ }
+
+ void vCrashRecordBoot(void)
+ {
+	 crashResetReason = getResetReason();
+	 if(crashResetReason != RESETREASON_SOFTWARERESET || !prvCrashRecordValid(&crashRecord))
+	 {
+		 // power cycle or an old record, the EEPROM has the last crash
+		 eeprom_read_block(&crashRecord, &crashRecordEeprom, sizeof(crashRecord));
+	 }
+	 crashValid = prvCrashRecordValid(&crashRecord);
+	 vCrashRecordReport();
+ }
+
+ uint8_t xCrashRecordGet(crashRecord_t *record)
+ {
+	 if(crashValid)
+	 {
+		 *record = crashRecord;
+	 }
+	 return crashValid;
  }
 
  //----------------------------------------------
  //
- void error(uint8_t errCode)
+ // Prints "CRASH <reset reason> <crash resets> [<error code> <task> <sp>
+ // <uptime ms> <heap free> <task stack unused> <main stack unused>]"
+ //
+ void vCrashRecordReport(void)
  {
-	 uint8_t a;
+	 vInitUart();
+	 vUartLock();
+	 vUartPrint("CRASH ");
+	 vUartPrintNumber(crashResetReason);
+	 vUartPutChar(' ');
+	 vUartPrintNumber(crashValid ? crashRecord.resets : 0);
+	 if(crashValid)
+	 {
+		 vUartPutChar(' ');
+		 vUartPrintNumber(crashRecord.errCode);
+		 vUartPutChar(' ');
+		 vUartPrint(crashRecord.taskName);
+		 vUartPutChar(' ');
+		 vUartPrintNumber(crashRecord.sp);
+		 vUartPutChar(' ');
+		 vUartPrintNumber(crashRecord.uptimeMS);
+		 vUartPutChar(' ');
+		 vUartPrintNumber(crashRecord.heapFree);
+		 vUartPutChar(' ');
+		 vUartPrintNumber(crashRecord.taskStackUnused);
+		 vUartPutChar(' ');
+		 vUartPrintNumber(crashRecord.mainStackUnused);
+	 }
+	 vUartPrint("\r\n");
+	 vUartUnlock();
+ }
 
-	 if(errCode==ERR_STACK_OVERFLOW)
-	 a = 1;
-	 else if(errCode==ERR_QUEUE_SEND_FAILED)
-	 a = 2;
-	 else if(errCode==ERR_BYTES_SHOULD_BE_AVAILABLE)
-	 a = 3;
-	 else
-	 a = 4;
+ //----------------------------------------------
+ //
+ void error(uint8_t errCode)
+ {
+	 uint16_t resets = 0;
+	 const char *name = "-";
 
-	 // TODO from here:
-	 //
-	 // - log the occurance of any error in flash mem (inc counter)
-	 // - print a message
+	 // may be called from a hook inside the kernel or an ISR, nothing else runs from here
+	 cli();
+	 if(eeprom_read_word(&crashRecordEeprom.magic) == CRASH_RECORD_MAGIC)
+	 {
+		 resets = eeprom_read_word(&crashRecordEeprom.resets);
+	 }
+	 crashRecord.magic = CRASH_RECORD_MAGIC;
+	 crashRecord.errCode = errCode;
+	 crashRecord.resets = resets + 1;
+	 crashRecord.sp = SP;
+	 crashRecord.uptimeMS = xTaskGetTickCountFromISR() * portTICK_PERIOD_MS;
+	 crashRecord.heapFree = xPortGetFreeHeapSize();
+	 crashRecord.taskStackUnused = 0;
+	 if(pxCurrentTCB != NULL)
+	 {
+		 name = pcTaskGetName(NULL);
+		 crashRecord.taskStackUnused = prvStackUnused(NULL);
+	 }
+	 for(uint8_t i = 0; i < configMAX_TASK_NAME_LEN; i++)
+	 {
+		 crashRecord.taskName[i] = name[i];
+		 if(name[i] == '\0')
+		 {
+			 break;
+		 }
+	 }
+	 crashRecord.taskName[configMAX_TASK_NAME_LEN] = '\0';
+	 crashRecord.mainStackUnused = get_mem_unused();
+	 crashRecord.checksum = prvCrashChecksum(&crashRecord);
+	 eeprom_update_block(&crashRecord, &crashRecordEeprom, sizeof(crashRecord));
 
 	 software_reset();
  }
@@ -86,4 +201,136 @@
 	 asm("nop");
 	 CPU_CCP  = CCP_IOREG_gc;
 	 RST.CTRL = RST_SWRST_bm ;	 
- }
\ No newline at end of file
+ }
+
+ //----------------------------------------------
+ //
+ // stack monitor
+ //
+ typedef struct {
+	 TaskHandle_t task;
+	 uint16_t stackSize;
+	 uint8_t reported;
+ } stackEntry_t;
+
+ static stackEntry_t stackEntries[STACK_MONITOR_MAX_TASKS];
+ static volatile uint8_t stackEntryCount = 0;
+
+ // The entry is complete before the count includes it, so readers in
+ // other tasks never see a half written one.
+ void vStackMonitorAdd(void *task, uint16_t stackSize)
+ {
+	 if(task == NULL)
+	 {
+		 return;
+	 }
+	 taskENTER_CRITICAL();
+	 for(uint8_t i = 0; i < stackEntryCount; i++)
+	 {
+		 if(stackEntries[i].task == task)
+		 {
+			 taskEXIT_CRITICAL();
+			 return;
+		 }
+	 }
+	 if(stackEntryCount < STACK_MONITOR_MAX_TASKS)
+	 {
+		 stackEntries[stackEntryCount].task = task;
+		 stackEntries[stackEntryCount].stackSize = stackSize;
+		 stackEntries[stackEntryCount].reported = 0;
+		 stackEntryCount++;
+	 }
+	 taskEXIT_CRITICAL();
+ }
+
+ uint8_t xStackMonitorGet(uint8_t index, void **task, uint16_t *stackSize)
+ {
+	 if(index >= stackEntryCount)
+	 {
+		 return 0;
+	 }
+	 *task = stackEntries[index].task;
+	 *stackSize = stackEntries[index].stackSize;
+	 return 1;
+ }
+
+ static void prvPrintStack(const stackEntry_t *entry, uint16_t unused)
+ {
+	 vUartLock();
+	 vUartPrint("STACK ");
+	 vUartPrint(pcTaskGetName(entry->task));
+	 vUartPutChar(' ');
+	 vUartPrintNumber(entry->stackSize);
+	 vUartPutChar(' ');
+	 vUartPrintNumber(entry->stackSize - unused);
+	 vUartPutChar(' ');
+	 vUartPrintNumber(unused);
+	 vUartPrint("\r\n");
+	 vUartUnlock();
+ }
+
+ // Free bytes at the bottom of the stack. The TaskStatus_t field is 16 bit,
+ // uxTaskGetStackHighWaterMark() returns an 8 bit UBaseType_t on this port.
+ static uint16_t prvStackUnused(void *task)
+ {
+	 TaskStatus_t status;
+
+	 vTaskGetInfo(task, &status, pdTRUE, eReady);
+	 return status.usStackHighWaterMark;
+ }
+
+ static void prvAddKernelTasks(void)
+ {
+	 // the kernel tasks only exist once the scheduler runs
+	 vStackMonitorAdd(xTaskGetIdleTaskHandle(), configMINIMAL_STACK_SIZE);
+	 vStackMonitorAdd(xTimerGetTimerDaemonTaskHandle(), configTIMER_TASK_STACK_DEPTH);
+ }
+
+ //----------------------------------------------
+ //
+ // Raises ERR_LOW_STACK_SPACE once per task that has
+ // less than STACK_LOW_MARGIN bytes left. Reads the
+ // high water marks one task at a time, nothing is
+ // shared with vStackReport in the controller task.
+ //
+ void checkAllStacks(void)
+ {
+	 prvAddKernelTasks();
+	 for(uint8_t i = 0; i < stackEntryCount; i++)
+	 {
+		 stackEntry_t *entry = &stackEntries[i];
+		 uint16_t unused = prvStackUnused(entry->task);
+
+		 if(unused < STACK_LOW_MARGIN && entry->reported == 0)
+		 {
+			 entry->reported = 1;
+			 errorNonFatal(ERR_LOW_STACK_SPACE);
+			 prvPrintStack(entry, unused);
+		 }
+	 }
+ }
+
+ //----------------------------------------------
+ //
+ // Prints "STACK <name> <allocated> <peak> <unused>"
+ // for every task and the static RAM summary.
+ //
+ void vStackReport(void)
+ {
+	 prvAddKernelTasks();
+	 vInitUart();
+	 for(uint8_t i = 0; i < stackEntryCount; i++)
+	 {
+		 prvPrintStack(&stackEntries[i], prvStackUnused(stackEntries[i].task));
+	 }
+	 // "RAM <static rtos objects> <budget> <saved>"
+	 vUartLock();
+	 vUartPrint("RAM ");
+	 vUartPrintNumber(RTOS_STATIC_RAM);
+	 vUartPutChar(' ');
+	 vUartPrintNumber(RTOS_RAM_BUDGET);
+	 vUartPutChar(' ');
+	 vUartPrintNumber(RTOS_RAM_BUDGET - RTOS_STATIC_RAM);
+	 vUartPrint("\r\n");
+	 vUartUnlock();
+ }
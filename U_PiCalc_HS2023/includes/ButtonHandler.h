@@ -9,10 +9,28 @@
 #ifndef BUTTONHANDLER_H_
 #define BUTTONHANDLER_H_
 
+#include <stdint.h>
+#include "buttonEngine.h"
+
 /*---------------------------------------------------------------------------------*/
 // UpdateFrequency of the main-program-loop. Should be between 20Hz and 1000Hz
 /*---------------------------------------------------------------------------------*/
 #define BUTTON_UPDATE_FREQUENCY_HZ	100
+#define BUTTON_COUNT				4	//Entries of the pin table in ButtonHandler.c
+
+/*---------------------------------------------------------------------------------*/
+// 1: PORTF pin-change interrupts start an RTOS timer that samples the buttons every
+// BUTTON_SAMPLE_MS until all are released and debounced again. Events come out of
+// getButtonEvent(), nothing runs while no button is touched.
+// 0: updateButtons() has to be polled as described below.
+// Debouncing and classification is done by buttonEngine.c in both cases.
+/*---------------------------------------------------------------------------------*/
+#define BUTTON_USE_INTERRUPTS		1
+#define BUTTON_SAMPLE_MS			5	//Sample period with interrupts, a change needs 4 equal samples
+#define BUTTON_LONG_MS				500	//Held this long: BUTTON_EVENT_LONG (no SHORT on release)
+#define BUTTON_REPEAT_MS			200	//Held after the LONG event: BUTTON_EVENT_REPEAT with this period
+#define BUTTON_CHORD_MS				100	//Second button within this time: BUTTON_EVENT_CHORD instead of SHORT/LONG
+#define BUTTON_QUEUE_DEPTH			8
 
 typedef enum button_tag {
 	BUTTON1,
@@ -27,6 +45,21 @@ typedef enum button_press_tag {
 	NOT_PRESSED
 } button_press_t;
 
+#if BUTTON_USE_INTERRUPTS == 1
+#include "FreeRTOS.h"
+
+typedef struct {
+	uint32_t edges;			//Pin-change interrupts
+	uint32_t debounceRuns;	//Samples taken by the timer, the CPU the buttons cost
+	uint32_t events;		//Events queued
+	uint16_t dropped;		//Events lost because the queue was full
+} buttonStats_t;
+
+#define BUTTON_RTOS_RAM		( sizeof(StaticQueue_t) + BUTTON_QUEUE_DEPTH * sizeof(buttonEvent_t) + sizeof(StaticTimer_t) )
+#else
+#define BUTTON_RTOS_RAM		0
+#endif
+
 /*---------------------------------------------------------------------------------*/
 //Call this Init-Function in the Init-Section of your program
 /*---------------------------------------------------------------------------------*/
@@ -41,8 +74,20 @@ void updateButtons(void);
 
 /*---------------------------------------------------------------------------------*/
 // Has to be called directly after each updateButtons() call for each Button you 
-// want to check.
+// want to check. The result is only valid until the next updateButtons() call:
+// SHORT_PRESSED on release, LONG_PRESSED once while the button is still held.
 /*---------------------------------------------------------------------------------*/
 button_press_t getButtonPress(button_t button);
 
+#if BUTTON_USE_INTERRUPTS == 1
+/*---------------------------------------------------------------------------------*/
+// Takes the next event, waits up to ticksToWait. Returns pdTRUE if there was one.
+// The timestamp is the low 32 bit of the bench clock (benchClock.h) at the first
+// edge of the change, at the sample for LONG and REPEAT.
+// initButtons() has to be called from a task before (it creates the timer).
+/*---------------------------------------------------------------------------------*/
+BaseType_t getButtonEvent(buttonEvent_t *event, TickType_t ticksToWait);
+void getButtonStats(buttonStats_t *stats);
+#endif
+
 #endif /* BUTTONHANDLER_H_ */
\ No newline at end of file
@@ -31,10 +31,16 @@
 #include <avr/io.h>
 
 #define configUSE_PREEMPTION		1
+#if HOSTSIM == 1
+#define configUSE_IDLE_HOOK			1 // host simulation: the idle task waits for the next interrupt in virtual time (tools/hostsim/port.c)
+#else
 #define configUSE_IDLE_HOOK			0
-#define configUSE_TICK_HOOK			0
+#endif
+#define configUSE_TICK_HOOK			1 // sampling profiler (profiler.c)
 
-#define configCPU_CLOCK_HZ			( ( unsigned portLONG ) 32000000 )
+// Set by the clock profile at runtime (init.c), F_CPU is the default profile for delay_us()
+uint32_t ulClockCpuHz( void );
+#define configCPU_CLOCK_HZ			( ulClockCpuHz() )
 #ifndef F_CPU
 # warning ("F_CPU undefined !")
 #else
@@ -76,12 +82,17 @@
 //#define configTICK_RATE_HZ			( ( TickType_t ) 1000 )
 #define configMAX_PRIORITIES			( 4 )
 #define configMINIMAL_STACK_SIZE		( ( unsigned short ) 200 )
-#define configTOTAL_HEAP_SIZE			( (size_t ) ( 4000 ) )
+#ifndef configTOTAL_HEAP_SIZE
+#define configTOTAL_HEAP_SIZE			( (size_t ) ( 80 ) ) // only co-routine control blocks, everything else is static (stackConfig.h)
+#endif
 #define configMAX_TASK_NAME_LEN			( 8 )
 #define configUSE_TRACE_FACILITY		1
 #define configUSE_16_BIT_TICKS			0
 #define configIDLE_SHOULD_YIELD			1
 #define configCHECK_FOR_STACK_OVERFLOW	2
+#define configSUPPORT_STATIC_ALLOCATION	1
+#define configSUPPORT_DYNAMIC_ALLOCATION	1
+#define configUSE_MUTEXES				1 // UART line lock (uartDriver.c)
 
 /* Co-routine definitions. */
 #define configUSE_CO_ROUTINES 		1
@@ -100,6 +111,7 @@ to exclude the API function. */
 
 #define INCLUDE_uxTaskGetStackHighWaterMark	1 // used to check if stack is going low
 #define	INCLUDE_xTaskGetCurrentTaskHandle	1
+#define INCLUDE_xTaskGetIdleTaskHandle		1 // stack monitor (errorHandler.c)
 
 #define configUSE_TIMERS				1
 #define INCLUDE_xTimerPendFunctionCall	1
@@ -107,4 +119,8 @@ to exclude the API function. */
 #define configTIMER_TASK_PRIORITY		3
 #define configTIMER_TASK_STACK_DEPTH	configMINIMAL_STACK_SIZE
 
+/* Application trace recorder, fills the kernel trace macros (see traceRecorder.h). */
+#define configUSE_TRACE_RECORDER		1
+#include "traceRecorder.h"
+
 #endif /* FREERTOS_CONFIG_H */
@@ -9,8 +9,24 @@
 #ifndef NHD0420DRIVER_H_
 #define NHD0420DRIVER_H_
 
-#define DISPLAY_QUEUE_DEPTH 8 //Queue Depth of Display Queue. The more vDisplayWriteStringAtPos calls you have between Display-Updates, the more Queue-Spots you need.
+#include <stdarg.h>
+
+#define DISPLAY_USE_FRAMEBUFFER 1 //1: writers update a shared framebuffer in place (per-line sequence counters), 0: lines are copied through displayLineQueue.
+#define DISPLAY_QUEUE_DEPTH 8 //Only with DISPLAY_USE_FRAMEBUFFER 0, size it from the QUEUE report (peak, overflows). Queue Depth of Display Queue. The more vDisplayWriteStringAtPos calls you have between Display-Updates, the more Queue-Spots you need.
 #define DISPLAY_UPDATE_TIME_MS 200 //Update-Time of Display-Task. 
+#ifndef DISPLAY_USE_TX_ENGINE
+#define DISPLAY_USE_TX_ENGINE 1 //1: the TCF0 ISR clocks the frames out of a ring buffer, the display task only waits for the end of the frame.
+#endif
+#define DISPLAY_TX_BUFFER_SIZE 96 //Ring entries (3 bytes each), one per command or character. A full frame is 4 set-positions + 80 characters.
+#ifndef DISPLAY_USE_BUSY_FLAG
+#define DISPLAY_USE_BUSY_FLAG 0 //1: poll the HD44780 busy flag instead of waiting the worst case (blocking path only). Needs RW on PD1 and a display that drives 3.3V levels.
+#endif
+#define DISPLAY_BUSY_TIMEOUT_US 3000 //Polling gives up after this (timed with TCF0), then the fixed delays are used again.
+#define DISPLAY_DELAY_NOTIFY 1 //1: the TCF0 ISR wakes the task in delayUS with a task notification, 0: through egDisplayTiming (deferred to the timer daemon).
+#define DISPLAY_DELAY_SPIN_US 50 //With DISPLAY_DELAY_NOTIFY 1, shorter delays poll TCF0 instead of blocking.
+#define DISPLAY_FORMAT_BENCHMARK 0 //1: compile vDisplayFormatBenchmark, links sprintf with float support for the comparison.
+#define DISPLAY_BUS_CAPTURE 0 //1: record every nibble latched on the display bus for tools/hd44780emu.py (see NHD0420Hal.h).
+#define DISPLAY_BUS_CAPTURE_SIZE 192 //Capture entries (3 bytes each). A full frame with the TX engine is up to 168 nibbles.
 
 
 typedef struct{
@@ -19,8 +35,42 @@ typedef struct{
 	 uint8_t displayBuffer[20];
 }displayLine_t;
 
+#if DISPLAY_USE_FRAMEBUFFER == 1
+#define DISPLAY_PATH_RAM (4 * 20 + 4) //Framebuffer and sequence counters
+#else
+#define DISPLAY_PATH_RAM (sizeof(StaticQueue_t) + DISPLAY_QUEUE_DEPTH * sizeof(displayLine_t) + 4 * 20 + 4 * 4 + 1) //Queue, its storage and the overflow merge buffer
+#endif
+
+typedef struct{
+	uint32_t frames;			//Refresh windows since start
+	uint32_t bytesTotal;		//Commands and characters sent since start
+	uint16_t lastFrameBytes;	//Commands and characters sent in the last refresh
+	uint32_t lastFrameUS;		//Bus time of the last refresh
+	uint32_t maxFrameUS;		//Longest refresh so far
+	uint32_t busUSTotal;		//Bus time of all refreshes, bytesTotal / busUSTotal = throughput
+	uint8_t busyFlagActive;		//1 if the busy flag is polled
+	uint32_t writes;			//vDisplayWriteStringAtPos calls
+	uint32_t lastWriteUS;		//Format and hand-over time of the last write, incl. waiting for a queue slot
+	uint32_t maxWriteUS;
+	uint16_t pathRAM;			//RAM of the writer -> display task path (DISPLAY_PATH_RAM)
+	uint32_t delaySpins;		//delayUS calls that polled TCF0
+	uint32_t delaySleeps;		//delayUS calls that blocked until the TCF0 ISR
+	uint32_t lastDelayLateUS;	//How much later than requested the last blocking delayUS returned (wakeup latency)
+	uint32_t maxDelayLateUS;
+	uint32_t delayLateUSTotal;	//delayLateUSTotal / delaySleeps = average wakeup latency
+	uint32_t coalesced;			//Writes to a line that was already written in the same refresh window
+	uint32_t overflows;			//Writes that found the queue full and were merged per line instead (queue only)
+	uint8_t queuePeak;			//Most entries in displayLineQueue after a write (queue only)
+}displayStats_t;
+
 void vInitDisplay();
 void vDisplayClear();
 void vDisplayWriteStringAtPos(int line, int pos, char const *fmt, ...);
+void vDisplayGetStats(displayStats_t *stats);
+uint8_t uxDisplayFormat(char *out, uint8_t size, char const *fmt, va_list arg); //Formatter of vDisplayWriteStringAtPos, writes at most size chars without terminator
+uint32_t ulDisplayElapsedUS(TickType_t startTick, uint16_t startCnt); //us since xTaskGetTickCount() / TCC0.CNT were sampled
+#if DISPLAY_FORMAT_BENCHMARK == 1
+void vDisplayFormatBenchmark(uint16_t runs, uint32_t *formatUS, uint32_t *sprintfUS);
+#endif
 
 #endif /* NHD0420DRIVER_H_ */
\ No newline at end of file
@@ -0,0 +1,82 @@
+/*
+ * NHD0420Hal.h
+ *
+ * Created: 19.10.2026 03:17:35
+ *  Author: agent
+ */ 
+
+
+#ifndef NHD0420HAL_H_
+#define NHD0420HAL_H_
+
+#include <stdint.h>
+#include "avr_compiler.h"
+#include "NHD0420Driver.h"
+
+/*---------------------------------------------------------------------------------*/
+// Pin level of the HD44780 4-bit bus. Everything the driver puts on the bus goes
+// through these functions: DB7..4 = PORTA.7..4, RS = PD0, RW = PD1, E = PD2.
+// With DISPLAY_BUS_CAPTURE 1 every falling edge of E (the moment the controller
+// latches a nibble) is recorded with RS, RW, the nibble and a us timestamp.
+// vDisplayBusDump() sends the record over the UART, tools/hd44780emu.py replays
+// it against an HD44780 model: DDRAM content per frame, bus time per frame and
+// every wait that was shorter than the datasheet execution time.
+// On the host the driver runs unchanged on the register mock and these functions
+// drive the same model live (tools/hostmock/hd44780.c): tools/hostsim checks the
+// screen and the bus timing of the whole firmware, tools/tests/test_hd44780.c the
+// bus cycles themselves.
+/*---------------------------------------------------------------------------------*/
+#define DISPLAY_BUS_RS		0x10	//Capture entry: RS was high (data register)
+#define DISPLAY_BUS_RW		0x20	//Capture entry: RW was high (read)
+#define DISPLAY_BUS_MARK	0x80	//Capture entry: start of a frame, no bus cycle
+
+#if DISPLAY_BUS_CAPTURE == 1
+void vDisplayBusLatch(uint8_t bus);
+void vDisplayBusMark(void);
+void vDisplayBusDump(void);
+#else
+#define vDisplayBusMark()
+#define vDisplayBusDump()
+#endif
+
+static inline void halDisplayPort(uint8_t nibble) {
+	uint8_t data = (nibble & 0x0F) << 4;
+	PORTA.OUT &= (data | 0x0F);
+	PORTA.OUT |= data;
+}
+
+static inline void halDisplayRS(uint8_t value) {
+	if(value > 0) {
+		PORTD.OUTSET = PIN0_bm;
+	} else {
+		PORTD.OUTCLR = PIN0_bm;
+	}
+}
+
+static inline void halDisplayRW(uint8_t value) {
+	if(value > 0) {
+		PORTD.OUTSET = PIN1_bm;
+	} else {
+		PORTD.OUTCLR = PIN1_bm;
+	}
+}
+
+static inline void halDisplayE(uint8_t value) {
+	if(value > 0) {
+		PORTD.OUTSET = PIN2_bm;
+	} else {
+#if DISPLAY_BUS_CAPTURE == 1
+		uint8_t bus = (PORTA.OUT >> 4) & 0x0F;
+		if(PORTD.OUT & PIN0_bm) {
+			bus |= DISPLAY_BUS_RS;
+		}
+		if(PORTD.OUT & PIN1_bm) {
+			bus |= DISPLAY_BUS_RW;
+		}
+		vDisplayBusLatch(bus);
+#endif
+		PORTD.OUTCLR = PIN2_bm;
+	}
+}
+
+#endif /* NHD0420HAL_H_ */
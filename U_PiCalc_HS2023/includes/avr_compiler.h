@@ -146,8 +146,10 @@
 
 #define INLINE static inline
 
-/*! \brief Define the no operation macro. */
+/*! \brief Define the no operation macro, the host mock brings its own. */
+#ifndef nop
 #define nop()   do { __asm__ __volatile__ ("nop"); } while (0)
+#endif
 
 #define MAIN_TASK_PROLOGUE int
 
@@ -0,0 +1,35 @@
+/*
+ * benchClock.h
+ *
+ * Created: 19.10.2026 03:25:37
+ *  Author: agent
+ */ 
+
+
+#ifndef BENCHCLOCK_H_
+#define BENCHCLOCK_H_
+
+#include <stdint.h>
+
+/*---------------------------------------------------------------------------------*/
+// Free running cycle counter for benchmarks. TCD0 counts CPU cycles, its overflow
+// clocks TCD1 over event channel 0, which makes a 32 bit counter in hardware
+// (wraps after 134s at 32MHz). The TCD1 overflow ISR extends it to 64 bit.
+// The host simulation (HOSTSIM, tools/hostsim) runs the same code on the mocked
+// timers. Other host builds (tools/pibench_host.c) use CLOCK_MONOTONIC in ns.
+// Both read functions are safe from tasks and from ISRs up to
+// configMAX_SYSCALL_INTERRUPT_PRIORITY.
+/*---------------------------------------------------------------------------------*/
+#if defined(__AVR__) || HOSTSIM == 1
+	#include "init.h"
+	#define BENCH_CLOCK_HZ		ulClockCpuHz()	//TCD0 runs at the CPU clock (DIV1) of the clock profile
+#else
+	#define BENCH_CLOCK_HZ		1000000000UL
+#endif
+#define BENCH_CLOCK_EVCH		0			//Event channel for the TCD0 -> TCD1 cascade
+
+void vBenchClockInit(void);
+uint64_t ullBenchClockCycles(void);		//Counts of BENCH_CLOCK_HZ since vBenchClockInit
+uint64_t ullBenchClockUS(void);
+
+#endif /* BENCHCLOCK_H_ */
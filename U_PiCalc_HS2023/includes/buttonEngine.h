@@ -0,0 +1,73 @@
+/*
+ * buttonEngine.h
+ *
+ * Created: 19.10.2026 03:23:47
+ *  Author: agent
+ */ 
+
+
+#ifndef BUTTONENGINE_H_
+#define BUTTONENGINE_H_
+
+#include <stdint.h>
+
+/*---------------------------------------------------------------------------------*/
+// Debouncer and event classifier for up to 8 inputs. Pure C without hardware or
+// RTOS dependencies, so it also builds on the host and can be fed scripted traces.
+// Each sample bit n = 1 means input n is pressed. An input has to read the same
+// for 4 samples in a row (2 bit vertical counter, all inputs at once) before it
+// changes state. Times are given in samples.
+// The timestamps of the events that follow an edge (PRESS, RELEASE, SHORT, CHORD)
+// are the edge time of the first sample that disagreed with the state, kept
+// through the bounces. LONG and REPEAT have the now of their sample.
+/*---------------------------------------------------------------------------------*/
+#define BUTTON_ENGINE_MAX			8
+
+typedef enum button_event_type_tag {
+	BUTTON_EVENT_PRESS,		//Debounced press
+	BUTTON_EVENT_RELEASE,	//Debounced release
+	BUTTON_EVENT_SHORT,		//Released before the long time, not part of a chord
+	BUTTON_EVENT_LONG,		//Held for the long time, sent while the input is still down
+	BUTTON_EVENT_REPEAT,	//Still held, every repeat time after the LONG event
+	BUTTON_EVENT_CHORD		//Two inputs pressed within the chord time, button is the bit mask of both
+} button_event_type_t;
+
+typedef struct {
+	uint8_t button;			//Input number, bit mask for BUTTON_EVENT_CHORD
+	uint8_t type;			//button_event_type_t
+	uint32_t timestamp;		//edge of the change or now of the sample, see above
+} buttonEvent_t;
+
+typedef struct {
+	uint8_t count;			//Inputs in use
+	uint8_t state;			//Debounced state, bit n: input n is down
+	uint8_t cnt0;			//Vertical counter, bit 0 of each input's counter
+	uint8_t cnt1;			//Vertical counter, bit 1
+	uint8_t longSent;		//LONG was sent for the current press
+	uint8_t chorded;		//Input is part of a chord for the current press
+	uint8_t edgeLatched;	//Input disagrees with the state, edge[] holds the start of the change
+	uint8_t quiet[BUTTON_ENGINE_MAX];	//Samples agreeing with the state since the last disagreement, up to 4
+	uint32_t edge[BUTTON_ENGINE_MAX];
+	uint16_t longSamples;
+	uint16_t repeatSamples;
+	uint16_t chordSamples;
+	uint16_t held[BUTTON_ENGINE_MAX];	//Samples since the debounced press, saturating
+} buttonEngine_t;
+
+void buttonEngineInit(buttonEngine_t *engine, uint8_t count, uint16_t longSamples, uint16_t repeatSamples, uint16_t chordSamples);
+
+/*---------------------------------------------------------------------------------*/
+// Feeds one sample, writes up to maxEvents events and returns how many. With 8
+// inputs a single sample can produce at most 3 events per input. edge is the time
+// of the first edge since the previous sample (same unit as now), now if there
+// was none or edges are not seen.
+/*---------------------------------------------------------------------------------*/
+uint8_t buttonEngineSample(buttonEngine_t *engine, uint8_t sample, uint32_t now, uint32_t edge, buttonEvent_t *events, uint8_t maxEvents);
+
+/*---------------------------------------------------------------------------------*/
+// 1 if nothing is pressed and no input is in the middle of debouncing, further
+// samples of an all-released input produce nothing.
+/*---------------------------------------------------------------------------------*/
+uint8_t buttonEngineIdle(const buttonEngine_t *engine);
+
+#endif /* BUTTONENGINE_H_ */
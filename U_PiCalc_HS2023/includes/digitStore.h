@@ -0,0 +1,39 @@
+/*
+ * digitStore.h
+ *
+ * Created: 19.10.2026 03:19:59
+ *  Author: agent
+ */ 
+
+
+#ifndef DIGITSTORE_H_
+#define DIGITSTORE_H_
+
+#include <stdint.h>
+
+/*---------------------------------------------------------------------------------*/
+// Append-only store for the digits an engine produced, packed two per byte (BCD,
+// or hex nibbles with DIGIT_STORE_HEX 1). The producer appends, the UI reads by
+// index. Indices below uxDigitStoreCount() never change until vDigitStoreReset().
+/*---------------------------------------------------------------------------------*/
+#define DIGIT_STORE_CAPACITY	600		//Digits, needs DIGIT_STORE_CAPACITY / 2 bytes of RAM
+#define DIGIT_STORE_HEX			0		//1: digits are 0..15 (hex engines), 0: 0..9
+
+typedef struct{
+	uint16_t count;				//Digits stored
+	uint16_t capacity;			//DIGIT_STORE_CAPACITY
+	uint16_t bytes;				//RAM used by the digits stored so far
+	uint32_t appends;			//Digits appended through uxDigitStoreAppendString
+	uint32_t appendUSTotal;		//Time spent in uxDigitStoreAppendString, appendUSTotal / appends = cost per digit
+	uint16_t rejected;			//Digits that were out of range or did not fit
+}digitStoreStats_t;
+
+void vDigitStoreReset(void);
+uint8_t xDigitStoreAppend(uint8_t digit);						//pdFALSE if the digit is out of range or the store is full
+uint16_t uxDigitStoreAppendString(const char *digits, uint16_t length);	//ASCII digits, returns how many were stored
+uint16_t uxDigitStoreCount(void);
+uint8_t ucDigitStoreGet(uint16_t index);						//Digit value, 0 beyond the end
+char cDigitStoreGetChar(uint16_t index);						//'0'..'9' / 'A'..'F', ' ' beyond the end
+void vDigitStoreGetStats(digitStoreStats_t *stats);
+
+#endif /* DIGITSTORE_H_ */
@@ -9,6 +9,9 @@
 #ifndef ERRORHANDLER_H_
 #define ERRORHANDLER_H_
 
+#include <stdint.h>
+#include "FreeRTOSConfig.h"
+
 // error code defs
 //
 #define ERR_TEST					  100
@@ -30,6 +33,7 @@
 #define ERR_CHANNEL_QUEUE_FULL        57
 #define ERR_HEAP_TOO_LARGE			  58 // decrease configTOTAL_HEAP_SIZE = decrease rtos heap !
 #define ERR_LOW_GLOBAL_STACK_SPACE    59
+#define ERR_TASK_COUNT				  60 // more or less tasks created than RTOS_TASK_COUNT (stackConfig.h)
 
 // error reporting function
 //
@@ -38,4 +42,39 @@ void error(uint8_t errCode);
 void checkAllStacks(void);
 void software_reset(void);
 
+// crash record
+//
+// error() stores the context of the crash before the reset, vCrashRecordBoot()
+// (once at boot, before the scheduler starts) reads the reset reason and the
+// last record and prints it with vCrashRecordReport(). The record survives
+// power cycles (EEPROM), resets counts all error() resets so far.
+//
+typedef struct {
+	uint16_t magic;
+	uint8_t errCode;
+	char taskName[configMAX_TASK_NAME_LEN + 1];	//"-" before the first task is created
+	uint16_t sp;						//Stack pointer in error()
+	uint32_t uptimeMS;
+	uint16_t heapFree;					//FreeRTOS heap left
+	uint16_t taskStackUnused;			//High water mark of the crashed task
+	uint16_t mainStackUnused;			//get_mem_unused()
+	uint16_t resets;
+	uint8_t checksum;
+} crashRecord_t;
+
+void vCrashRecordBoot(void);
+uint8_t xCrashRecordGet(crashRecord_t *record);	//1 if a crash was recorded
+void vCrashRecordReport(void);
+
+// stack monitor
+//
+// Every task that should show its allocation in the report has to be added
+// once after xTaskCreate. IDLE and the timer daemon are added automatically.
+// checkAllStacks() is cheap enough to be called periodically, it only prints
+// something if a task is below STACK_LOW_MARGIN (see stackConfig.h).
+//
+void vStackMonitorAdd(void *task, uint16_t stackSize);
+uint8_t xStackMonitorGet(uint8_t index, void **task, uint16_t *stackSize);	//0 past the last task
+void vStackReport(void);
+
 #endif /* ERRORHANDLER_H_ */
\ No newline at end of file
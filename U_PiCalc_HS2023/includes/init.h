@@ -9,8 +9,30 @@
 #ifndef INIT_H_
 #define INIT_H_
 
-void vInitClock(void);
+#include <stdint.h>
+
+/*---------------------------------------------------------------------------------*/
+// Clock profiles. vClockSetProfile() can be called at any time, it re-derives the
+// tick period (TCC0) and the UART baud rate. Timer counts are converted with
+// ulClockCountsToUS / ulClockUSToCounts instead of fixed 2us per count (DIV64 at
+// 32MHz). Switch only while no engine runs, cycle counts taken across a switch
+// mix two clocks. delay_us() busy loops stay calculated for F_CPU (32MHz).
+/*---------------------------------------------------------------------------------*/
+#define CLOCK_PROFILE_XOSC_PLL		0	//8MHz crystal, PLL x4 = 32MHz
+#define CLOCK_PROFILE_RC32M_DFLL	1	//32MHz RC oscillator, DFLL calibrated against the 32kHz RC oscillator
+#define CLOCK_PROFILE_XOSC_PLL48	2	//8MHz crystal, PLL x6 = 48MHz, CPU and clkPER above the 32MHz of the datasheet
+#define CLOCK_PROFILE_COUNT			3
+#define CLOCK_PROFILE_DEFAULT		CLOCK_PROFILE_XOSC_PLL
 
+#define CLOCK_TICK_PRESCALER		64	//TCC0 (tick timer) runs at the CPU clock / 64
 
+void vInitClock(void);
+void vClockSetProfile(uint8_t profile);
+uint8_t ucClockGetProfile(void);
+const char *pcClockProfileName(uint8_t profile);
+uint32_t ulClockCpuHz(void);
+uint32_t ulClockProfileHz(uint8_t profile);
+uint32_t ulClockCountsToUS(uint32_t counts, uint16_t prescaler);	//Timer counts at CPU clock / prescaler to us
+uint32_t ulClockUSToCounts(uint32_t us, uint16_t prescaler);		//Rounded up
 
-#endif /* INIT_H_ */
\ No newline at end of file
+#endif /* INIT_H_ */
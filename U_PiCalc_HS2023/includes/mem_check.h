@@ -9,7 +9,31 @@
 #ifndef MEM_CHECK_H_
 #define MEM_CHECK_H_
 
+#include <stdint.h>
+#include "stackConfig.h"
+
+#define MEM_PROBE_GUARD   8    // words below the found edge that are checked one by one
+#define MEM_REGION_MAX    (3 + STACK_MONITOR_MAX_TASKS)
+
+typedef struct
+{
+   const char *name;
+   uint16_t size;
+   uint16_t unused;     // fill pattern still intact, the rest was touched at some point
+} memRegion_t;
+
 extern unsigned short get_mem_unused (void);
 
+// Untouched bytes at the start of a painted area, see mem_check.c. Needs no hardware.
+uint16_t mem_unused_painted (const uint8_t *base, uint16_t size, uint8_t fill, uint16_t *cache);
+
+// Regions: static (.data/.bss/.noinit), rtosheap, one per task of the stack monitor
+// (errorHandler.h) and main (stack before the scheduler starts). The probes are
+// cached, so this is cheap enough for every UI refresh. Stacks grow down, a local
+// array that is never written leaves a gap the search cannot see if it is more than
+// MEM_PROBE_GUARD words deep.
+uint8_t mem_inspect (memRegion_t *regions, uint8_t max);
+void mem_report (void);
+
 
 #endif /* MEM_CHECK_H_ */
\ No newline at end of file
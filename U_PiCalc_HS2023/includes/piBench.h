@@ -0,0 +1,69 @@
+/*
+ * piBench.h
+ *
+ * Created: 19.10.2026 03:27:50
+ *  Author: agent
+ */ 
+
+
+#ifndef PIBENCH_H_
+#define PIBENCH_H_
+
+#include <stdint.h>
+
+/*---------------------------------------------------------------------------------*/
+// Pi engines and the time-to-N-digits benchmark. The engines are the series
+// terms the calculation tasks in main.c add up. The suite runs every engine in
+// piEngines[] from its clean state and notes the iterations and bench clock
+// counts at which PI_BENCH_MIN_DECIMALS .. PI_BENCH_MAX_DECIMALS decimals are
+// settled for the first time (checked against a reference string in flash):
+// correct for the sum plus and minus the next term and one float step, so the
+// series can no longer change them. Rounding that accumulated over the terms
+// is not in that bound.
+// Pure C plus benchClock, so the same suite runs on the host (tools/pibench_host.c).
+/*---------------------------------------------------------------------------------*/
+#define PI_BENCH_MIN_DECIMALS		3
+#define PI_BENCH_MAX_DECIMALS		5			//Pi is 1.5 float steps below 3.141593, a float sum cannot settle 6 decimals
+#define PI_BENCH_MAX_ITERATIONS		2000000UL	//An engine gives up after this many terms
+#define PI_BENCH_JSON				0			//Report format, 0: CSV, 1: JSON
+
+typedef struct {
+	const char *name;
+	float initialValue;			//Value before the first term
+	uint32_t firstIteration;	//Iteration number of the first term
+	float (*term)(uint32_t iteration, int8_t sign);
+} piEngine_t;
+
+float fPiLeibnizTerm(uint32_t iteration, int8_t sign);		//4 / (2i + 1), first iteration 0
+float fPiNilakanthaTerm(uint32_t iteration, int8_t sign);	//4 / (2i (2i + 1) (2i + 2)), first iteration 1
+
+#define PI_ENGINE_COUNT		2
+extern const piEngine_t piEngines[PI_ENGINE_COUNT];	//Index = ENGINE_xxx in main.c
+
+typedef struct {
+	uint32_t iterations;		//0: not reached within PI_BENCH_MAX_ITERATIONS
+	uint64_t cycles;			//Bench clock counts since the start of the run
+} piBenchMark_t;
+
+typedef struct {
+	uint8_t engine;
+	uint8_t decimals;			//Most decimals that were settled at some point
+	uint32_t iterations;		//Terms calculated
+	piBenchMark_t marks[PI_BENCH_MAX_DECIMALS - PI_BENCH_MIN_DECIMALS + 1];
+} piBenchResult_t;
+
+uint8_t ucPiCorrectDecimals(float value);		//Decimals that match pi, up to PI_BENCH_MAX_DECIMALS
+void vPiBenchRun(uint8_t engine, piBenchResult_t *result);
+uint32_t ulPiBenchCyclesPerTerm(uint8_t engine, uint16_t terms);	//Bench clock counts per term, from the clean state
+
+/*---------------------------------------------------------------------------------*/
+// Writes the results through print (vUartPrint on the target). CSV:
+//   BENCH1 <clock hz>
+//   engine,decimals,iterations,us,cycles      (one line per engine and decimals)
+//   END
+// JSON: one object {"clock_hz":..,"results":[{"engine":..,"decimals":..,...},..]}
+// Marks that were not reached have iterations 0.
+/*---------------------------------------------------------------------------------*/
+void vPiBenchReport(const piBenchResult_t *results, uint8_t count, void (*print)(const char *s));
+
+#endif /* PIBENCH_H_ */
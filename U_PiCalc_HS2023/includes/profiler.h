@@ -0,0 +1,36 @@
+/*
+ * profiler.h
+ *
+ * Created: 19.10.2026 03:05:32
+ *  Author: agent
+ */ 
+
+
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+#include <stdint.h>
+
+#define PROFILER_SAMPLE_DIVISOR		4	//Default: take a sample every 4th tick. Higher = less overhead.
+#define PROFILER_HISTOGRAM_SIZE		64	//Histogram slots (power of 2, 5 bytes each)
+#define PROFILER_PC_SHIFT			1	//Word address >> shift is stored, 1 = 4 byte resolution in flash
+
+/*---------------------------------------------------------------------------------*/
+// Statistical PC profiler. vApplicationTickHook takes the return address that the
+// tick ISR (portSAVE_CONTEXT) left on the stack of the interrupted task and counts
+// it together with the task number in a small histogram.
+/*---------------------------------------------------------------------------------*/
+void vProfilerStart(uint8_t divisor);
+void vProfilerStop(void);
+
+/*---------------------------------------------------------------------------------*/
+// Prints the histogram over the UART and clears it. Format (text):
+//   PROF1 <divisor> <pc shift> <samples> <dropped>
+//   T <task number> <task name>        (one line per task)
+//   S <task number> <pc byte address hex> <count>
+//   END
+// Use tools/profile2folded.py to resolve the addresses against the ELF.
+/*---------------------------------------------------------------------------------*/
+void vProfilerDump(void);
+
+#endif /* PROFILER_H_ */
@@ -0,0 +1,47 @@
+/*
+ * screenModel.h
+ *
+ * Created: 19.10.2026 03:14:51
+ *  Author: agent
+ */ 
+
+
+#ifndef SCREENMODEL_H_
+#define SCREENMODEL_H_
+
+#include <stdint.h>
+
+/*---------------------------------------------------------------------------------*/
+// Retained-mode screen: the UI binds fields (labels, values, button legends) to
+// regions of the display once and sets their content every cycle. A field is only
+// queued to the display driver if its text changed, padded to its width so no
+// clear is needed.
+/*---------------------------------------------------------------------------------*/
+#define SCREEN_FIELD_MAX_WIDTH 20
+
+typedef struct{
+	uint8_t line;
+	uint8_t pos;
+	uint8_t width;
+	uint8_t dirty;
+	char text[SCREEN_FIELD_MAX_WIDTH];
+}screenField_t;
+
+#define SCREEN_FIELD(line, pos, width) {(line), (pos), (width), 1, {0}}
+
+typedef struct{
+	uint32_t cycles;			//vScreenFlush calls
+	uint32_t fieldsSent;		//Queue entries sent since start
+	uint32_t fieldsSkipped;		//Unchanged fields not sent since start
+	uint8_t lastFieldsSent;		//Queue entries sent in the last cycle
+	uint32_t lastFlushUS;		//Time to format and queue the last cycle
+	uint32_t maxFlushUS;
+}screenStats_t;
+
+void vScreenInit(screenField_t *fields, uint8_t count);
+void vScreenSetField(uint8_t field, char const *fmt, ...);
+void vScreenInvalidate(void);
+void vScreenFlush(void);
+void vScreenGetStats(screenStats_t *stats);
+
+#endif /* SCREENMODEL_H_ */
@@ -0,0 +1,93 @@
+/*
+ * stackConfig.h
+ *
+ * Created: 19.10.2026 03:06:29
+ *  Author: agent
+ */ 
+
+
+#ifndef STACKCONFIG_H_
+#define STACKCONFIG_H_
+
+/*---------------------------------------------------------------------------------*/
+// Stack depth of every application task (bytes, StackType_t is 8 bit): the peak
+// of the task plus STACK_SIZE_MARGIN. A peak is the deepest call chain of the
+// task plus STACK_ISR_RESERVE for the interrupt that hits it there.
+// The peaks are worst-case estimates from the call chains (3 byte return
+// address, saved registers and locals per level). Replace them with the peak
+// column of vStackReport() (long press on button 3) after a run that went
+// through every screen and report. checkAllStacks() raises ERR_LOW_STACK_SPACE
+// if a task gets within STACK_LOW_MARGIN of its size, i.e. if its real peak
+// is more than STACK_SIZE_MARGIN - STACK_LOW_MARGIN above the estimate.
+/*---------------------------------------------------------------------------------*/
+#define STACK_ISR_RESERVE		85	//All ISRs are low level and do not nest. Largest: tick, 40 bytes context + xTaskIncrementTick/vTaskSwitchContext
+#define STACK_SIZE_MARGIN		64
+
+#define STACK_PEAK_CONTROLLER	140	//prvLongPress -> prvDisplayReport (displayStats_t) -> vUartPrintNumber
+#define STACK_PEAK_ENGINE		110	//step -> term -> libgcc float division, prvDigitsReached -> 64 bit bench clock math
+#define STACK_PEAK_UI			220	//screen flush -> vDisplayWriteStringAtPos -> display_format -> display_ftoa
+#define STACK_PEAK_DISPLAY		270	//vDisplayUpdateTask (2 x 80 byte line copies) -> _displaySend -> TX ring flush
+#define STACK_PEAK_COROUTINES	120	//vCoRoutineSchedule -> co-routine -> engine step
+#define STACK_PEAK_BENCH		130	//vPiBenchRun -> term -> libgcc float division, vPiBenchReport -> 64 bit number print
+
+#define STACK_SIZE(peak)		( (peak) + STACK_ISR_RESERVE + STACK_SIZE_MARGIN )
+#define STACK_SIZE_CONTROLLER	STACK_SIZE( STACK_PEAK_CONTROLLER )
+#define STACK_SIZE_LEIBNIZ		STACK_SIZE( STACK_PEAK_ENGINE )
+#define STACK_SIZE_NILAKANTHA	STACK_SIZE( STACK_PEAK_ENGINE )
+#define STACK_SIZE_UI			STACK_SIZE( STACK_PEAK_UI )
+#define STACK_SIZE_DISPLAY		STACK_SIZE( STACK_PEAK_DISPLAY )
+#define STACK_SIZE_COROUTINES	STACK_SIZE( STACK_PEAK_COROUTINES )
+#define STACK_SIZE_BENCH		STACK_SIZE( STACK_PEAK_BENCH )
+
+/*---------------------------------------------------------------------------------*/
+// Engine execution mode.
+// 0: every pi engine is its own task with its own stack (leibniz_tsk, nilakantha_tsk)
+// 1: all engines are co-routines inside coroutine_tsk and share STACK_SIZE_COROUTINES.
+//    They yield after CALC_BATCH_TERMS terms (main.c). The control blocks come
+//    from the FreeRTOS heap, xCoRoutineCreate has no static variant.
+// Can be set on the command line, tools/hosttests.py builds both modes.
+/*---------------------------------------------------------------------------------*/
+#ifndef CALC_USE_COROUTINES
+#define CALC_USE_COROUTINES		0
+#endif
+
+#if CALC_USE_COROUTINES == 1
+	#define RTOS_ENGINE_TASKS	1
+	#define RTOS_ENGINE_STACKS	STACK_SIZE_COROUTINES
+	#define RTOS_ENGINE_RAM		( STACK_SIZE_COROUTINES + sizeof(StaticTask_t) + 2 * sizeof(CRCB_t) )	//needs croutine.h
+#else
+	#define RTOS_ENGINE_TASKS	2
+	#define RTOS_ENGINE_STACKS	( STACK_SIZE_LEIBNIZ + STACK_SIZE_NILAKANTHA )
+	#define RTOS_ENGINE_RAM		( RTOS_ENGINE_STACKS + 2 * sizeof(StaticTask_t) )
+#endif
+
+/*---------------------------------------------------------------------------------*/
+// All tasks, queues and event groups are allocated statically. RTOS_STATIC_RAM is
+// the RAM they take (needs FreeRTOS.h, timers.h, NHD0420Driver.h, ButtonHandler.h and uartDriver.h), main.c checks at
+// compile time that it fits into RTOS_RAM_BUDGET. The budget is the size of the
+// old configTOTAL_HEAP_SIZE pool, so RTOS_RAM_BUDGET - RTOS_STATIC_RAM is what the
+// static allocation saved.
+/*---------------------------------------------------------------------------------*/
+#ifndef RTOS_RAM_BUDGET
+#define RTOS_RAM_BUDGET			4000
+#endif
+#define RTOS_TASK_COUNT			( 6 + RTOS_ENGINE_TASKS )	//controller, ui, display, bench, engines, IDLE, timer daemon. main.c checks it, the task tables of the diagnostics are this size
+#define RTOS_EVENT_GROUP_COUNT	3
+// The timer queue of timers.c is static too. Its DaemonTaskMessage_t is private: a
+// BaseType_t command and a union, the larger member is the pended function call.
+#define RTOS_TIMER_MESSAGE_SIZE	( sizeof(BaseType_t) + sizeof(PendedFunction_t) + sizeof(void *) + sizeof(uint32_t) )	//needs timers.h
+#define RTOS_TIMER_QUEUE_RAM	( sizeof(StaticQueue_t) + configTIMER_QUEUE_LENGTH * RTOS_TIMER_MESSAGE_SIZE )
+#define RTOS_STATIC_RAM			( STACK_SIZE_CONTROLLER + RTOS_ENGINE_STACKS + STACK_SIZE_UI + STACK_SIZE_DISPLAY + STACK_SIZE_BENCH					\
+								+ configMINIMAL_STACK_SIZE + configTIMER_TASK_STACK_DEPTH											\
+								+ RTOS_TASK_COUNT * sizeof(StaticTask_t)															\
+								+ RTOS_EVENT_GROUP_COUNT * sizeof(StaticEventGroup_t)												\
+								+ RTOS_TIMER_QUEUE_RAM																				\
+								+ DISPLAY_PATH_RAM																					\
+								+ BUTTON_RTOS_RAM																					\
+								+ UART_RTOS_RAM																						\
+								+ configTOTAL_HEAP_SIZE )
+
+#define STACK_LOW_MARGIN		32	//checkAllStacks() raises ERR_LOW_STACK_SPACE when less than this is left unused
+#define STACK_MONITOR_MAX_TASKS	RTOS_TASK_COUNT	//Tasks incl. IDLE and the timer daemon
+
+#endif /* STACKCONFIG_H_ */
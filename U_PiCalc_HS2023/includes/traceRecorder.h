@@ -0,0 +1,77 @@
+/*
+ * traceRecorder.h
+ *
+ * Created: 19.10.2026 03:04:40
+ *  Author: agent
+ */ 
+
+
+#ifndef TRACERECORDER_H_
+#define TRACERECORDER_H_
+
+#include <stdint.h>
+
+// This header is included at the end of FreeRTOSConfig.h so the kernel trace
+// macros below replace the empty defaults in FreeRTOS.h. It must not include
+// any FreeRTOS header itself.
+
+#define TRACE_BUFFER_SIZE		64	//Number of records kept in the ring buffer (6 bytes each). Oldest records are overwritten.
+
+// Record types
+#define TRACE_EVT_TASK_SWITCH	1	//arg = task number (uxTCBNumber)
+#define TRACE_EVT_QUEUE_SEND	2	//arg = queue number
+#define TRACE_EVT_EG_SET_BITS	3	//arg = event group number
+#define TRACE_EVT_ISR_ENTER		4	//arg = TRACE_ISR_xxx
+#define TRACE_EVT_ISR_EXIT		5	//arg = TRACE_ISR_xxx
+
+// Object numbers, assigned with vQueueSetQueueNumber / vEventGroupSetNumber.
+// 0 means "not numbered" (e.g. the timer daemon queue).
+#define TRACE_QUEUE_DISPLAY		1
+#define TRACE_EG_DISPLAY		1
+#define TRACE_EG_BUTTONS		2
+#define TRACE_EG_CALC			3
+
+// ISR ids
+#define TRACE_ISR_DISPLAY_TIMER	1
+
+typedef struct {
+	uint8_t event;
+	uint8_t arg;
+	uint16_t tick;		//Low 16 bits of the RTOS tick count (1ms)
+	uint16_t subTick;	//TCC0.CNT at the time of the record, counts at the CPU clock / CLOCK_TICK_PRESCALER (init.h)
+} traceRecord_t;
+
+#if configUSE_TRACE_RECORDER == 1
+
+extern volatile uint16_t uxTraceTick;
+
+void vTraceRecord(uint8_t event, uint8_t arg);
+
+/*---------------------------------------------------------------------------------*/
+// Sends the buffer over the UART as a binary block:
+//   "TRC1", u8 record size, u32 subTick rate in Hz, u16 record count, u32 total records,
+//   u8 task count, task count * (u8 task number, char name[configMAX_TASK_NAME_LEN]),
+//   record count * traceRecord_t (oldest first). All values little endian.
+// The subTick rate is the one of the clock profile at the time of the dump, records
+// from before a profile switch are converted with it too.
+// Recording is paused during the dump, the buffer is empty afterwards.
+// Use tools/trace2json.py to convert the dump into Chrome/Perfetto JSON.
+/*---------------------------------------------------------------------------------*/
+void vTraceDump(void);
+
+#define traceTASK_INCREMENT_TICK( xTickCount )		uxTraceTick = (uint16_t) ( ( xTickCount ) + 1 )
+#define traceTASK_SWITCHED_IN()						vTraceRecord(TRACE_EVT_TASK_SWITCH, (uint8_t) pxCurrentTCB->uxTCBNumber)
+#define traceQUEUE_SEND( pxQueue )					vTraceRecord(TRACE_EVT_QUEUE_SEND, (uint8_t) ( pxQueue )->uxQueueNumber)
+#define traceEVENT_GROUP_SET_BITS( xEventGroup, uxBitsToSet )	vTraceRecord(TRACE_EVT_EG_SET_BITS, (uint8_t) uxEventGroupGetNumber( xEventGroup ))
+#define traceISR_ENTER( id )						vTraceRecord(TRACE_EVT_ISR_ENTER, ( id ))
+#define traceISR_EXIT( id )							vTraceRecord(TRACE_EVT_ISR_EXIT, ( id ))
+
+#else
+
+#define vTraceDump()
+#define traceISR_ENTER( id )
+#define traceISR_EXIT( id )
+
+#endif
+
+#endif /* TRACERECORDER_H_ */
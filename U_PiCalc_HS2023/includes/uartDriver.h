@@ -0,0 +1,35 @@
+/*
+ * uartDriver.h
+ *
+ * Created: 19.10.2026 03:04:40
+ *  Author: agent
+ */ 
+
+
+#ifndef UARTDRIVER_H_
+#define UARTDRIVER_H_
+
+#include <stdint.h>
+
+/*---------------------------------------------------------------------------------*/
+// Polled USARTC0 (TX = PC3, RX = PC2), 115200 Baud 8N1 at the clock of the profile (init.h).
+// Used by the diagnostic dumps (trace, profiler, stacks, ...) and the reports of
+// the controller and the UI task. Several tasks print, so every line or binary dump
+// is written between vUartLock() and vUartUnlock(): a mutex with priority
+// inheritance, the other tasks wait for the whole line instead of interleaving.
+// Sending busy-waits on DREIF (87us per byte at 115200 Baud), the caller spends
+// the time of its own line at its priority. Without a running scheduler the lock
+// does nothing, error() prints without it.
+/*---------------------------------------------------------------------------------*/
+#define UART_RTOS_RAM		( sizeof(StaticSemaphore_t) )	//needs FreeRTOS.h
+
+void vInitUart(void);
+void vUartClockChanged(void);		//Recalculates the baud rate after a clock profile switch
+void vUartLock(void);				//Blocks until no other task prints
+void vUartUnlock(void);
+void vUartPutChar(char c);
+void vUartWrite(const void *data, uint16_t len);
+void vUartPrint(const char *s);
+void vUartPrintNumber(uint32_t value);
+
+#endif /* UARTDRIVER_H_ */
@@ -5,24 +5,135 @@
  *  Author: chaos
  */ 
 
+#include "avr_compiler.h"
+#include "FreeRTOS.h"
+#include "task.h"
 #include "init.h"
 #include "clksys_driver.h"
+#include "TC_driver.h"
+#include "uartDriver.h"
 
+static const char * const clockProfileNames[CLOCK_PROFILE_COUNT] = {
+	"xosc-pll",
+	"rc32m-dfll",
+	"xosc-pll48",
+};
 
-void vInitClock(void)
+static const uint8_t clockProfileMHz[CLOCK_PROFILE_COUNT] = {
+	32,
+	32,
+	48,
+};
+
+static uint8_t clockProfile = CLOCK_PROFILE_XOSC_PLL;
+static uint8_t clockCpuMHz = 32;
+
+
+// Runs from the 2MHz RC oscillator, everything else is stopped and can be reconfigured
+static void prvClockToRC2M(void)
 {
 	CLKSYS_Enable( OSC_RC2MEN_bm );
-	do {} while ( CLKSYS_IsReady( OSC_RC2MRDY_bm ) == 0 );
+	do { nop(); } while ( CLKSYS_IsReady( OSC_RC2MRDY_bm ) == 0 );
 	CLKSYS_Main_ClockSource_Select( CLK_SCLKSEL_RC2M_gc );
+	CLKSYS_AutoCalibration_Disable( DFLLRC32M );
 	CLKSYS_Disable( OSC_RC32MEN_bm | OSC_RC32KEN_bm | OSC_XOSCEN_bm | OSC_PLLEN_bm);
 	CLKSYS_Prescalers_Config( CLK_PSADIV_1_gc, CLK_PSBCDIV_1_1_gc );
+}
+
+// 8MHz crystal times factor. The prescalers stay at 1:1 for the x6 PLL too: clkCPU
+// and clkPER both come out of prescaler C, a division that brings clkPER back to
+// 32MHz slows the CPU by the same factor (PSBCDIV 1:2 gives 24MHz). clkPER2 and
+// clkPER4 are not used (no EBI, no hi-res extension). So at 48MHz the CPU and the
+// peripherals are overclocked together and the timers and the UART follow
+// clockCpuMHz: TCC0 PER 749, USARTC0 BSEL 3205 of 4095, TCF0 delays up to 87ms at
+// DIV64 and TX engine waits up to 5.4ms at DIV1024 (test_clockProfile.c).
+static void prvClockXoscPll(uint8_t factor)
+{
 	CLKSYS_XOSC_Config( OSC_FRQRANGE_2TO9_gc,false,OSC_XOSCSEL_XTAL_256CLK_gc );
 	CLKSYS_Enable( OSC_XOSCEN_bm );
-	do {} while ( CLKSYS_IsReady( OSC_XOSCRDY_bm ) == 0 );
-	CLKSYS_PLL_Config( OSC_PLLSRC_XOSC_gc, 4 );
+	do { nop(); } while ( CLKSYS_IsReady( OSC_XOSCRDY_bm ) == 0 );
+	CLKSYS_PLL_Config( OSC_PLLSRC_XOSC_gc, factor );
 	CLKSYS_Enable( OSC_PLLEN_bm );
 	CLKSYS_Prescalers_Config( CLK_PSADIV_1_gc, CLK_PSBCDIV_1_1_gc );
-	do {} while ( CLKSYS_IsReady( OSC_PLLRDY_bm ) == 0 );
+	do { nop(); } while ( CLKSYS_IsReady( OSC_PLLRDY_bm ) == 0 );
 	CLKSYS_Main_ClockSource_Select( CLK_SCLKSEL_PLL_gc );
-	CLKSYS_Disable( OSC_RC32MEN_bm | OSC_RC2MEN_bm | OSC_RC32KEN_bm);
-}
\ No newline at end of file
+	CLKSYS_Disable( OSC_RC2MEN_bm );
+}
+
+// 32MHz RC oscillator, the DFLL keeps it calibrated against the 32kHz RC oscillator
+static void prvClockRC32M(void)
+{
+	CLKSYS_Enable( OSC_RC32MEN_bm | OSC_RC32KEN_bm );
+	do { nop(); } while ( CLKSYS_IsReady( OSC_RC32MRDY_bm | OSC_RC32KRDY_bm ) != ( OSC_RC32MRDY_bm | OSC_RC32KRDY_bm ) );
+	CLKSYS_AutoCalibration_Enable( OSC_RC32MCREF_gm, false );
+	CLKSYS_Main_ClockSource_Select( CLK_SCLKSEL_RC32M_gc );
+	CLKSYS_Disable( OSC_RC2MEN_bm );
+}
+
+void vInitClock(void)
+{
+	vClockSetProfile( CLOCK_PROFILE_DEFAULT );
+}
+
+void vClockSetProfile(uint8_t profile)
+{
+	if(profile >= CLOCK_PROFILE_COUNT)
+	{
+		return;
+	}
+	taskENTER_CRITICAL();
+	prvClockToRC2M();
+	switch(profile)
+	{
+		case CLOCK_PROFILE_XOSC_PLL:
+			prvClockXoscPll( 4 );
+			break;
+		case CLOCK_PROFILE_RC32M_DFLL:
+			prvClockRC32M();
+			break;
+		case CLOCK_PROFILE_XOSC_PLL48:
+			prvClockXoscPll( 6 );
+			break;
+	}
+	clockProfile = profile;
+	clockCpuMHz = clockProfileMHz[profile];
+
+	// Tick period, port.c derives the same from configCPU_CLOCK_HZ when the scheduler starts
+	TC_SetPeriod( &TCC0, ulClockCpuHz() / CLOCK_TICK_PRESCALER / configTICK_RATE_HZ - 1 );
+	if(TCC0.CNT > TCC0.PER)
+	{
+		TCC0.CNT = 0;
+	}
+	vUartClockChanged();
+	taskEXIT_CRITICAL();
+}
+
+uint8_t ucClockGetProfile(void)
+{
+	return clockProfile;
+}
+
+const char *pcClockProfileName(uint8_t profile)
+{
+	return profile < CLOCK_PROFILE_COUNT ? clockProfileNames[profile] : "-";
+}
+
+uint32_t ulClockCpuHz(void)
+{
+	return clockCpuMHz * 1000000UL;
+}
+
+uint32_t ulClockProfileHz(uint8_t profile)
+{
+	return profile < CLOCK_PROFILE_COUNT ? clockProfileMHz[profile] * 1000000UL : 0;
+}
+
+uint32_t ulClockCountsToUS(uint32_t counts, uint16_t prescaler)
+{
+	return (counts / clockCpuMHz) * prescaler + ((counts % clockCpuMHz) * prescaler) / clockCpuMHz;
+}
+
+uint32_t ulClockUSToCounts(uint32_t us, uint16_t prescaler)
+{
+	return (us * clockCpuMHz + prescaler - 1) / prescaler;
+}
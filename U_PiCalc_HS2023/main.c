@@ -6,8 +6,8 @@
  */ 
 
 #include <math.h>
-#include <stdio.h>
 #include <string.h>
+#include <stdarg.h>
 #include <stdbool.h>
 #include "avr_compiler.h"
 #include "pmic_driver.h"
@@ -19,7 +19,9 @@
 #include "FreeRTOS.h"
 #include "task.h"
 #include "queue.h"
+#include "timers.h"
 #include "event_groups.h"
+#include "croutine.h"
 #include "stack_macros.h"
 
 #include "mem_check.h"
@@ -28,14 +30,51 @@
 #include "utils.h"
 #include "errorHandler.h"
 #include "NHD0420Driver.h"
+#include "NHD0420Hal.h"
 #include "avr_f64.h"
 
 #include "ButtonHandler.h"
+#include "traceRecorder.h"
+#include "profiler.h"
+#include "stackConfig.h"
+#include "uartDriver.h"
+#include "screenModel.h"
+#include "digitStore.h"
+#include "benchClock.h"
+#include "piBench.h"
 
 
 // Task handles and states
+TaskHandle_t vController_tsk;		// Handle for controller task
 TaskHandle_t vLeibniz_tsk;			// Handle for Leibniz calculation task
 TaskHandle_t vNil_tsk;				// Handle for Nilakantha calculation task
+TaskHandle_t vUi_tsk;				// Handle for UI task
+TaskHandle_t vCoRoutine_tsk;		// Handle for the task that runs all engines as co-routines (CALC_USE_COROUTINES)
+TaskHandle_t vBench_tsk;			// Handle for the engine benchmark task
+
+// Statically allocated task control blocks and stacks
+static StaticTask_t controllerTcb;
+static StaticTask_t uiTcb;
+static StaticTask_t idleTcb;
+static StaticTask_t timerTcb;
+static StaticTask_t benchTcb;
+static StackType_t controllerStack[STACK_SIZE_CONTROLLER];
+static StackType_t uiStack[STACK_SIZE_UI];
+static StackType_t benchStack[STACK_SIZE_BENCH];
+static StackType_t idleStack[configMINIMAL_STACK_SIZE];
+static StackType_t timerStack[configTIMER_TASK_STACK_DEPTH];
+#if CALC_USE_COROUTINES == 1
+static StaticTask_t coRoutineTcb;
+static StackType_t coRoutineStack[STACK_SIZE_COROUTINES];
+#else
+static StaticTask_t leibnizTcb;
+static StaticTask_t nilakanthaTcb;
+static StackType_t leibnizStack[STACK_SIZE_LEIBNIZ];
+static StackType_t nilakanthaStack[STACK_SIZE_NILAKANTHA];
+#endif
+
+_Static_assert(RTOS_STATIC_RAM <= RTOS_RAM_BUDGET, "Static RTOS objects exceed RTOS_RAM_BUDGET (stackConfig.h)");
+
 eTaskState taskStateLeibniz;		// State of the Leibniz calculation task
 eTaskState taskStateNilakantha;     // State of the Nilakantha calculation task
 
@@ -43,62 +82,227 @@ eTaskState taskStateNilakantha;     // State of the Nilakantha calculation task
 void vControllerTask(void* pvParameters);
 void vCalculationTaskLeibniz(void* pvParameters);
 void vCalculationTaskNilakantha(void* pvParameters);
+void vCalculationTaskCoRoutines(void* pvParameters);
+void vCalculationCoRoutine(CoRoutineHandle_t xHandle, UBaseType_t uxIndex);
 void vUi_task(void* pvParameters);
+void vBenchTask(void* pvParameters);
 
 // Event flags for button and task events
 #define EVBUTTONS_S1            1<<0	// Event flag for switching to the right between Pi calculation algorithm
 #define EVBUTTONS_S2            1<<1	// Event flag for starting Pi calculation
 #define EVBUTTONS_S3            1<<2	// Event flag for resetting the selected algorithm
 #define EVBUTTONS_S4            1<<3	// Event flag for switching to the left Pi calculation algorithm
+#define EVBUTTONS_DIGITS        1<<4	// Event flag for the digit viewer, S3 + S4 together
+#define EVBUTTONS_BENCH         1<<5	// Event flag for the engine benchmark, S1 + S4 together
+#define EVBUTTONS_CLOCK         1<<6	// Event flag for the next clock profile, S2 + S3 together
 #define EVBUTTONS_CLEAR         0xFF	// Used to clear button-related event flags
 EventGroupHandle_t evButtonEvents;		// Event group for button events
+static StaticEventGroup_t evButtonEventsBuffer;
 
 #define EVCALC_WAIT              1<<0	// Event flag for task waiting
 #define EVCALC_WAITING           1<<1	// Event flag indicating that a task is waiting
 EventGroupHandle_t evCalcTaskEvents;	// Event group for task events
+static StaticEventGroup_t evCalcTaskEventsBuffer;
 uint32_t calcStateBits;					// Bits to track task state
 
-TickType_t startTime, endTime;
+static uint32_t digitPageUS = 0;		// Time to render the last page of the digit viewer
+static uint32_t controllerWakeups = 0;	// Loops of the controller task
+static uint32_t buttonEventCycles = 0;	// Bench clock (low 32 bit) at the first edge of the last press, controller task
+static uint32_t buttonLatestMS = 0;		// Edge-to-UI latency of the last press
+static uint32_t buttonLatencyMaxMS = 0;
+
+// Engines
+#define ENGINE_LEIBNIZ			0
+#define ENGINE_NILAKANTHA		1
+#define ENGINE_COUNT			2
+#define CALC_BATCH_TERMS		32		// Terms per co-routine activation before it yields
+
+// State of one engine, only its own task or co-routine writes it while it runs
+typedef struct {
+    float32_t piApprox;					// Approximation of Pi as float
+    uint32_t iterations;				// Number of the next term
+    int8_t sign;						// Sign of the next term
+    int timeMs;							// Time to 5 decimals in milliseconds, 0 until reached
+    uint64_t startCycles;				// Bench clock at the start of the calculation
+    uint64_t digitsCycles;				// Bench clock counts until pi reached 3.14159
+    uint32_t terms;						// Terms since power-on, for the iterations/ms report
+} engineState_t;
+
+static engineState_t engineState[ENGINE_COUNT];
 
-int time_ms = 0;						// Time in milliseconds
-float32_t pi_approx = 0.0;				// Approximation of Pi as float
+// Engine counters for the reports of the controller task. The engines write engineState
+// without a lock, the UI task copies the counters while they wait in the EVCALC handshake.
+// The values are multi-byte, both sides copy them in a critical section.
+typedef struct {
+    uint32_t terms;						// Terms of all engines since power-on
+    uint64_t digitsCycles[ENGINE_COUNT];
+    TickType_t runTicks;				// Ticks with an engine running
+    uint32_t coRoutineSwitches;
+} engineCounters_t;
 
-// Leibniz+Nilakantha variables
-uint32_t iterations = 0;
-float32_t term = 0.0;
-int sign = 1;
+static engineCounters_t engineCounters;
 
+static void prvEngineReset(uint8_t engine);
+static uint8_t prvShownEngine(void);
+static void prvLeibnizStep(engineState_t *state);
+static void prvNilakanthaStep(engineState_t *state);
+static eTaskState prvEngineGetState(uint8_t engine);
+static void prvEngineResume(uint8_t engine);
+static void prvEngineSuspend(uint8_t engine);
+static void prvEnginesStop(void);
+static void prvEngineCountersTake(void);
+static void prvEngineReport(void);
+static void prvBenchReport(void);
+static void prvBenchStart(void);
+static void prvClockNextProfile(void);
+static void prvClockReport(void);
+static void prvDisplayReport(void);
+static void prvScreenReport(void);
+static void prvDigitReport(void);
+static void prvButtonReport(void);
+#if DISPLAY_FORMAT_BENCHMARK == 1
+static void prvFormatReport(void);
+#endif
+
+#if CALC_USE_COROUTINES == 1
+static volatile uint8_t engineRunning[ENGINE_COUNT];
+static uint32_t coRoutineSwitches = 0;	// Co-routine activations, to measure the scheduling overhead
+#endif
+static TickType_t engineRunTicks = 0;	// Ticks with an engine running, for the iterations/ms report, UI task only
+static TickType_t engineRunStart = 0;
+static uint32_t clockTermsPerSecond[CLOCK_PROFILE_COUNT][PI_ENGINE_COUNT];	// Engine throughput measured per clock profile
 
 // Main function
 int main(void) {
     // Initialize clock and display
     vInitClock();
+    // Print the reset reason and the record of the last error() reset
+    vCrashRecordBoot();
     vInitDisplay();
+    vBenchClockInit();
+    prvEngineReset(ENGINE_LEIBNIZ);
+    prvEngineReset(ENGINE_NILAKANTHA);
     
     // Initialize EventGroups for task synchronization
-    evButtonEvents = xEventGroupCreate();
-    evCalcTaskEvents = xEventGroupCreate();
+    evButtonEvents = xEventGroupCreateStatic(&evButtonEventsBuffer);
+    evCalcTaskEvents = xEventGroupCreateStatic(&evCalcTaskEventsBuffer);
+    vEventGroupSetNumber(evButtonEvents, TRACE_EG_BUTTONS);
+    vEventGroupSetNumber(evCalcTaskEvents, TRACE_EG_CALC);
     
     // Create tasks
-    xTaskCreate(vControllerTask, (const char*) "control_tsk", configMINIMAL_STACK_SIZE + 150, NULL, 3, NULL);
-    xTaskCreate(vCalculationTaskLeibniz, (const char*) "leibniz_tsk", configMINIMAL_STACK_SIZE + 300, NULL, 1, &vLeibniz_tsk);
-    xTaskCreate(vCalculationTaskNilakantha, (const char*) "nilakantha_tsk", configMINIMAL_STACK_SIZE + 300, NULL, 1, &vNil_tsk);
-    xTaskCreate(vUi_task, (const char*) "ui_tsk", configMINIMAL_STACK_SIZE + 150, NULL, 2, NULL);
+    vController_tsk = xTaskCreateStatic(vControllerTask, (const char*) "control_tsk", STACK_SIZE_CONTROLLER, NULL, 3, controllerStack, &controllerTcb);
+    vUi_tsk = xTaskCreateStatic(vUi_task, (const char*) "ui_tsk", STACK_SIZE_UI, NULL, 2, uiStack, &uiTcb);
+    // Lowest priority: the benchmark takes seconds and must not hold up the buttons and the display
+    vBench_tsk = xTaskCreateStatic(vBenchTask, (const char*) "bench_tsk", STACK_SIZE_BENCH, NULL, 1, benchStack, &benchTcb);
+    vStackMonitorAdd(vController_tsk, STACK_SIZE_CONTROLLER);
+    vStackMonitorAdd(vUi_tsk, STACK_SIZE_UI);
+    vStackMonitorAdd(vBench_tsk, STACK_SIZE_BENCH);
+
+#if CALC_USE_COROUTINES == 1
+    // All engines share one task and one stack, the co-routine index is the engine number
+    vCoRoutine_tsk = xTaskCreateStatic(vCalculationTaskCoRoutines, (const char*) "coroutine_tsk", STACK_SIZE_COROUTINES, NULL, 1, coRoutineStack, &coRoutineTcb);
+    vStackMonitorAdd(vCoRoutine_tsk, STACK_SIZE_COROUTINES);
+    // The control blocks come from the heap, vCoRoutineSchedule() crashes without them
+    if (xCoRoutineCreate(vCalculationCoRoutine, 0, ENGINE_LEIBNIZ) != pdPASS
+        || xCoRoutineCreate(vCalculationCoRoutine, 0, ENGINE_NILAKANTHA) != pdPASS) {
+        error(ERR_LOW_HEAP_SPACE);
+    }
+
+    // Suspend the co-routine task until an engine is started
+    vTaskSuspend(vCoRoutine_tsk);
+#else
+    vLeibniz_tsk = xTaskCreateStatic(vCalculationTaskLeibniz, (const char*) "leibniz_tsk", STACK_SIZE_LEIBNIZ, NULL, 1, leibnizStack, &leibnizTcb);
+    vNil_tsk = xTaskCreateStatic(vCalculationTaskNilakantha, (const char*) "nilakantha_tsk", STACK_SIZE_NILAKANTHA, NULL, 1, nilakanthaStack, &nilakanthaTcb);
+    vStackMonitorAdd(vLeibniz_tsk, STACK_SIZE_LEIBNIZ);
+    vStackMonitorAdd(vNil_tsk, STACK_SIZE_NILAKANTHA);
     
     // Suspend calculation tasks initially
     vTaskSuspend(vNil_tsk);
     vTaskSuspend(vLeibniz_tsk);
+#endif
+
+    // RTOS_STATIC_RAM and the task tables of the diagnostics are sized for RTOS_TASK_COUNT,
+    // IDLE and the timer daemon are created by the scheduler
+    if (uxTaskGetNumberOfTasks() != RTOS_TASK_COUNT - 2) {
+        error(ERR_TASK_COUNT);
+    }
     
     // Start FreeRTOS scheduler
     vTaskStartScheduler();
     return 0;
 }
 
+// Memory for the IDLE task (configSUPPORT_STATIC_ALLOCATION)
+void vApplicationGetIdleTaskMemory(StaticTask_t** ppxIdleTaskTCBBuffer, StackType_t** ppxIdleTaskStackBuffer, uint32_t* pulIdleTaskStackSize) {
+    *ppxIdleTaskTCBBuffer = &idleTcb;
+    *ppxIdleTaskStackBuffer = idleStack;
+    *pulIdleTaskStackSize = configMINIMAL_STACK_SIZE;
+}
+
+// Memory for the timer daemon task (configSUPPORT_STATIC_ALLOCATION)
+void vApplicationGetTimerTaskMemory(StaticTask_t** ppxTimerTaskTCBBuffer, StackType_t** ppxTimerTaskStackBuffer, uint32_t* pulTimerTaskStackSize) {
+    *ppxTimerTaskTCBBuffer = &timerTcb;
+    *ppxTimerTaskStackBuffer = timerStack;
+    *pulTimerTaskStackSize = configTIMER_TASK_STACK_DEPTH;
+}
+
 
 // Finite state machine for calculation tasks
 #define RUN         0
 #define WAIT        1
 uint8_t smCalc = WAIT;
+
+// Back to the first term, the UI task calls this while the engine is suspended or waits
+static void prvEngineReset(uint8_t engine) {
+    engineState_t *state = &engineState[engine];
+    state->piApprox = 0.0;
+    state->iterations = piEngines[engine].firstIteration;
+    state->sign = 1;
+    state->timeMs = 0;
+    state->startCycles = ullBenchClockCycles();
+}
+
+// Called by the engines when pi is correct to 5 decimals
+static void prvDigitsReached(engineState_t *state) {
+    state->digitsCycles = ullBenchClockCycles() - state->startCycles;
+    state->timeMs = state->digitsCycles / (BENCH_CLOCK_HZ / 1000UL);
+}
+
+// One term of the Leibniz series
+static void prvLeibnizStep(engineState_t *state) {
+    // Calculate the next term of the series, 4 / (2i + 1), and update the approximation for pi
+    state->piApprox += fPiLeibnizTerm(state->iterations, state->sign);
+
+    // Reverse the sign for the next term
+    state->sign = -state->sign;
+
+    // Increase the number of iterations
+    state->iterations++;
+    state->terms++;
+
+    if ((state->piApprox > 3.14159 && state->piApprox < 3.1416) && state->timeMs == 0) {
+        // Store the time to 5 decimals at cycle resolution, timeMs is what the UI shows
+        prvDigitsReached(state);
+    }
+}
+
+// One term of the Nilakantha series
+static void prvNilakanthaStep(engineState_t *state) {
+    if (state->piApprox < 3.0) {
+        // Ensure the initial approximation is at least 3
+        state->piApprox = 3.0;
+    }
+    
+    // Update the approximation using the Nilakantha series
+	state->piApprox += fPiNilakanthaTerm(state->iterations, state->sign);
+	state->sign = -state->sign;
+	state->iterations++;
+    state->terms++;
+    if ((state->piApprox > 3.14159 && state->piApprox < 3.1416) && state->timeMs == 0) {
+        // Store the time to 5 decimals at cycle resolution, timeMs is what the UI shows
+        prvDigitsReached(state);
+    }
+}
  
 void vCalculationTaskLeibniz(void* pvParameters) {
     for (;;) {
@@ -112,28 +316,8 @@ void vCalculationTaskLeibniz(void* pvParameters) {
         }
 
         switch (smCalc) {
-            case RUN: {
-                // Calculate the next term of the series
-                term = (float)sign / (2 * iterations + 1);
-
-                // Multiply the term by 4 to get an approximation of pi
-                term *= 4;
-
-                // Update the approximation for pi
-                pi_approx += term;
-
-                // Reverse the sign for the next term
-                sign = -sign;
-
-                // Increase the number of iterations
-                iterations++;
-
-                if ((pi_approx > 3.14159 && pi_approx < 3.1416) && time_ms == 0) {
-                    // Calculate and store the time in milliseconds
-                    endTime = xTaskGetTickCount();
-                    time_ms = (endTime - startTime) * portTICK_PERIOD_MS;
-                }
-            }
+            case RUN:
+                prvLeibnizStep(&engineState[ENGINE_LEIBNIZ]);
             break;
             case WAIT:
                 // Indicate that this task is waiting
@@ -157,20 +341,7 @@ void vCalculationTaskNilakantha(void* pvParameters) {
 
         switch (smCalc) {
             case RUN:
-                if (pi_approx < 3.0) {
-                    // Ensure the initial approximation is at least 3
-                    pi_approx = 3.0;
-                }
-                
-                // Update the approximation using the Nilakantha series
-				pi_approx += sign * (4.0 / (2.0*iterations * (2.0*iterations + 1) * (2.0*iterations + 2)));
-				sign *= (-1);
-				iterations++;
-                if ((pi_approx > 3.14159 && pi_approx < 3.1416) && time_ms == 0) {
-                    // Calculate and store the time in milliseconds
-                    endTime = xTaskGetTickCount();
-                    time_ms = (endTime - startTime) * portTICK_PERIOD_MS;
-                }
+                prvNilakanthaStep(&engineState[ENGINE_NILAKANTHA]);
             break;
             case WAIT:
                 // Indicate that this task is waiting
@@ -180,50 +351,598 @@ void vCalculationTaskNilakantha(void* pvParameters) {
     }
 }
 
+#if CALC_USE_COROUTINES == 1
+
+// Runs all engine co-routines on the stack of this task. Same WAIT handshake
+// with the UI task as the single engine tasks.
+void vCalculationTaskCoRoutines(void* pvParameters) {
+    for (;;) {
+        calcStateBits = (xEventGroupGetBits(evCalcTaskEvents)) & 0x000000FF;
+
+        if (calcStateBits & EVCALC_WAIT) {
+            xEventGroupSetBits(evCalcTaskEvents, EVCALC_WAITING);
+        } else {
+            vCoRoutineSchedule();
+        }
+    }
+}
+
+// One co-routine per engine, uxIndex is the engine number. Locals are not
+// preserved across crDELAY, so the batch loop must not yield.
+void vCalculationCoRoutine(CoRoutineHandle_t xHandle, UBaseType_t uxIndex) {
+    crSTART(xHandle);
+    for (;;) {
+        if (engineRunning[uxIndex]) {
+            for (uint8_t i = 0; i < CALC_BATCH_TERMS; i++) {
+                if (uxIndex == ENGINE_LEIBNIZ) {
+                    prvLeibnizStep(&engineState[ENGINE_LEIBNIZ]);
+                } else {
+                    prvNilakanthaStep(&engineState[ENGINE_NILAKANTHA]);
+                }
+            }
+        }
+        coRoutineSwitches++;
+        // Yield to the other co-routines
+        crDELAY(xHandle, 0);
+    }
+    crEND();
+}
+
+static eTaskState prvEngineGetState(uint8_t engine) {
+    return engineRunning[engine] ? eReady : eSuspended;
+}
+
+static void prvEngineResume(uint8_t engine) {
+    engineRunning[engine] = 1;
+    engineRunStart = xTaskGetTickCount();
+    vTaskResume(vCoRoutine_tsk);
+}
+
+static void prvEngineSuspend(uint8_t engine) {
+    uint8_t running = 0;
+    engineRunning[engine] = 0;
+    engineRunTicks += xTaskGetTickCount() - engineRunStart;
+    for (uint8_t i = 0; i < ENGINE_COUNT; i++) {
+        running |= engineRunning[i];
+    }
+    if (!running) {
+        vTaskSuspend(vCoRoutine_tsk);
+    }
+}
+
+#else
+
+static eTaskState prvEngineGetState(uint8_t engine) {
+    return eTaskGetState(engine == ENGINE_LEIBNIZ ? vLeibniz_tsk : vNil_tsk);
+}
+
+static void prvEngineResume(uint8_t engine) {
+    engineRunStart = xTaskGetTickCount();
+    vTaskResume(engine == ENGINE_LEIBNIZ ? vLeibniz_tsk : vNil_tsk);
+}
+
+static void prvEngineSuspend(uint8_t engine) {
+    engineRunTicks += xTaskGetTickCount() - engineRunStart;
+    vTaskSuspend(engine == ENGINE_LEIBNIZ ? vLeibniz_tsk : vNil_tsk);
+}
+
+#endif
+
+// Only the UI task starts and stops the engines, a running engine is stopped while
+// it waits in the EVCALC handshake. Requests of the controller come as button events.
+static void prvEnginesStop(void) {
+    for (uint8_t e = 0; e < ENGINE_COUNT; e++) {
+        if (prvEngineGetState(e) != eSuspended) {
+            prvEngineSuspend(e);
+        }
+    }
+}
+
+// UI task, while no engine runs or all running ones wait in the handshake
+static void prvEngineCountersTake(void) {
+    taskENTER_CRITICAL();
+    engineCounters.terms = engineState[ENGINE_LEIBNIZ].terms + engineState[ENGINE_NILAKANTHA].terms;
+    for (uint8_t e = 0; e < ENGINE_COUNT; e++) {
+        engineCounters.digitsCycles[e] = engineState[e].digitsCycles;
+    }
+    engineCounters.runTicks = engineRunTicks;
+#if CALC_USE_COROUTINES == 1
+    engineCounters.coRoutineSwitches = coRoutineSwitches;
+#endif
+    taskEXIT_CRITICAL();
+}
+
+// Prints "ENGINE <mode> <engine ram> <iterations> <run ms> <co-routine switches>"
+// to compare one task per engine against the shared co-routine task.
+static void prvEngineReport(void) {
+    engineCounters_t counters;
+    taskENTER_CRITICAL();
+    counters = engineCounters;
+    taskEXIT_CRITICAL();
+    vUartLock();
+    vUartPrint("ENGINE ");
+#if CALC_USE_COROUTINES == 1
+    vUartPrint("coroutine ");
+#else
+    vUartPrint("task ");
+#endif
+    vUartPrintNumber(RTOS_ENGINE_RAM);
+    vUartPutChar(' ');
+    vUartPrintNumber(counters.terms);
+    vUartPutChar(' ');
+    vUartPrintNumber(counters.runTicks * portTICK_PERIOD_MS);
+    vUartPutChar(' ');
+#if CALC_USE_COROUTINES == 1
+    vUartPrintNumber(counters.coRoutineSwitches);
+#else
+    vUartPutChar('0');
+#endif
+    vUartPrint("\r\n");
+    vUartUnlock();
+}
+
+// Prints "DISPLAY <frames> <bytes total> <bytes last frame> <us last frame> <us max frame> <chars/ms> <busy flag>"
+static void prvDisplayReport(void) {
+    displayStats_t stats;
+    vDisplayGetStats(&stats);
+    vUartLock();
+    vUartPrint("DISPLAY ");
+    vUartPrintNumber(stats.frames);
+    vUartPutChar(' ');
+    vUartPrintNumber(stats.bytesTotal);
+    vUartPutChar(' ');
+    vUartPrintNumber(stats.lastFrameBytes);
+    vUartPutChar(' ');
+    vUartPrintNumber(stats.lastFrameUS);
+    vUartPutChar(' ');
+    vUartPrintNumber(stats.maxFrameUS);
+    vUartPutChar(' ');
+    vUartPrintNumber(stats.busUSTotal ? (uint32_t)(((uint64_t) stats.bytesTotal * 1000) / stats.busUSTotal) : 0);
+    vUartPutChar(' ');
+    vUartPrintNumber(stats.busyFlagActive);
+    vUartPrint("\r\n");
+    // "DISPLAYW <1 framebuffer / 0 queue> <writes> <us last write> <us max write> <path ram>"
+    vUartPrint("DISPLAYW ");
+    vUartPrintNumber(DISPLAY_USE_FRAMEBUFFER);
+    vUartPutChar(' ');
+    vUartPrintNumber(stats.writes);
+    vUartPutChar(' ');
+    vUartPrintNumber(stats.lastWriteUS);
+    vUartPutChar(' ');
+    vUartPrintNumber(stats.maxWriteUS);
+    vUartPutChar(' ');
+    vUartPrintNumber(stats.pathRAM);
+    vUartPrint("\r\n");
+    // "DELAY <1 notify / 0 event group> <spins> <sleeps> <us late last> <us late max> <us late average>"
+    vUartPrint("DELAY ");
+    vUartPrintNumber(DISPLAY_DELAY_NOTIFY);
+    vUartPutChar(' ');
+    vUartPrintNumber(stats.delaySpins);
+    vUartPutChar(' ');
+    vUartPrintNumber(stats.delaySleeps);
+    vUartPutChar(' ');
+    vUartPrintNumber(stats.lastDelayLateUS);
+    vUartPutChar(' ');
+    vUartPrintNumber(stats.maxDelayLateUS);
+    vUartPutChar(' ');
+    vUartPrintNumber(stats.delaySleeps ? stats.delayLateUSTotal / stats.delaySleeps : 0);
+    vUartPrint("\r\n");
+    // "QUEUE <depth> <peak entries> <overflows> <coalesced writes> <writes>", depth 0 = framebuffer
+    vUartPrint("QUEUE ");
+    vUartPrintNumber(DISPLAY_USE_FRAMEBUFFER ? 0 : DISPLAY_QUEUE_DEPTH);
+    vUartPutChar(' ');
+    vUartPrintNumber(stats.queuePeak);
+    vUartPutChar(' ');
+    vUartPrintNumber(stats.overflows);
+    vUartPutChar(' ');
+    vUartPrintNumber(stats.coalesced);
+    vUartPutChar(' ');
+    vUartPrintNumber(stats.writes);
+    vUartPrint("\r\n");
+    vUartUnlock();
+}
+
+// Prints "SCREEN <ui cycles> <fields sent> <fields skipped> <fields sent last cycle> <us last cycle> <us max cycle>"
+static void prvScreenReport(void) {
+    screenStats_t stats;
+    vScreenGetStats(&stats);
+    vUartLock();
+    vUartPrint("SCREEN ");
+    vUartPrintNumber(stats.cycles);
+    vUartPutChar(' ');
+    vUartPrintNumber(stats.fieldsSent);
+    vUartPutChar(' ');
+    vUartPrintNumber(stats.fieldsSkipped);
+    vUartPutChar(' ');
+    vUartPrintNumber(stats.lastFieldsSent);
+    vUartPutChar(' ');
+    vUartPrintNumber(stats.lastFlushUS);
+    vUartPutChar(' ');
+    vUartPrintNumber(stats.maxFlushUS);
+    vUartPrint("\r\n");
+    vUartUnlock();
+}
+
+// Prints "DIGITS <digits> <capacity> <bytes used> <digits appended> <us appending> <rejected> <us last viewer page>"
+static void prvDigitReport(void) {
+    digitStoreStats_t stats;
+    vDigitStoreGetStats(&stats);
+    vUartLock();
+    vUartPrint("DIGITS ");
+    vUartPrintNumber(stats.count);
+    vUartPutChar(' ');
+    vUartPrintNumber(stats.capacity);
+    vUartPutChar(' ');
+    vUartPrintNumber(stats.bytes);
+    vUartPutChar(' ');
+    vUartPrintNumber(stats.appends);
+    vUartPutChar(' ');
+    vUartPrintNumber(stats.appendUSTotal);
+    vUartPutChar(' ');
+    vUartPrintNumber(stats.rejected);
+    vUartPutChar(' ');
+    vUartPrintNumber(digitPageUS);
+    vUartPrint("\r\n");
+    vUartUnlock();
+}
+
+// Prints "BENCH <clock hz> <us to 3.14159> <cycles to 3.14159>" of the engine on the screen,
+// cycles saturate at 2^32-1 (134s)
+static void prvBenchReport(void) {
+    uint64_t cycles;
+    taskENTER_CRITICAL();
+    cycles = engineCounters.digitsCycles[prvShownEngine()];
+    taskEXIT_CRITICAL();
+    vUartLock();
+    vUartPrint("BENCH ");
+    vUartPrintNumber(BENCH_CLOCK_HZ);
+    vUartPutChar(' ');
+    vUartPrintNumber(cycles / (BENCH_CLOCK_HZ / 1000000UL));
+    vUartPutChar(' ');
+    vUartPrintNumber(cycles > 0xFFFFFFFFULL ? 0xFFFFFFFFUL : (uint32_t) cycles);
+    vUartPrint("\r\n");
+    vUartUnlock();
+}
+
+// Prints "BUTTON <1 interrupts / 0 polled> <controller wakeups> <uptime ms> <ms edge-to-ui last> <ms max>
+// [<edges> <debounce runs> <events> <dropped>]". Polled, the controller wakes up every 10ms
+// and the latency starts at the debounced sample, there is no edge interrupt.
+static void prvButtonReport(void) {
+    vUartLock();
+    vUartPrint("BUTTON ");
+    vUartPrintNumber(BUTTON_USE_INTERRUPTS);
+    vUartPutChar(' ');
+    vUartPrintNumber(controllerWakeups);
+    vUartPutChar(' ');
+    vUartPrintNumber(xTaskGetTickCount() * portTICK_PERIOD_MS);
+    vUartPutChar(' ');
+    vUartPrintNumber(buttonLatestMS);
+    vUartPutChar(' ');
+    vUartPrintNumber(buttonLatencyMaxMS);
+#if BUTTON_USE_INTERRUPTS == 1
+    buttonStats_t stats;
+    getButtonStats(&stats);
+    vUartPutChar(' ');
+    vUartPrintNumber(stats.edges);
+    vUartPutChar(' ');
+    vUartPrintNumber(stats.debounceRuns);
+    vUartPutChar(' ');
+    vUartPrintNumber(stats.events);
+    vUartPutChar(' ');
+    vUartPrintNumber(stats.dropped);
+#endif
+    vUartPrint("\r\n");
+    vUartUnlock();
+}
+
+#if DISPLAY_FORMAT_BENCHMARK == 1
+// Prints "FMT <runs> <us display formatter> <us sprintf>", both format the two UI lines per run
+static void prvFormatReport(void) {
+    uint32_t formatUS;
+    uint32_t sprintfUS;
+    vDisplayFormatBenchmark(100, &formatUS, &sprintfUS);
+    vUartLock();
+    vUartPrint("FMT 100 ");
+    vUartPrintNumber(formatUS);
+    vUartPutChar(' ');
+    vUartPrintNumber(sprintfUS);
+    vUartPrint("\r\n");
+    vUartUnlock();
+}
+#endif
+
+// Wakes the bench task, the UI task calls it after it stopped the engines so they
+// do not share the CPU with the benchmark. Their values are not touched.
+static void prvBenchStart(void) {
+    xTaskNotifyGive(vBench_tsk);
+}
+
+// Runs the engine benchmark once per notification. The UI and display tasks
+// preempt it, their time is part of the measured counts.
+void vBenchTask(void* pvParameters) {
+    static piBenchResult_t results[PI_ENGINE_COUNT];
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        for (uint8_t e = 0; e < PI_ENGINE_COUNT; e++) {
+            vPiBenchRun(e, &results[e]);
+        }
+        vUartLock();
+        vPiBenchReport(results, PI_ENGINE_COUNT, vUartPrint);
+        vUartUnlock();
+    }
+}
+
+// Switches to the next clock profile and measures the engine throughput in it. The UI
+// task calls it after it stopped the engines, their cycle counts would mix two clocks.
+#define CLOCK_MEASURE_TERMS     1000
+static void prvClockNextProfile(void) {
+    uint8_t profile = (ucClockGetProfile() + 1) % CLOCK_PROFILE_COUNT;
+    vClockSetProfile(profile);
+    for (uint8_t e = 0; e < PI_ENGINE_COUNT; e++) {
+        uint32_t cycles = ulPiBenchCyclesPerTerm(e, CLOCK_MEASURE_TERMS);
+        clockTermsPerSecond[profile][e] = cycles > 0 ? ulClockCpuHz() / cycles : 0;
+    }
+    prvClockReport();
+}
+
+// Prints "CLOCK <profile> <name> <hz> <active> <leibniz terms/s> <nilakantha terms/s>"
+// for every profile, 0 terms/s if it was not measured yet
+static void prvClockReport(void) {
+    vUartLock();
+    for (uint8_t p = 0; p < CLOCK_PROFILE_COUNT; p++) {
+        vUartPrint("CLOCK ");
+        vUartPrintNumber(p);
+        vUartPutChar(' ');
+        vUartPrint(pcClockProfileName(p));
+        vUartPutChar(' ');
+        vUartPrintNumber(ulClockProfileHz(p));
+        vUartPutChar(' ');
+        vUartPutChar(p == ucClockGetProfile() ? '1' : '0');
+        for (uint8_t e = 0; e < PI_ENGINE_COUNT; e++) {
+            vUartPutChar(' ');
+            vUartPrintNumber(clockTermsPerSecond[p][e]);
+        }
+        vUartPrint("\r\n");
+    }
+    vUartUnlock();
+}
+
+// Long presses send the diagnostics over the UART
+static void prvLongPress(button_t button) {
+    switch (button) {
+        case BUTTON1:
+        // Send the kernel trace over the UART
+        vTraceDump();
+        break;
+        case BUTTON2:
+        // Send the profiler histogram over the UART
+        vProfilerDump();
+        break;
+        case BUTTON3:
+        // Send the stack allocation and peak usage of every task over the UART
+        vStackReport();
+        mem_report();
+        vCrashRecordReport();
+        prvEngineReport();
+        prvBenchReport();
+        prvClockReport();
+        prvDisplayReport();
+        prvScreenReport();
+        prvDigitReport();
+        prvButtonReport();
+#if DISPLAY_FORMAT_BENCHMARK == 1
+        prvFormatReport();
+#endif
+        break;
+        case BUTTON4:
+        // Send the display bus capture over the UART (DISPLAY_BUS_CAPTURE)
+        vDisplayBusDump();
+        break;
+    }
+}
+
 // Controller task to handle button events
 void vControllerTask(void* pvParameters) {
     // Initialize and configure buttons
     initButtons();
+#if BUTTON_USE_INTERRUPTS == 1
+    buttonEvent_t event;
+    for (;;) {
+        // Sleep until the debouncer has an event, nothing runs while no button is touched
+        if (getButtonEvent(&event, portMAX_DELAY) == pdTRUE) {
+            controllerWakeups++;
+            if (event.type == BUTTON_EVENT_SHORT) {
+                taskENTER_CRITICAL();
+                buttonEventCycles = event.timestamp;
+                taskEXIT_CRITICAL();
+                xEventGroupSetBits(evButtonEvents, 1 << event.button);
+            } else if (event.type == BUTTON_EVENT_LONG) {
+                prvLongPress((button_t) event.button);
+            } else if (event.type == BUTTON_EVENT_CHORD && event.button == ((1 << BUTTON1) | (1 << BUTTON4))) {
+                // S1 + S4 together run the engine benchmark, the UI task stops the engines first
+                xEventGroupSetBits(evButtonEvents, EVBUTTONS_BENCH);
+            } else if (event.type == BUTTON_EVENT_CHORD && event.button == ((1 << BUTTON2) | (1 << BUTTON3))) {
+                // S2 + S3 together switch the clock profile, the UI task stops the engines first
+                xEventGroupSetBits(evButtonEvents, EVBUTTONS_CLOCK);
+            } else if (event.type == BUTTON_EVENT_CHORD && event.button == ((1 << BUTTON3) | (1 << BUTTON4))) {
+                // S3 + S4 together open and close the digit viewer
+                taskENTER_CRITICAL();
+                buttonEventCycles = event.timestamp;
+                taskEXIT_CRITICAL();
+                xEventGroupSetBits(evButtonEvents, EVBUTTONS_DIGITS);
+            }
+        }
+    }
+#else
     for (;;) {
         // Check and handle button presses
         updateButtons();
-        if (getButtonPress(BUTTON1) == SHORT_PRESSED) {
-            xEventGroupSetBits(evButtonEvents, EVBUTTONS_S1);
-        }
-        if (getButtonPress(BUTTON2) == SHORT_PRESSED) {
-            xEventGroupSetBits(evButtonEvents, EVBUTTONS_S2);
-        }
-        if (getButtonPress(BUTTON3) == SHORT_PRESSED) {
-            xEventGroupSetBits(evButtonEvents, EVBUTTONS_S3);
-        }
-        if (getButtonPress(BUTTON4) == SHORT_PRESSED) {
-            xEventGroupSetBits(evButtonEvents, EVBUTTONS_S4);
+        controllerWakeups++;
+        for (uint8_t b = BUTTON1; b <= BUTTON4; b++) {
+            if (getButtonPress((button_t) b) == SHORT_PRESSED) {
+                uint32_t sampleCycles = (uint32_t) ullBenchClockCycles();
+                taskENTER_CRITICAL();
+                buttonEventCycles = sampleCycles;
+                taskEXIT_CRITICAL();
+                xEventGroupSetBits(evButtonEvents, 1 << b);
+            }
+            if (getButtonPress((button_t) b) == LONG_PRESSED) {
+                prvLongPress((button_t) b);
+            }
         }
         // Delay the task for 10 milliseconds
         vTaskDelay(10 / portTICK_RATE_MS);
     }
+#endif
 }
 
 // UI Modes for the finite state machine
 #define UIMODE_INIT				 0
 #define UIMODE_NILAKANTHA_CALC   1
 #define UIMODE_LEIBNIZ_CALC      2
+#define UIMODE_DIGITS            3
 
 uint8_t uiMode = UIMODE_INIT;
+static uint8_t viewerReturnMode = UIMODE_LEIBNIZ_CALC;	// Calculation screen the digit viewer was opened from
+
+// Engine of the calculation screen, the digit viewer shows the digits of the one it was opened from
+static uint8_t prvShownEngine(void) {
+    uint8_t mode = uiMode == UIMODE_DIGITS ? viewerReturnMode : uiMode;
+    return mode == UIMODE_NILAKANTHA_CALC ? ENGINE_NILAKANTHA : ENGINE_LEIBNIZ;
+}
+
+
+// Screen fields of the UI, only the ones that changed are sent to the display
+#define UI_FIELD_TITLE      0
+#define UI_FIELD_PI         1
+#define UI_FIELD_TIME       2
+#define UI_FIELD_LEFT       3
+#define UI_FIELD_STARTSTOP  4
+#define UI_FIELD_RESET      5
+#define UI_FIELD_RIGHT      6
+
+static screenField_t uiFields[] = {
+    SCREEN_FIELD(0, 0, 20),
+    SCREEN_FIELD(1, 0, 20),
+    SCREEN_FIELD(2, 0, 20),
+    SCREEN_FIELD(3, 0, 4),
+    SCREEN_FIELD(3, 4, 6),
+    SCREEN_FIELD(3, 10, 7),
+    SCREEN_FIELD(3, 17, 3),
+};
+
+// Screen fields of the digit viewer: position on line 0, DIGITS_PER_PAGE digits on lines 1-3
+#define DIGITS_PER_LINE     20
+#define DIGITS_PER_PAGE     (3 * DIGITS_PER_LINE)
+#define VIEW_FIELD_POS      0
+#define VIEW_FIELD_DIGITS   1
+
+static screenField_t viewFields[] = {
+    SCREEN_FIELD(0, 0, 20),
+    SCREEN_FIELD(1, 0, 20),
+    SCREEN_FIELD(2, 0, 20),
+    SCREEN_FIELD(3, 0, 20),
+};
+
+static screenField_t *uiScreen = NULL;	// Field table the screen model is bound to
+static uint16_t digitPage = 0;			// Page shown by the digit viewer
+
+// Binds the screen model to another field table, everything is sent again
+static void prvUiSetScreen(screenField_t *fields, uint8_t count) {
+    if (uiScreen != fields) {
+        uiScreen = fields;
+        vScreenInit(fields, count);
+    }
+}
+
+static uint8_t prvFormat(char *out, uint8_t size, char const *fmt, ...) {
+    va_list arg;
+    uint8_t length;
+    va_start(arg, fmt);
+    length = uxDisplayFormat(out, size, fmt, arg);
+    va_end(arg);
+    return length;
+}
+
+// Appends the digits of pi that can no longer change to the digit store. value +- bound
+// encloses pi, the digits both ends have in common are settled. A float holds 7 of them.
+static void prvPublishDigits(float32_t value, float32_t bound) {
+    char low[12];
+    char high[12];
+    uint8_t lowLength = prvFormat(low, sizeof(low), "%.6f", value - bound - 1e-6);
+    uint8_t highLength = prvFormat(high, sizeof(high), "%.6f", value + bound + 1e-6);
+    uint8_t settled = 0;
+    char digits[12];
+
+    for (uint8_t i = 0; i < lowLength && i < highLength && low[i] == high[i]; i++) {
+        if (low[i] != '.') {
+            digits[settled++] = low[i];
+        }
+    }
+    uint16_t stored = uxDigitStoreCount();
+    if (settled > stored) {
+        uxDigitStoreAppendString(&digits[stored], settled - stored);
+    }
+}
+
+// S3 + S4 on a calculation screen with its engine stopped
+static void prvDigitViewerOpen(void) {
+    viewerReturnMode = uiMode;
+    digitPage = 0;
+    uiMode = UIMODE_DIGITS;
+}
+
+// Digit viewer: S1 previous page, S4 next page, S3 + S4 back to the calculation it was
+// opened from with its digits, S3 resets that calculation and goes back
+static void prvDigitViewer(uint32_t buttonState) {
+    uint16_t count = uxDigitStoreCount();
+    uint16_t first = digitPage * DIGITS_PER_PAGE;
+    TickType_t startTick = xTaskGetTickCount();
+    uint16_t startCnt = TCC0.CNT;
+    char text[DIGITS_PER_LINE + 1];
+
+    vScreenSetField(VIEW_FIELD_POS, "Digits %u-%u/%u", first + 1, first + DIGITS_PER_PAGE, count);
+    for (uint8_t line = 0; line < 3; line++) {
+        for (uint8_t i = 0; i < DIGITS_PER_LINE; i++) {
+            text[i] = cDigitStoreGetChar(first + line * DIGITS_PER_LINE + i);
+        }
+        text[DIGITS_PER_LINE] = '\0';
+        vScreenSetField(VIEW_FIELD_DIGITS + line, "%s", text);
+    }
+    digitPageUS = ulDisplayElapsedUS(startTick, startCnt);
+
+    if ((buttonState & EVBUTTONS_S1) && digitPage > 0) {
+        digitPage--;
+    }
+    if ((buttonState & EVBUTTONS_S4) && first + DIGITS_PER_PAGE < count) {
+        digitPage++;
+    }
+    if (buttonState & EVBUTTONS_DIGITS) {
+        uiMode = viewerReturnMode;
+    } else if (buttonState & EVBUTTONS_S3) {
+        // Reset the calculation variables and go back to the calculation
+        prvEngineReset(prvShownEngine());
+        vDigitStoreReset();
+        uiMode = viewerReturnMode;
+    }
+}
 
 //vUi_task -> to handle the UI
 
 void vUi_task(void* pvParameters) {
-	char pistring[20];			// Character array to store the formatted value of pi
-	char timeString[20];		// Character array to store the formatted time in milliseconds
+	float32_t piShown = 0.0;	// Values shown in this cycle, formatted by the display driver
+	int timeShown = 0;
 	EventBits_t bitsCalcTskEv;  // Bitmask to store event flags related to calculation tasks
 
 	for (;;) {
 		// Get the state of the Leibniz, Nilakantha calculation tasks
-		eTaskState taskStateNilakantha = eTaskGetState(vNil_tsk);
-		eTaskState taskStateLeibniz = eTaskGetState(vLeibniz_tsk);		
+		eTaskState taskStateNilakantha = prvEngineGetState(ENGINE_NILAKANTHA);
+		eTaskState taskStateLeibniz = prvEngineGetState(ENGINE_LEIBNIZ);		
 
-		// Set the EVCALC_WAIT bit in the event group to signal calculation tasks to wait
+		// Set the EVCALC_WAIT bit in the event group to signal calculation tasks to wait.
+		// An engine may have set EVCALC_WAITING after the last cycle cleared EVCALC_WAIT,
+		// only an answer to this request counts.
+		xEventGroupClearBits(evCalcTaskEvents, EVCALC_WAITING);
 		xEventGroupSetBits(evCalcTaskEvents, EVCALC_WAIT);
 
 		// If both calculation tasks are not suspended, wait for the EVCALC_WAITING event flag
@@ -233,17 +952,45 @@ void vUi_task(void* pvParameters) {
 
 		// Check if the EVCALC_WAITING event flag is set or both tasks are suspended
 		if ((bitsCalcTskEv & EVCALC_WAITING) || ((taskStateLeibniz == eSuspended) && (taskStateNilakantha == eSuspended))) {
-			// Clear the display
-			vDisplayClear();
-			
-			// Format and store the value of pi and time in milliseconds
-			sprintf(&pistring[0], "PI: %.8f", pi_approx);
-			sprintf(&timeString[0], "Time: %.6d ms", time_ms);
+			// Store the value of pi and time in milliseconds of the engine on the screen for this cycle
+			engineState_t *shown = &engineState[prvShownEngine()];
+			piShown = shown->piApprox;
+			timeShown = shown->timeMs;
 			
 			
 			// Get the state of the button events
 			uint32_t buttonState = (xEventGroupGetBits(evButtonEvents)) & 0x000000FF;
 			xEventGroupClearBits(evButtonEvents, EVBUTTONS_CLEAR);
+			if (buttonState & (EVBUTTONS_BENCH | EVBUTTONS_CLOCK)) {
+				// The engines wait in the handshake, stop them for the benchmark or the clock switch
+				prvEnginesStop();
+				taskStateLeibniz = eSuspended;
+				taskStateNilakantha = eSuspended;
+			}
+			if (buttonState & EVBUTTONS_CLOCK) {
+				prvClockNextProfile();
+			}
+			if (buttonState & EVBUTTONS_BENCH) {
+				prvBenchStart();
+			}
+			if (buttonState & ~(EVBUTTONS_BENCH | EVBUTTONS_CLOCK)) {
+				// 32 bit bench clock difference, valid for latencies up to 89s at 48MHz
+				uint32_t edgeCycles;
+				taskENTER_CRITICAL();
+				edgeCycles = buttonEventCycles;
+				taskEXIT_CRITICAL();
+				buttonLatestMS = ((uint32_t) ullBenchClockCycles() - edgeCycles) / (BENCH_CLOCK_HZ / 1000UL);
+				if (buttonLatestMS > buttonLatencyMaxMS) {
+					buttonLatencyMaxMS = buttonLatestMS;
+				}
+			}
+
+			// Bind the screen model to the fields of the current UI mode
+			if (uiMode == UIMODE_DIGITS) {
+				prvUiSetScreen(viewFields, sizeof(viewFields) / sizeof(viewFields[0]));
+			} else {
+				prvUiSetScreen(uiFields, sizeof(uiFields) / sizeof(uiFields[0]));
+			}
 
 			// Handle the user interface based on the current UI mode
 			switch (uiMode) {
@@ -253,132 +1000,139 @@ void vUi_task(void* pvParameters) {
 				break;
 
 				case UIMODE_LEIBNIZ_CALC:
-				// Clear the display and update it with Leibniz calculation information
-				vDisplayClear();
-				eTaskState taskStateLeibniz = eTaskGetState(vLeibniz_tsk);
-				vDisplayWriteStringAtPos(0, 0, "Leibniz-Reihe:");
-				vDisplayWriteStringAtPos(1, 0, "%s", pistring);
-				vDisplayWriteStringAtPos(2, 0, "%s", timeString);
+				// Update the screen fields with Leibniz calculation information
+				eTaskState taskStateLeibniz = prvEngineGetState(ENGINE_LEIBNIZ);
+				if (taskStateLeibniz != eSuspended) {
+					// The remainder of an alternating series is smaller than the next term
+					prvPublishDigits(piShown, 4.0 / (2.0 * shown->iterations + 1));
+				}
+				vScreenSetField(UI_FIELD_TITLE, "Leibniz-Reihe:");
+				vScreenSetField(UI_FIELD_PI, "PI: %.8f", piShown);
+				vScreenSetField(UI_FIELD_TIME, "Time: %.6d ms", timeShown);
+				vScreenSetField(UI_FIELD_RESET, "|Reset");
 
 				// Update UI elements based on the task state
 				if (taskStateLeibniz == eSuspended) {
-					vDisplayWriteStringAtPos(3, 4, "Start");
-					vDisplayWriteStringAtPos(3, 0, "|<|");
-					vDisplayWriteStringAtPos(3, 17, "|>|");
-					vDisplayWriteStringAtPos(3, 10, "|Reset");
+					vScreenSetField(UI_FIELD_STARTSTOP, "Start");
+					vScreenSetField(UI_FIELD_LEFT, "|<|");
+					vScreenSetField(UI_FIELD_RIGHT, "|>|");
 					} else {
-					vDisplayWriteStringAtPos(3, 4, "Stop");
-					vDisplayWriteStringAtPos(3, 0, "| |");
-					vDisplayWriteStringAtPos(3, 17, "| |");
-					vDisplayWriteStringAtPos(3, 10, "|Reset");
+					vScreenSetField(UI_FIELD_STARTSTOP, "Stop");
+					vScreenSetField(UI_FIELD_LEFT, "| |");
+					vScreenSetField(UI_FIELD_RIGHT, "| |");
 				}
 
 				// Handle button events
 				if (buttonState & EVBUTTONS_S1) {
 					if (taskStateLeibniz == eSuspended) {
-						// Reset Leibniz calculation variables and switch to Nilakantha calculation
-						pi_approx = 0.0;				
-						term = 0.0;
-						iterations = 1;
-						sign = 1;
-						time_ms = 0;
+						// Reset Nilakantha calculation variables and switch to Nilakantha calculation
+						prvEngineReset(ENGINE_NILAKANTHA);
+						vDigitStoreReset();
 						uiMode = UIMODE_NILAKANTHA_CALC;
 					}
 				}
 				if (buttonState & EVBUTTONS_S2) {
 					if (taskStateLeibniz == eSuspended) {
 						// Start or stop Leibniz calculation task
-						startTime = xTaskGetTickCount();
-						vTaskResume(vLeibniz_tsk);
+						engineState[ENGINE_LEIBNIZ].startCycles = ullBenchClockCycles();
+						prvEngineResume(ENGINE_LEIBNIZ);
 						} else {
-						vTaskSuspend(vLeibniz_tsk);
+						prvEngineSuspend(ENGINE_LEIBNIZ);
 					}
 				}
 				if (buttonState & EVBUTTONS_S3) {
 						// Reset Leibniz calculation variables
-						pi_approx = 0.0;
-						term = 0.0;
-						iterations = 1;
-						sign = 1;
-						time_ms = 0;
-						startTime = xTaskGetTickCount();						
+						prvEngineReset(ENGINE_LEIBNIZ);
+						vDigitStoreReset();
 				}
 				if (buttonState & EVBUTTONS_S4) {
 					if (taskStateLeibniz == eSuspended) {
-						// Reset Leibniz calculation variables and switch to Nilakantha calculation
-						pi_approx = 0.0;
-						term = 0.0;
-						iterations = 1;
-						sign = 1;
-						time_ms = 0;
+						// Reset Nilakantha calculation variables and switch to Nilakantha calculation
+						prvEngineReset(ENGINE_NILAKANTHA);
+						vDigitStoreReset();
 						uiMode = UIMODE_NILAKANTHA_CALC;
 					}
 				}
+				if (buttonState & EVBUTTONS_DIGITS) {
+					if (taskStateLeibniz == eSuspended) {
+						// Show the digits computed so far
+						prvDigitViewerOpen();
+					}
+				}
 				break;
 
 				case UIMODE_NILAKANTHA_CALC:
-				// Clear the display and update it with Nilakantha calculation information
-				vDisplayClear();
-				vDisplayWriteStringAtPos(0, 0, "Nilakantha-Reihe:");
-				vDisplayWriteStringAtPos(1, 0, "%s", pistring);
-				vDisplayWriteStringAtPos(2, 0, "%s", timeString);
+				// Update the screen fields with Nilakantha calculation information
+				if (taskStateNilakantha != eSuspended) {
+					prvPublishDigits(piShown, 4.0 / (2.0*shown->iterations * (2.0*shown->iterations + 1) * (2.0*shown->iterations + 2)));
+				}
+				vScreenSetField(UI_FIELD_TITLE, "Nilakantha-Reihe:");
+				vScreenSetField(UI_FIELD_PI, "PI: %.8f", piShown);
+				vScreenSetField(UI_FIELD_TIME, "Time: %.6d ms", timeShown);
+				vScreenSetField(UI_FIELD_RESET, "|Reset");
 
 				// Update UI elements based on the task state
 				if (taskStateNilakantha == eSuspended) {
-					vDisplayWriteStringAtPos(3, 4, "Start");
-					vDisplayWriteStringAtPos(3, 0, "|<|");
-					vDisplayWriteStringAtPos(3, 17, "|>|");
-					vDisplayWriteStringAtPos(3, 10, "|Reset");
+					vScreenSetField(UI_FIELD_STARTSTOP, "Start");
+					vScreenSetField(UI_FIELD_LEFT, "|<|");
+					vScreenSetField(UI_FIELD_RIGHT, "|>|");
 					} else {
-					vDisplayWriteStringAtPos(3, 4, "Stop");
-					vDisplayWriteStringAtPos(3, 0, "| |");
-					vDisplayWriteStringAtPos(3, 17, "| |");
-					vDisplayWriteStringAtPos(3, 10, "|Reset");
+					vScreenSetField(UI_FIELD_STARTSTOP, "Stop");
+					vScreenSetField(UI_FIELD_LEFT, "| |");
+					vScreenSetField(UI_FIELD_RIGHT, "| |");
 				}
 
 				// Handle button events
 				if (buttonState & EVBUTTONS_S1) {
 					if (taskStateNilakantha == eSuspended) {
-						// Reset Nilakantha calculation variables and switch to Leibniz calculation
-						sign = 1;
-						iterations = 1;
-						pi_approx = 0.0;
-						time_ms = 0;
+						// Reset Leibniz calculation variables and switch to Leibniz calculation
+						prvEngineReset(ENGINE_LEIBNIZ);
+						vDigitStoreReset();
 						uiMode = UIMODE_LEIBNIZ_CALC;
 					}
 				}
 				if (buttonState & EVBUTTONS_S2) {
 					if (taskStateNilakantha == eSuspended) {
 						// Start or stop Nilakantha calculation task
-						startTime = xTaskGetTickCount();
-						vTaskResume(vNil_tsk);
+						engineState[ENGINE_NILAKANTHA].startCycles = ullBenchClockCycles();
+						prvEngineResume(ENGINE_NILAKANTHA);
 						} else {
-						vTaskSuspend(vNil_tsk);
+						prvEngineSuspend(ENGINE_NILAKANTHA);
 					}
 				}
 				if (buttonState & EVBUTTONS_S3) {
 						// Reset Nilakantha calculation variables
-						sign = 1;
-						iterations = 1;
-						pi_approx = 0.0;
-						time_ms = 0;
-						startTime = xTaskGetTickCount();						
+						prvEngineReset(ENGINE_NILAKANTHA);
+						vDigitStoreReset();
 				}
 				if (buttonState & EVBUTTONS_S4) {
 					if (taskStateNilakantha == eSuspended) {
-						// Reset Nilakantha calculation variables and switch to Wallis Product calculation
-						sign = 1;
-						iterations = 1;
-						pi_approx = 0.0;
-						time_ms = 0;
+						// Reset Leibniz calculation variables and switch to Leibniz calculation
+						prvEngineReset(ENGINE_LEIBNIZ);
+						vDigitStoreReset();
 						uiMode = UIMODE_LEIBNIZ_CALC;
 					}
 				}
+				if (buttonState & EVBUTTONS_DIGITS) {
+					if (taskStateNilakantha == eSuspended) {
+						// Show the digits computed so far
+						prvDigitViewerOpen();
+					}
+				}
+				break;
+
+				case UIMODE_DIGITS:
+				prvDigitViewer(buttonState);
 				break;
 			}
+			// Send the fields that changed in this cycle to the display
+			vScreenFlush();
+			prvEngineCountersTake();
 			// Clear the EVCALC_WAIT bit in the event group
 			xEventGroupClearBits(evCalcTaskEvents, EVCALC_WAIT);
 		}
+		// Check the stack high water marks of all tasks
+		checkAllStacks();
 		// Delay for 500 milliseconds
 		vTaskDelay(500 / portTICK_RATE_MS);
 	}
@@ -5,36 +5,191 @@
  *  Author: http://www.rn-wissen.de/index.php/Speicherverbrauch_bestimmen_mit_avr-gcc
  */ 
 
+#include <string.h>
 #include <avr/io.h>  // RAMEND
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+#include "errorHandler.h"
 #include "mem_check.h"
+#include "uartDriver.h"
 
 // Mask to init SRAM and check against
 #define MASK 0xaa
 
+#ifdef __AVR__
 // From linker script
 extern unsigned char __heap_start;
+extern unsigned char __data_start;
+#define MEM_DATA_START (&__data_start)
+#define MEM_HEAP_START (&__heap_start)
+#define MEM_RAM_END    ((unsigned char *) RAMEND + 1)
+#else
+// Host build (tools/hostsim): no linker symbols and main() runs on the host
+// stack, a painted block stands in for the RAM above the heap
+static unsigned char hostRam[1024];
+#define MEM_DATA_START hostRam
+#define MEM_HEAP_START hostRam
+#define MEM_RAM_END    (hostRam + sizeof (hostRam))
+#endif
+
+// FreeRTOS fills task stacks with this (tskSTACK_FILL_BYTE in tasks.c)
+#define STACK_FILL 0xa5
+
+static uint16_t mainUnusedCache = 0xFFFF;
+
+typedef struct
+{
+   TaskHandle_t task;
+   uint16_t unused;
+} memStackCache_t;
+
+static memStackCache_t stackCache[STACK_MONITOR_MAX_TASKS];
 
 // !!! This doesn't work together with malloc et.al. (whose use is
 // !!! discouraged on AVR, anyway). alloca, however, is no problem
 // !!! because it allocates on stack.
 
+static uint8_t mem_word_painted (const uint8_t *p, uint8_t fill)
+{
+   return p[0] == fill && p[1] == fill;
+}
+
+// Bytes at the start of [base, base + size) that still hold the fill pattern.
+// Binary search over words for the first touched one, then a walk of
+// MEM_PROBE_GUARD words further down to catch what the search jumped over.
+// The touched part only grows, so *cache (0xFFFF = unknown) limits the search.
+uint16_t mem_unused_painted (const uint8_t *base, uint16_t size, uint8_t fill, uint16_t *cache)
+{
+   uint16_t low = 0;
+   uint16_t high = size / 2;
+   uint16_t guard;
+   uint16_t unused;
+
+   if (*cache < size)
+      high = *cache / 2;
+
+   while (low < high)
+   {
+      uint16_t mid = low + (high - low) / 2;
+      if (mem_word_painted (base + 2 * mid, fill))
+         low = mid + 1;
+      else
+         high = mid;
+   }
+   // low = first touched word, unless an untouched gap fooled the search
+   guard = 0;
+   while (guard < low && guard < MEM_PROBE_GUARD)
+   {
+      guard++;
+      if (!mem_word_painted (base + 2 * (low - guard), fill))
+      {
+         low -= guard;
+         guard = 0;
+      }
+   }
+
+   unused = 2 * low;
+   if (unused < size && base[unused] == fill)
+      unused++;
+   if (unused > *cache)
+      unused = *cache;
+   *cache = unused;
+   return unused;
+}
+
 //  Get minimum of free memory (in bytes) up to now.
 unsigned short get_mem_unused (void)
 {
-   unsigned short unused = 0;
-   unsigned char *p = &__heap_start;
+   return mem_unused_painted (MEM_HEAP_START, (uint16_t) (MEM_RAM_END - MEM_HEAP_START), MASK, &mainUnusedCache);
+}
 
-   do
+static uint16_t *mem_stack_cache (TaskHandle_t task)
+{
+   for (uint8_t i = 0; i < STACK_MONITOR_MAX_TASKS; i++)
    {
-      if (*p++ != MASK)
-         break;
+      if (stackCache[i].task == task)
+         return &stackCache[i].unused;
+      if (stackCache[i].task == NULL)
+      {
+         stackCache[i].task = task;
+         stackCache[i].unused = 0xFFFF;
+         return &stackCache[i].unused;
+      }
+   }
+   return NULL;
+}
 
-      unused++;
-   } while (p <= (unsigned char*) RAMEND);
+uint8_t mem_inspect (memRegion_t *regions, uint8_t max)
+{
+   uint8_t count = 0;
+   void *task;
+   uint16_t stackSize;
+   TaskStatus_t status;
 
-   return unused;
+   if (count < max)
+   {
+      // .data, .bss and .noinit, includes the task stacks and the rtos heap below
+      regions[count].name = "static";
+      regions[count].size = (uint16_t) (MEM_HEAP_START - MEM_DATA_START);
+      regions[count].unused = 0;
+      count++;
+   }
+   if (count < max)
+   {
+      regions[count].name = "rtosheap";
+      regions[count].size = configTOTAL_HEAP_SIZE;
+      regions[count].unused = xPortGetFreeHeapSize ();
+      count++;
+   }
+   // the kernel tasks only exist once the scheduler runs
+   vStackMonitorAdd (xTaskGetIdleTaskHandle (), configMINIMAL_STACK_SIZE);
+   vStackMonitorAdd (xTimerGetTimerDaemonTaskHandle (), configTIMER_TASK_STACK_DEPTH);
+   for (uint8_t i = 0; count < max && xStackMonitorGet (i, &task, &stackSize); i++)
+   {
+      uint16_t *cache = mem_stack_cache (task);
+      uint16_t noCache = 0xFFFF;
+      vTaskGetInfo (task, &status, pdFALSE, eReady);
+      regions[count].name = status.pcTaskName;
+      regions[count].size = stackSize;
+      regions[count].unused = mem_unused_painted ((const uint8_t *) status.pxStackBase, stackSize, STACK_FILL, cache ? cache : &noCache);
+      count++;
+   }
+   if (count < max)
+   {
+      // only used before the scheduler starts, ISRs run on the task stacks
+      regions[count].name = "main";
+      regions[count].size = (uint16_t) (MEM_RAM_END - MEM_HEAP_START);
+      regions[count].unused = get_mem_unused ();
+      count++;
+   }
+   return count;
+}
+
+// Prints "MEM <region> <size> <used> <unused>" for every region
+void mem_report (void)
+{
+   static memRegion_t regions[MEM_REGION_MAX];
+   uint8_t count = mem_inspect (regions, MEM_REGION_MAX);
+
+   vInitUart ();
+   for (uint8_t i = 0; i < count; i++)
+   {
+      vUartLock ();
+      vUartPrint ("MEM ");
+      vUartPrint (regions[i].name);
+      vUartPutChar (' ');
+      vUartPrintNumber (regions[i].size);
+      vUartPutChar (' ');
+      vUartPrintNumber (regions[i].size - regions[i].unused);
+      vUartPutChar (' ');
+      vUartPrintNumber (regions[i].unused);
+      vUartPrint ("\r\n");
+      vUartUnlock ();
+   }
 }
 
+#ifdef __AVR__
 // !!! Never call this function, it is part of .init-Code
 void __attribute__ ((naked, section(".init3"))) init_mem (void);
 void init_mem (void)
@@ -54,5 +209,11 @@ void init_mem (void)
          : "i" (MASK), "i" (RAMEND+1)
    );
 }
+#else
+static void __attribute__ ((constructor)) init_mem (void)
+{
+   memset (hostRam, MASK, sizeof (hostRam));
+}
+#endif
 
 //EOF
\ No newline at end of file
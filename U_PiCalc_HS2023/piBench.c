@@ -0,0 +1,201 @@
+/*
+ * piBench.c
+ *
+ * Created: 19.10.2026 03:27:50
+ *  Author: agent
+ */ 
+#include "piBench.h"
+#include "benchClock.h"
+
+#ifdef __AVR__
+#include <avr/pgmspace.h>
+#else
+#define PROGMEM
+#define pgm_read_byte(address)	(*(const uint8_t *) (address))
+#endif
+
+#define PI_BENCH_MARKS	(PI_BENCH_MAX_DECIMALS - PI_BENCH_MIN_DECIMALS + 1)
+#define PI_BENCH_ULP	2.4e-7f		//Spacing of the floats between 2 and 4
+
+// Reference, without the decimal point
+static const char piReference[] PROGMEM = "31415926535897932384626433832795028841971693993751";
+
+const piEngine_t piEngines[PI_ENGINE_COUNT] = {
+	{"leibniz", 0.0f, 0, fPiLeibnizTerm},
+	{"nilakantha", 3.0f, 1, fPiNilakanthaTerm},
+};
+
+static float prvScale(uint8_t decimals) {
+	float scale = 1.0f;
+	while(decimals--) {
+		scale *= 10.0f;
+	}
+	return scale;
+}
+
+float fPiLeibnizTerm(uint32_t iteration, int8_t sign) {
+	float term = (float) sign / (2 * iteration + 1);
+	return term * 4;
+}
+
+float fPiNilakanthaTerm(uint32_t iteration, int8_t sign) {
+	return sign * (4.0f / (2.0f * iteration * (2.0f * iteration + 1) * (2.0f * iteration + 2)));
+}
+
+uint8_t ucPiCorrectDecimals(float value) {
+	char digits[PI_BENCH_MAX_DECIMALS + 1];
+	uint32_t scaled;
+	uint8_t correct = 0;
+
+	if(!(value >= 0.0f && value < 10.0f)) {
+		return 0;
+	}
+	// Truncated, same as the (3.14159, 3.1416) check of the engines
+	scaled = value * prvScale(PI_BENCH_MAX_DECIMALS);
+	for(int8_t i = PI_BENCH_MAX_DECIMALS; i >= 0; i--) {
+		digits[i] = '0' + scaled % 10;
+		scaled /= 10;
+	}
+	if(digits[0] != (char) pgm_read_byte(&piReference[0])) {
+		return 0;
+	}
+	while(correct < PI_BENCH_MAX_DECIMALS && digits[correct + 1] == (char) pgm_read_byte(&piReference[correct + 1])) {
+		correct++;
+	}
+	return correct;
+}
+
+// pi truncated to decimals, the lower end of the interval in which that many are correct
+static float prvReference(uint8_t decimals) {
+	uint32_t value = 0;
+	for(uint8_t i = 0; i <= decimals; i++) {
+		value = value * 10 + (pgm_read_byte(&piReference[i]) - '0');
+	}
+	return value / prvScale(decimals);
+}
+
+// Decimals that are correct for every value in value +- bound
+static uint8_t prvSettledDecimals(float value, float bound) {
+	uint8_t low = ucPiCorrectDecimals(value - bound);
+	uint8_t high = ucPiCorrectDecimals(value + bound);
+	return low < high ? low : high;
+}
+
+void vPiBenchRun(uint8_t engine, piBenchResult_t *result) {
+	const piEngine_t *pe = &piEngines[engine];
+	float value = pe->initialValue;
+	uint32_t iteration = pe->firstIteration;
+	int8_t sign = 1;
+	float low;
+	float high;
+	uint64_t start;
+
+	result->engine = engine;
+	result->decimals = 0;
+	result->iterations = 0;
+	for(uint8_t m = 0; m < PI_BENCH_MARKS; m++) {
+		result->marks[m].iterations = 0;
+		result->marks[m].cycles = 0;
+	}
+	// Only the interval of the next decimal is checked per term, as cheap as the check of the engines
+	low = prvReference(PI_BENCH_MIN_DECIMALS);
+	high = low + 1.0f / prvScale(PI_BENCH_MIN_DECIMALS);
+	start = ullBenchClockCycles();
+	while(result->iterations < PI_BENCH_MAX_ITERATIONS && result->decimals < PI_BENCH_MAX_DECIMALS) {
+		value += pe->term(iteration, sign);
+		sign = -sign;
+		iteration++;
+		result->iterations++;
+		if(value >= low && value < high) {
+			uint64_t hit = ullBenchClockCycles();
+			uint8_t next = result->decimals < PI_BENCH_MIN_DECIMALS ? PI_BENCH_MIN_DECIMALS : result->decimals + 1;
+			// The series alternate, the sum is within the next term of pi. A decimal only
+			// counts when that and the float spacing cannot change it any more, a float
+			// that happens to round into the interval is not a result of the series.
+			float bound = pe->term(iteration, 1);
+			uint8_t decimals = prvSettledDecimals(value, (bound < 0 ? -bound : bound) + PI_BENCH_ULP);
+			if(decimals >= next) {
+				for(uint8_t d = next; d <= decimals; d++) {
+					result->marks[d - PI_BENCH_MIN_DECIMALS].iterations = result->iterations;
+					result->marks[d - PI_BENCH_MIN_DECIMALS].cycles = hit - start;
+				}
+				result->decimals = decimals;
+				low = prvReference(decimals + 1);
+				high = low + 1.0f / prvScale(decimals + 1);
+			}
+			start += ullBenchClockCycles() - hit;	// the bookkeeping is not engine time
+		}
+	}
+}
+
+uint32_t ulPiBenchCyclesPerTerm(uint8_t engine, uint16_t terms) {
+	const piEngine_t *pe = &piEngines[engine];
+	volatile float value = pe->initialValue;	// keeps the sum from being optimised away
+	uint32_t iteration = pe->firstIteration;
+	int8_t sign = 1;
+	uint64_t start = ullBenchClockCycles();
+
+	for(uint16_t i = 0; i < terms; i++) {
+		value += pe->term(iteration, sign);
+		sign = -sign;
+		iteration++;
+	}
+	return (ullBenchClockCycles() - start) / (terms > 0 ? terms : 1);
+}
+
+static void prvPrintNumber(void (*print)(const char *s), uint64_t value) {
+	char text[21];
+	uint8_t pos = sizeof(text) - 1;
+	text[pos] = '\0';
+	do {
+		text[--pos] = '0' + value % 10;
+		value /= 10;
+	} while(value != 0);
+	print(&text[pos]);
+}
+
+void vPiBenchReport(const piBenchResult_t *results, uint8_t count, void (*print)(const char *s)) {
+#if PI_BENCH_JSON == 1
+	print("{\"clock_hz\":");
+	prvPrintNumber(print, BENCH_CLOCK_HZ);
+	print(",\"results\":[");
+#else
+	print("BENCH1 ");
+	prvPrintNumber(print, BENCH_CLOCK_HZ);
+	print("\r\nengine,decimals,iterations,us,cycles\r\n");
+#endif
+	for(uint8_t r = 0; r < count; r++) {
+		for(uint8_t m = 0; m < PI_BENCH_MARKS; m++) {
+			const piBenchMark_t *mark = &results[r].marks[m];
+#if PI_BENCH_JSON == 1
+			print(r == 0 && m == 0 ? "{\"engine\":\"" : ",{\"engine\":\"");
+			print(piEngines[results[r].engine].name);
+			print("\",\"decimals\":");
+			prvPrintNumber(print, PI_BENCH_MIN_DECIMALS + m);
+			print(",\"iterations\":");
+			prvPrintNumber(print, mark->iterations);
+			print(",\"us\":");
+			prvPrintNumber(print, mark->cycles / (BENCH_CLOCK_HZ / 1000000UL));
+			print(",\"cycles\":");
+			prvPrintNumber(print, mark->cycles);
+			print("}");
+#else
+			print(piEngines[results[r].engine].name);
+			print(",");
+			prvPrintNumber(print, PI_BENCH_MIN_DECIMALS + m);
+			print(",");
+			prvPrintNumber(print, mark->iterations);
+			print(",");
+			prvPrintNumber(print, mark->cycles / (BENCH_CLOCK_HZ / 1000000UL));
+			print(",");
+			prvPrintNumber(print, mark->cycles);
+			print("\r\n");
+#endif
+		}
+	}
+#if PI_BENCH_JSON == 1
+	print("]}\r\n");
+#else
+	print("END\r\n");
+#endif
+}
@@ -0,0 +1,153 @@
+/*
+ * profiler.c
+ *
+ * Created: 19.10.2026 03:05:32
+ *  Author: agent
+ */ 
+#include <stdlib.h>
+#include "avr_compiler.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "uartDriver.h"
+#include "stackConfig.h"
+#include "profiler.h"
+
+#define PROFILER_MAX_PROBES		8
+#define PROFILER_MAX_TASKS		RTOS_TASK_COUNT	//uxTaskGetSystemState() returns nothing if the table is too small
+
+// Bytes pushed by the tick ISR after the return address: r31, SREG, PMIC.CTRL,
+// r0..r30 and optionally RAMPZ/X/D (see portSAVE_CONTEXT in portmacro.h).
+#if configEXTENDED_ADRESSING == 1
+	#define PROFILER_CONTEXT_SIZE	37
+#else
+	#define PROFILER_CONTEXT_SIZE	34
+#endif
+
+typedef void tskTCB;
+extern volatile tskTCB * volatile pxCurrentTCB;
+
+typedef struct {
+	uint16_t pc;		//Word address >> PROFILER_PC_SHIFT, 0 = free slot
+	uint8_t task;
+	uint16_t count;
+} profilerSlot_t;
+
+static profilerSlot_t histogram[PROFILER_HISTOGRAM_SIZE];
+static uint8_t sampleDivisor = PROFILER_SAMPLE_DIVISOR;
+static uint8_t sampleCounter = 0;
+static volatile uint8_t profilerEnabled = 1;
+static uint32_t samples = 0;
+static uint32_t dropped = 0;
+
+void vProfilerStart(uint8_t divisor) {
+	if(divisor == 0) {
+		divisor = 1;
+	}
+	sampleDivisor = divisor;
+	sampleCounter = 0;
+	profilerEnabled = 1;
+}
+
+void vProfilerStop(void) {
+	profilerEnabled = 0;
+}
+
+// Called from xTaskIncrementTick inside the tick ISR, after the context of the
+// interrupted task has been saved to its stack.
+void vApplicationTickHook(void) {
+	uint8_t *sp;
+	uint32_t pc;
+	uint16_t key;
+	uint8_t task;
+	uint8_t index;
+
+	if(!profilerEnabled) {
+		return;
+	}
+	if(++sampleCounter < sampleDivisor) {
+		return;
+	}
+	sampleCounter = 0;
+
+	sp = *(uint8_t * volatile *) pxCurrentTCB;	//pxTopOfStack is the first TCB member
+	sp += PROFILER_CONTEXT_SIZE + 1;
+#if config24BITADDRESSING == 1
+	pc = ((uint32_t) sp[0] << 16) | ((uint16_t) sp[1] << 8) | sp[2];
+#else
+	pc = ((uint16_t) sp[0] << 8) | sp[1];
+#endif
+	key = (uint16_t)(pc >> PROFILER_PC_SHIFT);
+	if(key == 0) {
+		key = 1;
+	}
+	task = (uint8_t) uxTaskGetTaskNumber(xTaskGetCurrentTaskHandle());
+	samples++;
+
+	index = (uint8_t)(key ^ (task << 3)) & (PROFILER_HISTOGRAM_SIZE - 1);
+	for(uint8_t probe = 0; probe < PROFILER_MAX_PROBES; probe++) {
+		profilerSlot_t *slot = &histogram[index];
+		if(slot->pc == 0) {
+			slot->pc = key;
+			slot->task = task;
+		}
+		if(slot->pc == key && slot->task == task) {
+			if(slot->count < 0xFFFF) {
+				slot->count++;
+			}
+			return;
+		}
+		index = (index + 1) & (PROFILER_HISTOGRAM_SIZE - 1);
+	}
+	dropped++;
+}
+
+void vProfilerDump(void) {
+	static TaskStatus_t taskStatus[PROFILER_MAX_TASKS];
+	UBaseType_t taskCount;
+	char buffer[9];
+	uint8_t wasEnabled = profilerEnabled;
+
+	vInitUart();
+	profilerEnabled = 0;
+	taskCount = uxTaskGetSystemState(taskStatus, PROFILER_MAX_TASKS, NULL);
+
+	vUartLock();
+	vUartPrint("PROF1 ");
+	vUartPrintNumber(sampleDivisor);
+	vUartPutChar(' ');
+	vUartPrintNumber(PROFILER_PC_SHIFT);
+	vUartPutChar(' ');
+	vUartPrintNumber(samples);
+	vUartPutChar(' ');
+	vUartPrintNumber(dropped);
+	vUartPrint("\r\n");
+	for(UBaseType_t i = 0; i < taskCount; i++) {
+		vUartPrint("T ");
+		vUartPrintNumber(taskStatus[i].xTaskNumber);
+		vUartPutChar(' ');
+		vUartPrint(taskStatus[i].pcTaskName);
+		vUartPrint("\r\n");
+	}
+	for(uint8_t i = 0; i < PROFILER_HISTOGRAM_SIZE; i++) {
+		if(histogram[i].pc == 0) {
+			continue;
+		}
+		vUartPrint("S ");
+		vUartPrintNumber(histogram[i].task);
+		vUartPutChar(' ');
+		ultoa((uint32_t) histogram[i].pc << (PROFILER_PC_SHIFT + 1), buffer, 16);
+		vUartPrint(buffer);
+		vUartPutChar(' ');
+		vUartPrintNumber(histogram[i].count);
+		vUartPrint("\r\n");
+		histogram[i].pc = 0;
+		histogram[i].count = 0;
+	}
+	vUartPrint("END\r\n");
+	vUartUnlock();
+	samples = 0;
+	dropped = 0;
+	profilerEnabled = wasEnabled;
+}
@@ -0,0 +1,100 @@
+/*
+ * screenModel.c
+ *
+ * Created: 19.10.2026 03:14:51
+ *  Author: agent
+ */ 
+#include <stdarg.h>
+#include <string.h>
+#include "avr_compiler.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "NHD0420Driver.h"
+#include "screenModel.h"
+
+static screenField_t *screenFields = NULL;
+static uint8_t screenFieldCount = 0;
+static screenStats_t screenStats;
+static uint32_t screenFormatUS = 0;	// formatting time of the current cycle
+
+void vScreenInit(screenField_t *fields, uint8_t count) {
+	screenFields = fields;
+	screenFieldCount = count;
+	for(uint8_t i = 0; i < count; i++) {
+		if(fields[i].width > SCREEN_FIELD_MAX_WIDTH) {
+			fields[i].width = SCREEN_FIELD_MAX_WIDTH;
+		}
+		memset(fields[i].text, ' ', SCREEN_FIELD_MAX_WIDTH);
+		fields[i].dirty = 1;
+	}
+}
+
+void vScreenSetField(uint8_t field, char const *fmt, ...) {
+	char text[SCREEN_FIELD_MAX_WIDTH];
+	screenField_t *f;
+	uint8_t length;
+	va_list arg;
+	TickType_t startTick = xTaskGetTickCount();
+	uint16_t startCnt = TCC0.CNT;
+
+	if(field >= screenFieldCount) {
+		return;
+	}
+	f = &screenFields[field];
+	va_start(arg, fmt);
+	length = uxDisplayFormat(text, f->width, fmt, arg);
+	va_end(arg);
+	memset(&text[length], ' ', f->width - length);	// overwrite what the old text left behind
+	if(memcmp(text, f->text, f->width) != 0) {
+		memcpy(f->text, text, f->width);
+		f->dirty = 1;
+	}
+	screenFormatUS += ulDisplayElapsedUS(startTick, startCnt);
+}
+
+void vScreenInvalidate(void) {
+	for(uint8_t i = 0; i < screenFieldCount; i++) {
+		screenFields[i].dirty = 1;
+	}
+}
+
+void vScreenFlush(void) {
+	char text[SCREEN_FIELD_MAX_WIDTH + 1];
+	uint8_t sent = 0;
+	uint8_t skipped = 0;
+	TickType_t startTick = xTaskGetTickCount();
+	uint16_t startCnt = TCC0.CNT;
+	uint32_t flushUS;
+
+	for(uint8_t i = 0; i < screenFieldCount; i++) {
+		screenField_t *f = &screenFields[i];
+		if(!f->dirty) {
+			skipped++;
+			continue;
+		}
+		memcpy(text, f->text, f->width);
+		text[f->width] = '\0';
+		vDisplayWriteStringAtPos(f->line, f->pos, "%s", text);
+		f->dirty = 0;
+		sent++;
+	}
+	flushUS = ulDisplayElapsedUS(startTick, startCnt) + screenFormatUS;
+	screenFormatUS = 0;
+
+	taskENTER_CRITICAL();
+	screenStats.cycles++;
+	screenStats.fieldsSent += sent;
+	screenStats.fieldsSkipped += skipped;
+	screenStats.lastFieldsSent = sent;
+	screenStats.lastFlushUS = flushUS;
+	if(flushUS > screenStats.maxFlushUS) {
+		screenStats.maxFlushUS = flushUS;
+	}
+	taskEXIT_CRITICAL();
+}
+
+void vScreenGetStats(screenStats_t *stats) {
+	taskENTER_CRITICAL();
+	*stats = screenStats;
+	taskEXIT_CRITICAL();
+}
@@ -0,0 +1,102 @@
+/*
+ * traceRecorder.c
+ *
+ * Created: 19.10.2026 03:04:40
+ *  Author: agent
+ */ 
+#include "avr_compiler.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "uartDriver.h"
+#include "init.h"
+#include "stackConfig.h"
+#include "traceRecorder.h"
+
+#if configUSE_TRACE_RECORDER == 1
+
+#define TRACE_MAX_TASKS RTOS_TASK_COUNT		//uxTaskGetSystemState() returns nothing if the table is too small
+
+volatile uint16_t uxTraceTick = 0;
+
+static traceRecord_t traceBuffer[TRACE_BUFFER_SIZE];
+static uint8_t traceHead = 0;		//Next slot to write
+static uint8_t traceCount = 0;		//Valid records in the buffer
+static uint32_t traceTotal = 0;		//Records written since the last dump (incl. overwritten ones)
+static volatile uint8_t traceEnabled = 1;
+
+void vTraceRecord(uint8_t event, uint8_t arg) {
+	uint8_t sreg = SREG;
+	cli();
+	if(traceEnabled) {
+		traceRecord_t *r = &traceBuffer[traceHead];
+		r->event = event;
+		r->arg = arg;
+		r->tick = uxTraceTick;
+		r->subTick = TCC0.CNT;
+		if(++traceHead >= TRACE_BUFFER_SIZE) {
+			traceHead = 0;
+		}
+		if(traceCount < TRACE_BUFFER_SIZE) {
+			traceCount++;
+		}
+		traceTotal++;
+	}
+	SREG = sreg;
+}
+
+void vTraceDump(void) {
+	static TaskStatus_t taskStatus[TRACE_MAX_TASKS];
+	UBaseType_t taskCount;
+	uint8_t index;
+	uint8_t u8;
+	uint16_t u16;
+	uint32_t u32;
+
+	vInitUart();
+	traceEnabled = 0;
+	taskCount = uxTaskGetSystemState(taskStatus, TRACE_MAX_TASKS, NULL);
+
+	vUartLock();
+	vUartPrint("TRC1");
+	u8 = sizeof(traceRecord_t);
+	vUartWrite(&u8, 1);
+	u32 = ulClockCpuHz() / CLOCK_TICK_PRESCALER;
+	vUartWrite(&u32, sizeof(u32));
+	u16 = traceCount;
+	vUartWrite(&u16, sizeof(u16));
+	vUartWrite(&traceTotal, sizeof(traceTotal));
+	vUartWrite(&taskCount, 1);
+	for(UBaseType_t i = 0; i < taskCount; i++) {
+		char name[configMAX_TASK_NAME_LEN];
+		u8 = (uint8_t) taskStatus[i].xTaskNumber;
+		vUartWrite(&u8, 1);
+		for(uint8_t j = 0; j < configMAX_TASK_NAME_LEN; j++) {
+			name[j] = taskStatus[i].pcTaskName[j];
+			if(name[j] == '\0') {
+				for(; j < configMAX_TASK_NAME_LEN; j++) {
+					name[j] = '\0';
+				}
+				break;
+			}
+		}
+		vUartWrite(name, configMAX_TASK_NAME_LEN);
+	}
+
+	index = (traceHead + TRACE_BUFFER_SIZE - traceCount) % TRACE_BUFFER_SIZE;
+	for(uint8_t i = 0; i < traceCount; i++) {
+		vUartWrite(&traceBuffer[index], sizeof(traceRecord_t));
+		if(++index >= TRACE_BUFFER_SIZE) {
+			index = 0;
+		}
+	}
+	vUartUnlock();
+
+	traceHead = 0;
+	traceCount = 0;
+	traceTotal = 0;
+	traceEnabled = 1;
+}
+
+#endif
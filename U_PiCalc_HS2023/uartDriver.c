@@ -0,0 +1,93 @@
+/*
+ * uartDriver.c
+ *
+ * Created: 19.10.2026 03:04:40
+ *  Author: agent
+ */ 
+#include <stdlib.h>
+#include "avr_compiler.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include "uartDriver.h"
+#include "init.h"
+
+// BSEL = 2^7 * (f / (16 * 115200) - 1) = 8 * f / 115200 - 128, 2094 at 32MHz, BSCALE = -7
+#define UART_BAUD		115200UL
+#define UART_BSCALE		0x09
+
+static uint8_t uartInitialized = 0;
+static StaticSemaphore_t uartMutexBuffer;
+static SemaphoreHandle_t uartMutex = NULL;
+static TaskHandle_t uartOwner = NULL;			//NULL while the lock was not taken
+
+void vInitUart(void) {
+	if(uartInitialized) {
+		return;
+	}
+	PORTC.OUTSET = PIN3_bm;
+	PORTC.DIRSET = PIN3_bm; //TX
+	PORTC.DIRCLR = PIN2_bm; //RX
+	uartInitialized = 1;
+	vUartClockChanged();
+	USARTC0.CTRLC = USART_CMODE_ASYNCHRONOUS_gc | USART_PMODE_DISABLED_gc | USART_CHSIZE_8BIT_gc;
+	USARTC0.CTRLB = USART_TXEN_bm | USART_RXEN_bm;
+}
+
+void vUartClockChanged(void) {
+	uint16_t bsel = (8 * ulClockCpuHz() + UART_BAUD / 2) / UART_BAUD - 128;
+	if(!uartInitialized) {
+		return;
+	}
+	USARTC0.BAUDCTRLA = (uint8_t)(bsel & 0xFF);
+	USARTC0.BAUDCTRLB = (UART_BSCALE << USART_BSCALE_gp) | (uint8_t)(bsel >> 8);
+}
+
+// Without the scheduler (boot, crash report) nothing can interleave, the lock is
+// skipped then. Only the task that took it gives it back.
+void vUartLock(void) {
+	if(xTaskGetSchedulerState() != taskSCHEDULER_RUNNING) {
+		return;
+	}
+	taskENTER_CRITICAL();
+	if(uartMutex == NULL) {
+		uartMutex = xSemaphoreCreateMutexStatic(&uartMutexBuffer);
+	}
+	taskEXIT_CRITICAL();
+	xSemaphoreTake(uartMutex, portMAX_DELAY);
+	uartOwner = xTaskGetCurrentTaskHandle();
+}
+
+void vUartUnlock(void) {
+	if(uartOwner == NULL || uartOwner != xTaskGetCurrentTaskHandle()) {
+		return;
+	}
+	uartOwner = NULL;
+	xSemaphoreGive(uartMutex);
+}
+
+void vUartPutChar(char c) {
+	while((USARTC0.STATUS & USART_DREIF_bm) == 0) {
+		nop();
+	}
+	USARTC0.DATA = c;
+}
+
+void vUartWrite(const void *data, uint16_t len) {
+	const uint8_t *p = (const uint8_t *) data;
+	while(len--) {
+		vUartPutChar(*p++);
+	}
+}
+
+void vUartPrint(const char *s) {
+	while(*s != '\0') {
+		vUartPutChar(*s++);
+	}
+}
+
+void vUartPrintNumber(uint32_t value) {
+	char buffer[11];
+	ultoa(value, buffer, 10);
+	vUartPrint(buffer);
+}
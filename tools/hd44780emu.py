@@ -0,0 +1,186 @@
+#!/usr/bin/env python3
+"""Replay a display bus capture from vDisplayBusDump() (NHD0420Hal.c) on an HD44780 model.
+
+Usage: hd44780emu.py <uart capture> [--quiet]
+
+The capture may contain other UART output, the first "BUS1" block is used.
+Every falling edge of E is fed into a model of the controller's 4-bit
+interface. The tool decodes the command stream, keeps the DDRAM and prints for
+every frame (started by vDisplayBusMark() in the display task):
+
+  - the 4x20 characters on the glass after the frame,
+  - the number of instructions and the bus time the frame took
+    (first nibble to the end of the execution time of the last instruction),
+  - every instruction that was sent before the previous one was executed.
+
+Execution times are the datasheet values at 270kHz (fosc of the ST7066U on the
+NHD-0420). The exit code is 1 if a timing violation was found.
+
+tools/hostmock/hd44780.c is the same model in C on the pins of the register
+mock: there the driver drives it through NHD0420Hal.h while it runs, in
+tools/hostsim and tools/tests/test_hd44780.c. This tool is for captures of the
+board.
+"""
+import struct
+import sys
+
+BUS_RS = 0x10
+BUS_RW = 0x20
+BUS_MARK = 0x80
+
+EXEC_CLEAR_US = 1520      # clear display, return home
+EXEC_COMMAND_US = 37      # all other instructions
+EXEC_DATA_US = 37 + 4     # write data incl. tADD
+EXEC_INIT1_US = 4100      # after the first 8 bit function set
+EXEC_INIT2_US = 100       # after the second 8 bit function set
+
+LINE_ADDRESS = (0x00, 0x40, 0x14, 0x54)
+
+
+def parse(data):
+    start = data.find(b"BUS1")
+    if start < 0:
+        raise ValueError("no BUS1 block found")
+    pos = start + 4
+    (count,) = struct.unpack_from("<H", data, pos)
+    pos += 2
+    entries = []
+    now = 0
+    for _ in range(count):
+        bus, delta = struct.unpack_from("<BH", data, pos)
+        pos += 3
+        now += delta
+        entries.append((bus, now, delta == 0xFFFF))
+    return entries
+
+
+class HD44780:
+    def __init__(self):
+        self.ddram = [0x20] * 128
+        self.address = 0
+        self.increment = True
+        self.cgram = False
+        self.four_bit = False
+        self.high = None          # first nibble of a 4 bit transfer
+        self.init_count = 0       # 8 bit function sets seen
+        self.ready_at = None      # us when the last instruction is executed
+        self.violations = []
+
+    def _advance(self):
+        if self.increment:
+            self.address = {0x27: 0x40, 0x67: 0x00}.get(self.address, self.address + 1)
+        else:
+            self.address = {0x40: 0x27, 0x00: 0x67}.get(self.address, self.address - 1)
+
+    def _execute(self, rs, value, time, unknown):
+        if self.ready_at is not None and not unknown and time < self.ready_at:
+            self.violations.append((time, rs, value, self.ready_at - time))
+        if rs:
+            if not self.cgram:
+                self.ddram[self.address & 0x7F] = value
+                self._advance()
+            duration = EXEC_DATA_US
+        elif value == 0x01:
+            self.ddram = [0x20] * 128
+            self.address = 0
+            self.increment = True
+            self.cgram = False
+            duration = EXEC_CLEAR_US
+        elif value & 0xFE == 0x02:
+            self.address = 0
+            self.cgram = False
+            duration = EXEC_CLEAR_US
+        else:
+            if value & 0x80:
+                self.address = value & 0x7F
+                self.cgram = False
+            elif value & 0x40:
+                self.cgram = True
+            elif value & 0x20:
+                self.four_bit = not (value & 0x10)
+            elif value & 0xFC == 0x04:
+                self.increment = bool(value & 0x02)
+            duration = EXEC_COMMAND_US
+        self.ready_at = time + duration
+        return duration
+
+    def latch(self, bus, time, unknown):
+        """One falling edge of E. Returns the execution time of a completed instruction or None."""
+        nibble = bus & 0x0F
+        rs = bool(bus & BUS_RS)
+        if bus & BUS_RW:
+            # busy flag / address read, 2 nibbles in 4 bit mode, no instruction
+            if self.four_bit:
+                self.high = None if self.high is not None else nibble
+            return None
+        if not self.four_bit:
+            # 8 bit mode after reset: DB3..0 are not connected, each nibble is an instruction
+            value = nibble << 4
+            duration = self._execute(rs, value, time, unknown)
+            if not rs and value == 0x30:
+                self.init_count += 1
+                if self.init_count == 1:
+                    self.ready_at = time + EXEC_INIT1_US
+                elif self.init_count == 2:
+                    self.ready_at = time + EXEC_INIT2_US
+            return duration
+        if self.high is None:
+            self.high = nibble
+            return None
+        value = (self.high << 4) | nibble
+        self.high = None
+        return self._execute(rs, value, time, unknown)
+
+    def lines(self):
+        result = []
+        for address in LINE_ADDRESS:
+            text = "".join(chr(c) if 0x20 <= c < 0x7F else "?" for c in self.ddram[address:address + 20])
+            result.append(text)
+        return result
+
+
+def main(argv):
+    if len(argv) < 2:
+        print(__doc__, file=sys.stderr)
+        return 2
+    quiet = "--quiet" in argv[2:]
+    with open(argv[1], "rb") as f:
+        entries = parse(f.read())
+    lcd = HD44780()
+    frame_count = 0
+    frame = None
+
+    def report(frame, lcd):
+        bus_us = frame["end"] - frame["start"] if frame["start"] is not None else 0
+        print("frame %d: %d instructions, %d us bus time, %d violations"
+              % (frame["index"], frame["instructions"], bus_us, len(lcd.violations) - frame["violations"]))
+        if not quiet:
+            for text in lcd.lines():
+                print("  |%s|" % text)
+
+    for bus, time, unknown in entries:
+        if bus & BUS_MARK:
+            if frame is not None:
+                report(frame, lcd)
+            frame = {"index": frame_count, "start": None, "end": None, "instructions": 0,
+                     "violations": len(lcd.violations)}
+            frame_count += 1
+            continue
+        duration = lcd.latch(bus, time, unknown)
+        if frame is None or duration is None:
+            continue
+        if frame["start"] is None:
+            frame["start"] = time
+        frame["end"] = time + duration
+        frame["instructions"] += 1
+    if frame is not None:
+        report(frame, lcd)
+
+    for time, rs, value, early in lcd.violations:
+        print("violation at %d us: %s 0x%02X sent %d us early"
+              % (time, "data" if rs else "command", value, early))
+    return 1 if lcd.violations else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,48 @@
+/*
+ * eeprom.h
+ *
+ * Created: 19.10.2026 03:48:14
+ *  Author: agent
+ *
+ * Host replacement of <avr/eeprom.h>. EEMEM variables are ordinary memory, so
+ * the EEPROM keeps its content across vMockReset() but not across runs.
+ */
+
+
+#ifndef MOCK_AVR_EEPROM_H_
+#define MOCK_AVR_EEPROM_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#define EEMEM
+
+static inline uint8_t eeprom_read_byte(const uint8_t *address) {
+	return *address;
+}
+
+static inline uint16_t eeprom_read_word(const uint16_t *address) {
+	return *address;
+}
+
+static inline void eeprom_read_block(void *destination, const void *source, size_t size) {
+	memcpy(destination, source, size);
+}
+
+static inline void eeprom_update_byte(uint8_t *address, uint8_t value) {
+	*address = value;
+}
+
+static inline void eeprom_update_word(uint16_t *address, uint16_t value) {
+	*address = value;
+}
+
+static inline void eeprom_update_block(const void *source, void *destination, size_t size) {
+	memcpy(destination, source, size);
+}
+
+#define eeprom_write_byte		eeprom_update_byte
+#define eeprom_write_word		eeprom_update_word
+#define eeprom_write_block		eeprom_update_block
+
+#endif /* MOCK_AVR_EEPROM_H_ */
@@ -0,0 +1,27 @@
+/*
+ * interrupt.h
+ *
+ * Created: 19.10.2026 03:48:14
+ *  Author: agent
+ *
+ * Host replacement of <avr/interrupt.h>, see mockHal.h. An ISR is a plain
+ * function named after its vector, mockHal.c calls it when the flag and the
+ * level of its source are set and interrupts are enabled.
+ */
+
+
+#ifndef MOCK_AVR_INTERRUPT_H_
+#define MOCK_AVR_INTERRUPT_H_
+
+#include "avr/io.h"
+
+#define ISR(vector, ...)	void vector(void); void vector(void)
+#define ISR_BLOCK
+#define ISR_NOBLOCK
+#define ISR_NAKED
+#define reti()				return
+
+#define sei()				vMockSei()
+#define cli()				vMockCli()
+
+#endif /* MOCK_AVR_INTERRUPT_H_ */
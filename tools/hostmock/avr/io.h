@@ -0,0 +1,737 @@
+/*
+ * io.h
+ *
+ * Created: 19.10.2026 03:48:14
+ *  Author: agent
+ *
+ * Host replacement of <avr/io.h> for the ATxmega128A3U, see mockHal.h.
+ * Only the peripherals and bits used in this project are declared. The register
+ * structs have the layout and the names of avr-libc, the instances sit in
+ * mockIo at the I/O address of the device, so &PORTF & co. stay constant
+ * expressions like on the target. nop() ticks the mock, a polling loop needs
+ * it in its body to see the flag change.
+ */
+
+
+#ifndef MOCK_AVR_IO_H_
+#define MOCK_AVR_IO_H_
+
+#include <stdint.h>
+
+#define MOCK_IO_SIZE			0x1000
+
+typedef uint16_t mockUnaligned16_t __attribute__((aligned(1)));
+
+extern uint8_t mockIo[MOCK_IO_SIZE];			//the I/O space 0x0000..0x0FFF of the device, mockHal.c
+
+#define _SFR_MEM8(addr)			(*(volatile uint8_t *) &mockIo[addr])
+#define _SFR_MEM16(addr)		(*(volatile mockUnaligned16_t *) &mockIo[addr])	//SP lies on an odd address
+
+#define nop()					vMockNop()
+
+typedef volatile uint8_t register8_t;
+typedef volatile uint16_t register16_t;
+
+#define _WORDREGISTER(regname)			\
+	__extension__ union {				\
+		register16_t regname;			\
+		struct {						\
+			register8_t regname ## L;	\
+			register8_t regname ## H;	\
+		};								\
+	}
+
+#define RAMSTART				0x2000
+#define RAMSIZE					0x2000
+#define RAMEND					0x3FFF
+#define E2END					0x07FF
+
+/*---------------------------------------------------------------------------------*/
+// CPU
+/*---------------------------------------------------------------------------------*/
+#define CPU_CCP					_SFR_MEM8(0x0034)
+#define CPU_RAMPD				_SFR_MEM8(0x0038)
+#define CPU_RAMPX				_SFR_MEM8(0x0039)
+#define CPU_RAMPY				_SFR_MEM8(0x003A)
+#define CPU_RAMPZ				_SFR_MEM8(0x003B)
+#define CPU_EIND				_SFR_MEM8(0x003C)
+#define CPU_SPL					_SFR_MEM8(0x003D)
+#define CPU_SPH					_SFR_MEM8(0x003E)
+#define CPU_SREG				_SFR_MEM8(0x003F)
+
+#define CCP						CPU_CCP
+#define RAMPD					CPU_RAMPD
+#define RAMPX					CPU_RAMPX
+#define RAMPY					CPU_RAMPY
+#define RAMPZ					CPU_RAMPZ
+#define EIND					CPU_EIND
+#define SPL						CPU_SPL
+#define SPH						CPU_SPH
+#define SP						_SFR_MEM16(0x003D)
+#define SREG					CPU_SREG
+
+#define CPU_I_bm				0x80
+
+typedef enum CCP_enum {
+	CCP_SPM_gc = (0x9D<<0),
+	CCP_IOREG_gc = (0xD8<<0),
+} CCP_t;
+
+/*---------------------------------------------------------------------------------*/
+// Clock system
+/*---------------------------------------------------------------------------------*/
+typedef struct CLK_struct {
+	register8_t CTRL;
+	register8_t PSCTRL;
+	register8_t LOCK;
+	register8_t RTCCTRL;
+	register8_t USBCTRL;
+} CLK_t;
+
+#define CLK_SCLKSEL_gm			0x07
+#define CLK_SCLKSEL_gp			0
+#define CLK_PSADIV_gm			0x7C
+#define CLK_PSADIV_gp			2
+#define CLK_PSBCDIV_gm			0x03
+#define CLK_PSBCDIV_gp			0
+#define CLK_LOCK_bm				0x01
+#define CLK_RTCSRC_gm			0x0E
+#define CLK_RTCEN_bm			0x01
+
+typedef enum CLK_SCLKSEL_enum {
+	CLK_SCLKSEL_RC2M_gc = (0x00<<0),
+	CLK_SCLKSEL_RC32M_gc = (0x01<<0),
+	CLK_SCLKSEL_RC32K_gc = (0x02<<0),
+	CLK_SCLKSEL_XOSC_gc = (0x03<<0),
+	CLK_SCLKSEL_PLL_gc = (0x04<<0),
+} CLK_SCLKSEL_t;
+
+typedef enum CLK_PSADIV_enum {
+	CLK_PSADIV_1_gc = (0x00<<2),
+	CLK_PSADIV_2_gc = (0x01<<2),
+	CLK_PSADIV_4_gc = (0x03<<2),
+	CLK_PSADIV_8_gc = (0x05<<2),
+	CLK_PSADIV_16_gc = (0x07<<2),
+	CLK_PSADIV_32_gc = (0x09<<2),
+	CLK_PSADIV_64_gc = (0x0B<<2),
+	CLK_PSADIV_128_gc = (0x0D<<2),
+	CLK_PSADIV_256_gc = (0x0F<<2),
+	CLK_PSADIV_512_gc = (0x11<<2),
+} CLK_PSADIV_t;
+
+typedef enum CLK_PSBCDIV_enum {
+	CLK_PSBCDIV_1_1_gc = (0x00<<0),
+	CLK_PSBCDIV_1_2_gc = (0x01<<0),
+	CLK_PSBCDIV_4_1_gc = (0x02<<0),
+	CLK_PSBCDIV_2_2_gc = (0x03<<0),
+} CLK_PSBCDIV_t;
+
+typedef enum CLK_RTCSRC_enum {
+	CLK_RTCSRC_ULP_gc = (0x00<<1),
+	CLK_RTCSRC_TOSC_gc = (0x01<<1),
+	CLK_RTCSRC_RCOSC_gc = (0x02<<1),
+	CLK_RTCSRC_TOSC32_gc = (0x05<<1),
+	CLK_RTCSRC_RCOSC32_gc = (0x06<<1),
+	CLK_RTCSRC_EXTCLK_gc = (0x07<<1),
+} CLK_RTCSRC_t;
+
+typedef struct SLEEP_struct {
+	register8_t CTRL;
+} SLEEP_t;
+
+#define SLEEP_SMODE_gm			0x0E
+#define SLEEP_SEN_bm			0x01
+
+typedef enum SLEEP_SMODE_enum {
+	SLEEP_SMODE_IDLE_gc = (0x00<<1),
+	SLEEP_SMODE_PDOWN_gc = (0x02<<1),
+	SLEEP_SMODE_PSAVE_gc = (0x03<<1),
+	SLEEP_SMODE_STDBY_gc = (0x06<<1),
+	SLEEP_SMODE_ESTDBY_gc = (0x07<<1),
+} SLEEP_SMODE_t;
+
+typedef struct OSC_struct {
+	register8_t CTRL;
+	register8_t STATUS;
+	register8_t XOSCCTRL;
+	register8_t XOSCFAIL;
+	register8_t RC32KCAL;
+	register8_t PLLCTRL;
+	register8_t DFLLCTRL;
+} OSC_t;
+
+#define OSC_PLLEN_bm			0x10
+#define OSC_XOSCEN_bm			0x08
+#define OSC_RC32KEN_bm			0x04
+#define OSC_RC32MEN_bm			0x02
+#define OSC_RC2MEN_bm			0x01
+#define OSC_PLLRDY_bm			0x10
+#define OSC_XOSCRDY_bm			0x08
+#define OSC_RC32KRDY_bm			0x04
+#define OSC_RC32MRDY_bm			0x02
+#define OSC_RC2MRDY_bm			0x01
+#define OSC_FRQRANGE_gm			0xC0
+#define OSC_X32KLPM_bm			0x20
+#define OSC_XOSCPWR_bm			0x10
+#define OSC_XOSCSEL_gm			0x0F
+#define OSC_XOSCFDIF_bm			0x02
+#define OSC_XOSCFDEN_bm			0x01
+#define OSC_PLLSRC_gm			0xC0
+#define OSC_PLLDIV_bm			0x20
+#define OSC_PLLFAC_gm			0x1F
+#define OSC_PLLFAC_gp			0
+#define OSC_RC32MCREF_gm		0x06
+#define OSC_RC32MCREF_bm		0x02
+#define OSC_RC2MCREF_bm			0x01
+
+typedef enum OSC_FRQRANGE_enum {
+	OSC_FRQRANGE_04TO2_gc = (0x00<<6),
+	OSC_FRQRANGE_2TO9_gc = (0x01<<6),
+	OSC_FRQRANGE_9TO12_gc = (0x02<<6),
+	OSC_FRQRANGE_12TO16_gc = (0x03<<6),
+} OSC_FRQRANGE_t;
+
+typedef enum OSC_XOSCSEL_enum {
+	OSC_XOSCSEL_EXTCLK_gc = (0x00<<0),
+	OSC_XOSCSEL_32KHz_gc = (0x02<<0),
+	OSC_XOSCSEL_XTAL_256CLK_gc = (0x03<<0),
+	OSC_XOSCSEL_XTAL_1KCLK_gc = (0x07<<0),
+	OSC_XOSCSEL_XTAL_16KCLK_gc = (0x0B<<0),
+} OSC_XOSCSEL_t;
+
+typedef enum OSC_PLLSRC_enum {
+	OSC_PLLSRC_RC2M_gc = (0x00<<6),
+	OSC_PLLSRC_RC32M_gc = (0x02<<6),
+	OSC_PLLSRC_XOSC_gc = (0x03<<6),
+} OSC_PLLSRC_t;
+
+typedef struct DFLL_struct {
+	register8_t CTRL;
+	register8_t reserved_0x01;
+	register8_t CALA;
+	register8_t CALB;
+	register8_t COMP0;
+	register8_t COMP1;
+	register8_t COMP2;
+	register8_t reserved_0x07;
+} DFLL_t;
+
+#define DFLL_ENABLE_bm			0x01
+
+typedef struct RST_struct {
+	register8_t STATUS;
+	register8_t CTRL;
+} RST_t;
+
+#define RST_SDRF_bm				0x40
+#define RST_SRF_bm				0x20
+#define RST_PDIRF_bm			0x10
+#define RST_WDRF_bm				0x08
+#define RST_BORF_bm				0x04
+#define RST_EXTRF_bm			0x02
+#define RST_PORF_bm				0x01
+#define RST_SWRST_bm			0x01
+
+/*---------------------------------------------------------------------------------*/
+// Interrupt controller and event system
+/*---------------------------------------------------------------------------------*/
+typedef struct PMIC_struct {
+	register8_t STATUS;
+	register8_t INTPRI;
+	register8_t CTRL;
+} PMIC_t;
+
+#define PMIC_NMIEX_bm			0x80
+#define PMIC_HILVLEX_bm			0x04
+#define PMIC_MEDLVLEX_bm		0x02
+#define PMIC_LOLVLEX_bm			0x01
+#define PMIC_RREN_bm			0x80
+#define PMIC_IVSEL_bm			0x40
+#define PMIC_HILVLEN_bm			0x04
+#define PMIC_MEDLVLEN_bm		0x02
+#define PMIC_LOLVLEN_bm			0x01
+
+typedef struct EVSYS_struct {
+	register8_t CH0MUX;
+	register8_t CH1MUX;
+	register8_t CH2MUX;
+	register8_t CH3MUX;
+	register8_t CH4MUX;
+	register8_t CH5MUX;
+	register8_t CH6MUX;
+	register8_t CH7MUX;
+	register8_t CH0CTRL;
+	register8_t CH1CTRL;
+	register8_t CH2CTRL;
+	register8_t CH3CTRL;
+	register8_t CH4CTRL;
+	register8_t CH5CTRL;
+	register8_t CH6CTRL;
+	register8_t CH7CTRL;
+	register8_t STROBE;
+	register8_t DATA;
+} EVSYS_t;
+
+typedef enum EVSYS_CHMUX_enum {
+	EVSYS_CHMUX_OFF_gc = (0x00<<0),
+	EVSYS_CHMUX_TCC0_OVF_gc = (0xC0<<0),
+	EVSYS_CHMUX_TCC1_OVF_gc = (0xC8<<0),
+	EVSYS_CHMUX_TCD0_OVF_gc = (0xD0<<0),
+	EVSYS_CHMUX_TCD1_OVF_gc = (0xD8<<0),
+	EVSYS_CHMUX_TCE0_OVF_gc = (0xE0<<0),
+	EVSYS_CHMUX_TCE1_OVF_gc = (0xE8<<0),
+	EVSYS_CHMUX_TCF0_OVF_gc = (0xF0<<0),
+} EVSYS_CHMUX_t;
+
+/*---------------------------------------------------------------------------------*/
+// I/O ports
+/*---------------------------------------------------------------------------------*/
+typedef struct PORTCFG_struct {
+	register8_t MPCMASK;
+	register8_t reserved_0x01;
+	register8_t VPCTRLA;
+	register8_t VPCTRLB;
+	register8_t CLKEVOUT;
+} PORTCFG_t;
+
+#define PORTCFG_VP0MAP_gm		0x0F
+#define PORTCFG_VP1MAP_gm		0xF0
+#define PORTCFG_VP2MAP_gm		0x0F
+#define PORTCFG_VP3MAP_gm		0xF0
+
+typedef enum PORTCFG_VP0MAP_enum {
+	PORTCFG_VP0MAP_PORTA_gc = (0x00<<0),
+	PORTCFG_VP0MAP_PORTB_gc = (0x01<<0),
+	PORTCFG_VP0MAP_PORTC_gc = (0x02<<0),
+	PORTCFG_VP0MAP_PORTD_gc = (0x03<<0),
+	PORTCFG_VP0MAP_PORTE_gc = (0x04<<0),
+	PORTCFG_VP0MAP_PORTF_gc = (0x05<<0),
+	PORTCFG_VP0MAP_PORTR_gc = (0x0F<<0),
+} PORTCFG_VP0MAP_t;
+
+typedef enum PORTCFG_VP1MAP_enum {
+	PORTCFG_VP1MAP_PORTA_gc = (0x00<<4),
+	PORTCFG_VP1MAP_PORTB_gc = (0x01<<4),
+	PORTCFG_VP1MAP_PORTC_gc = (0x02<<4),
+	PORTCFG_VP1MAP_PORTD_gc = (0x03<<4),
+	PORTCFG_VP1MAP_PORTE_gc = (0x04<<4),
+	PORTCFG_VP1MAP_PORTF_gc = (0x05<<4),
+	PORTCFG_VP1MAP_PORTR_gc = (0x0F<<4),
+} PORTCFG_VP1MAP_t;
+
+typedef enum PORTCFG_VP2MAP_enum {
+	PORTCFG_VP2MAP_PORTA_gc = (0x00<<0),
+	PORTCFG_VP2MAP_PORTB_gc = (0x01<<0),
+	PORTCFG_VP2MAP_PORTC_gc = (0x02<<0),
+	PORTCFG_VP2MAP_PORTD_gc = (0x03<<0),
+	PORTCFG_VP2MAP_PORTE_gc = (0x04<<0),
+	PORTCFG_VP2MAP_PORTF_gc = (0x05<<0),
+	PORTCFG_VP2MAP_PORTR_gc = (0x0F<<0),
+} PORTCFG_VP2MAP_t;
+
+typedef enum PORTCFG_VP3MAP_enum {
+	PORTCFG_VP3MAP_PORTA_gc = (0x00<<4),
+	PORTCFG_VP3MAP_PORTB_gc = (0x01<<4),
+	PORTCFG_VP3MAP_PORTC_gc = (0x02<<4),
+	PORTCFG_VP3MAP_PORTD_gc = (0x03<<4),
+	PORTCFG_VP3MAP_PORTE_gc = (0x04<<4),
+	PORTCFG_VP3MAP_PORTF_gc = (0x05<<4),
+	PORTCFG_VP3MAP_PORTR_gc = (0x0F<<4),
+} PORTCFG_VP3MAP_t;
+
+typedef struct VPORT_struct {
+	register8_t DIR;
+	register8_t OUT;
+	register8_t IN;
+	register8_t INTFLAGS;
+} VPORT_t;
+
+typedef struct PORT_struct {
+	register8_t DIR;
+	register8_t DIRSET;
+	register8_t DIRCLR;
+	register8_t DIRTGL;
+	register8_t OUT;
+	register8_t OUTSET;
+	register8_t OUTCLR;
+	register8_t OUTTGL;
+	register8_t IN;
+	register8_t INTCTRL;
+	register8_t INT0MASK;
+	register8_t INT1MASK;
+	register8_t INTFLAGS;
+	register8_t reserved_0x0D;
+	register8_t REMAP;
+	register8_t reserved_0x0F;
+	register8_t PIN0CTRL;
+	register8_t PIN1CTRL;
+	register8_t PIN2CTRL;
+	register8_t PIN3CTRL;
+	register8_t PIN4CTRL;
+	register8_t PIN5CTRL;
+	register8_t PIN6CTRL;
+	register8_t PIN7CTRL;
+} PORT_t;
+
+#define PIN0_bm					0x01
+#define PIN1_bm					0x02
+#define PIN2_bm					0x04
+#define PIN3_bm					0x08
+#define PIN4_bm					0x10
+#define PIN5_bm					0x20
+#define PIN6_bm					0x40
+#define PIN7_bm					0x80
+
+#define PORT_INT1LVL_gm			0x0C
+#define PORT_INT0LVL_gm			0x03
+#define PORT_INT1IF_bm			0x02
+#define PORT_INT0IF_bm			0x01
+#define PORT_SRLEN_bm			0x80
+#define PORT_INVEN_bm			0x40
+#define PORT_OPC_gm				0x38
+#define PORT_ISC_gm				0x07
+
+typedef enum PORT_INT0LVL_enum {
+	PORT_INT0LVL_OFF_gc = (0x00<<0),
+	PORT_INT0LVL_LO_gc = (0x01<<0),
+	PORT_INT0LVL_MED_gc = (0x02<<0),
+	PORT_INT0LVL_HI_gc = (0x03<<0),
+} PORT_INT0LVL_t;
+
+typedef enum PORT_INT1LVL_enum {
+	PORT_INT1LVL_OFF_gc = (0x00<<2),
+	PORT_INT1LVL_LO_gc = (0x01<<2),
+	PORT_INT1LVL_MED_gc = (0x02<<2),
+	PORT_INT1LVL_HI_gc = (0x03<<2),
+} PORT_INT1LVL_t;
+
+typedef enum PORT_OPC_enum {
+	PORT_OPC_TOTEM_gc = (0x00<<3),
+	PORT_OPC_BUSKEEPER_gc = (0x01<<3),
+	PORT_OPC_PULLDOWN_gc = (0x02<<3),
+	PORT_OPC_PULLUP_gc = (0x03<<3),
+	PORT_OPC_WIREDOR_gc = (0x04<<3),
+	PORT_OPC_WIREDAND_gc = (0x05<<3),
+	PORT_OPC_WIREDORPULL_gc = (0x06<<3),
+	PORT_OPC_WIREDANDPULL_gc = (0x07<<3),
+} PORT_OPC_t;
+
+typedef enum PORT_ISC_enum {
+	PORT_ISC_BOTHEDGES_gc = (0x00<<0),
+	PORT_ISC_RISING_gc = (0x01<<0),
+	PORT_ISC_FALLING_gc = (0x02<<0),
+	PORT_ISC_LEVEL_gc = (0x03<<0),
+	PORT_ISC_INPUT_DISABLE_gc = (0x07<<0),
+} PORT_ISC_t;
+
+/*---------------------------------------------------------------------------------*/
+// Timer/counter
+/*---------------------------------------------------------------------------------*/
+typedef struct TC0_struct {
+	register8_t CTRLA;
+	register8_t CTRLB;
+	register8_t CTRLC;
+	register8_t CTRLD;
+	register8_t CTRLE;
+	register8_t reserved_0x05;
+	register8_t INTCTRLA;
+	register8_t INTCTRLB;
+	register8_t CTRLFCLR;
+	register8_t CTRLFSET;
+	register8_t CTRLGCLR;
+	register8_t CTRLGSET;
+	register8_t INTFLAGS;
+	register8_t reserved_0x0D;
+	register8_t reserved_0x0E;
+	register8_t TEMP;
+	register8_t reserved_0x10[0x10];
+	_WORDREGISTER(CNT);
+	register8_t reserved_0x22[4];
+	_WORDREGISTER(PER);
+	_WORDREGISTER(CCA);
+	_WORDREGISTER(CCB);
+	_WORDREGISTER(CCC);
+	_WORDREGISTER(CCD);
+	register8_t reserved_0x30[6];
+	_WORDREGISTER(PERBUF);
+	_WORDREGISTER(CCABUF);
+	_WORDREGISTER(CCBBUF);
+	_WORDREGISTER(CCCBUF);
+	_WORDREGISTER(CCDBUF);
+} TC0_t;
+
+typedef struct TC1_struct {
+	register8_t CTRLA;
+	register8_t CTRLB;
+	register8_t CTRLC;
+	register8_t CTRLD;
+	register8_t CTRLE;
+	register8_t reserved_0x05;
+	register8_t INTCTRLA;
+	register8_t INTCTRLB;
+	register8_t CTRLFCLR;
+	register8_t CTRLFSET;
+	register8_t CTRLGCLR;
+	register8_t CTRLGSET;
+	register8_t INTFLAGS;
+	register8_t reserved_0x0D;
+	register8_t reserved_0x0E;
+	register8_t TEMP;
+	register8_t reserved_0x10[0x10];
+	_WORDREGISTER(CNT);
+	register8_t reserved_0x22[4];
+	_WORDREGISTER(PER);
+	_WORDREGISTER(CCA);
+	_WORDREGISTER(CCB);
+	register8_t reserved_0x2C[0x0A];
+	_WORDREGISTER(PERBUF);
+	_WORDREGISTER(CCABUF);
+	_WORDREGISTER(CCBBUF);
+} TC1_t;
+
+#define TC0_CLKSEL_gm			0x0F
+#define TC0_CCDEN_bm			0x80
+#define TC0_CCCEN_bm			0x40
+#define TC0_CCBEN_bm			0x20
+#define TC0_CCAEN_bm			0x10
+#define TC0_WGMODE_gm			0x07
+#define TC0_EVACT_gm			0xE0
+#define TC0_EVDLY_bm			0x10
+#define TC0_EVSEL_gm			0x0F
+#define TC0_BYTEM_bm			0x01
+#define TC0_ERRINTLVL_gm		0x0C
+#define TC0_OVFINTLVL_gm		0x03
+#define TC0_CCDINTLVL_gm		0xC0
+#define TC0_CCCINTLVL_gm		0x30
+#define TC0_CCBINTLVL_gm		0x0C
+#define TC0_CCAINTLVL_gm		0x03
+#define TC0_CMD_gm				0x0C
+#define TC0_LUPD_bm				0x02
+#define TC0_DIR_bm				0x01
+#define TC0_CCDBV_bm			0x10
+#define TC0_CCCBV_bm			0x08
+#define TC0_CCBBV_bm			0x04
+#define TC0_CCABV_bm			0x02
+#define TC0_PERBV_bm			0x01
+#define TC0_CCDIF_bm			0x80
+#define TC0_CCCIF_bm			0x40
+#define TC0_CCBIF_bm			0x20
+#define TC0_CCAIF_bm			0x10
+#define TC0_ERRIF_bm			0x02
+#define TC0_OVFIF_bm			0x01
+
+#define TC1_CLKSEL_gm			0x0F
+#define TC1_CCBEN_bm			0x20
+#define TC1_CCAEN_bm			0x10
+#define TC1_WGMODE_gm			0x07
+#define TC1_EVACT_gm			0xE0
+#define TC1_EVDLY_bm			0x10
+#define TC1_EVSEL_gm			0x0F
+#define TC1_BYTEM_bm			0x01
+#define TC1_ERRINTLVL_gm		0x0C
+#define TC1_OVFINTLVL_gm		0x03
+#define TC1_CCBINTLVL_gm		0x0C
+#define TC1_CCAINTLVL_gm		0x03
+#define TC1_CMD_gm				0x0C
+#define TC1_LUPD_bm				0x02
+#define TC1_DIR_bm				0x01
+#define TC1_CCBBV_bm			0x04
+#define TC1_CCABV_bm			0x02
+#define TC1_PERBV_bm			0x01
+#define TC1_CCBIF_bm			0x20
+#define TC1_CCAIF_bm			0x10
+#define TC1_ERRIF_bm			0x02
+#define TC1_OVFIF_bm			0x01
+
+typedef enum TC_CLKSEL_enum {
+	TC_CLKSEL_OFF_gc = (0x00<<0),
+	TC_CLKSEL_DIV1_gc = (0x01<<0),
+	TC_CLKSEL_DIV2_gc = (0x02<<0),
+	TC_CLKSEL_DIV4_gc = (0x03<<0),
+	TC_CLKSEL_DIV8_gc = (0x04<<0),
+	TC_CLKSEL_DIV64_gc = (0x05<<0),
+	TC_CLKSEL_DIV256_gc = (0x06<<0),
+	TC_CLKSEL_DIV1024_gc = (0x07<<0),
+	TC_CLKSEL_EVCH0_gc = (0x08<<0),
+	TC_CLKSEL_EVCH1_gc = (0x09<<0),
+	TC_CLKSEL_EVCH2_gc = (0x0A<<0),
+	TC_CLKSEL_EVCH3_gc = (0x0B<<0),
+	TC_CLKSEL_EVCH4_gc = (0x0C<<0),
+	TC_CLKSEL_EVCH5_gc = (0x0D<<0),
+	TC_CLKSEL_EVCH6_gc = (0x0E<<0),
+	TC_CLKSEL_EVCH7_gc = (0x0F<<0),
+} TC_CLKSEL_t;
+
+typedef enum TC_WGMODE_enum {
+	TC_WGMODE_NORMAL_gc = (0x00<<0),
+	TC_WGMODE_FRQ_gc = (0x01<<0),
+	TC_WGMODE_SS_gc = (0x03<<0),
+	TC_WGMODE_DS_T_gc = (0x05<<0),
+	TC_WGMODE_DS_TB_gc = (0x06<<0),
+	TC_WGMODE_DS_B_gc = (0x07<<0),
+} TC_WGMODE_t;
+
+typedef enum TC_EVACT_enum {
+	TC_EVACT_OFF_gc = (0x00<<5),
+	TC_EVACT_CAPT_gc = (0x01<<5),
+	TC_EVACT_UPDOWN_gc = (0x02<<5),
+	TC_EVACT_QDEC_gc = (0x03<<5),
+	TC_EVACT_RESTART_gc = (0x04<<5),
+	TC_EVACT_FRQ_gc = (0x05<<5),
+	TC_EVACT_PW_gc = (0x06<<5),
+} TC_EVACT_t;
+
+typedef enum TC_EVSEL_enum {
+	TC_EVSEL_OFF_gc = (0x00<<0),
+	TC_EVSEL_CH0_gc = (0x08<<0),
+	TC_EVSEL_CH1_gc = (0x09<<0),
+	TC_EVSEL_CH2_gc = (0x0A<<0),
+	TC_EVSEL_CH3_gc = (0x0B<<0),
+	TC_EVSEL_CH4_gc = (0x0C<<0),
+	TC_EVSEL_CH5_gc = (0x0D<<0),
+	TC_EVSEL_CH6_gc = (0x0E<<0),
+	TC_EVSEL_CH7_gc = (0x0F<<0),
+} TC_EVSEL_t;
+
+typedef enum TC_ERRINTLVL_enum {
+	TC_ERRINTLVL_OFF_gc = (0x00<<2),
+	TC_ERRINTLVL_LO_gc = (0x01<<2),
+	TC_ERRINTLVL_MED_gc = (0x02<<2),
+	TC_ERRINTLVL_HI_gc = (0x03<<2),
+} TC_ERRINTLVL_t;
+
+typedef enum TC_OVFINTLVL_enum {
+	TC_OVFINTLVL_OFF_gc = (0x00<<0),
+	TC_OVFINTLVL_LO_gc = (0x01<<0),
+	TC_OVFINTLVL_MED_gc = (0x02<<0),
+	TC_OVFINTLVL_HI_gc = (0x03<<0),
+} TC_OVFINTLVL_t;
+
+typedef enum TC_CCAINTLVL_enum {
+	TC_CCAINTLVL_OFF_gc = (0x00<<0),
+	TC_CCAINTLVL_LO_gc = (0x01<<0),
+	TC_CCAINTLVL_MED_gc = (0x02<<0),
+	TC_CCAINTLVL_HI_gc = (0x03<<0),
+} TC_CCAINTLVL_t;
+
+typedef enum TC_CCBINTLVL_enum {
+	TC_CCBINTLVL_OFF_gc = (0x00<<2),
+	TC_CCBINTLVL_LO_gc = (0x01<<2),
+	TC_CCBINTLVL_MED_gc = (0x02<<2),
+	TC_CCBINTLVL_HI_gc = (0x03<<2),
+} TC_CCBINTLVL_t;
+
+typedef enum TC_CCCINTLVL_enum {
+	TC_CCCINTLVL_OFF_gc = (0x00<<4),
+	TC_CCCINTLVL_LO_gc = (0x01<<4),
+	TC_CCCINTLVL_MED_gc = (0x02<<4),
+	TC_CCCINTLVL_HI_gc = (0x03<<4),
+} TC_CCCINTLVL_t;
+
+typedef enum TC_CCDINTLVL_enum {
+	TC_CCDINTLVL_OFF_gc = (0x00<<6),
+	TC_CCDINTLVL_LO_gc = (0x01<<6),
+	TC_CCDINTLVL_MED_gc = (0x02<<6),
+	TC_CCDINTLVL_HI_gc = (0x03<<6),
+} TC_CCDINTLVL_t;
+
+typedef enum TC_CMD_enum {
+	TC_CMD_NONE_gc = (0x00<<2),
+	TC_CMD_UPDATE_gc = (0x01<<2),
+	TC_CMD_RESTART_gc = (0x02<<2),
+	TC_CMD_RESET_gc = (0x03<<2),
+} TC_CMD_t;
+
+/*---------------------------------------------------------------------------------*/
+// USART
+/*---------------------------------------------------------------------------------*/
+typedef struct USART_struct {
+	register8_t DATA;
+	register8_t STATUS;
+	register8_t reserved_0x02;
+	register8_t CTRLA;
+	register8_t CTRLB;
+	register8_t CTRLC;
+	register8_t BAUDCTRLA;
+	register8_t BAUDCTRLB;
+} USART_t;
+
+#define USART_RXCIF_bm			0x80
+#define USART_TXCIF_bm			0x40
+#define USART_DREIF_bm			0x20
+#define USART_FERR_bm			0x10
+#define USART_BUFOVF_bm			0x08
+#define USART_PERR_bm			0x04
+#define USART_RXB8_bm			0x01
+#define USART_RXCINTLVL_gm		0x30
+#define USART_TXCINTLVL_gm		0x0C
+#define USART_DREINTLVL_gm		0x03
+#define USART_RXEN_bm			0x10
+#define USART_TXEN_bm			0x08
+#define USART_CLK2X_bm			0x04
+#define USART_CMODE_gm			0xC0
+#define USART_PMODE_gm			0x30
+#define USART_SBMODE_bm			0x08
+#define USART_CHSIZE_gm			0x07
+#define USART_BSCALE_gm			0xF0
+#define USART_BSCALE_gp			4
+
+typedef enum USART_CMODE_enum {
+	USART_CMODE_ASYNCHRONOUS_gc = (0x00<<6),
+	USART_CMODE_SYNCHRONOUS_gc = (0x01<<6),
+} USART_CMODE_t;
+
+typedef enum USART_PMODE_enum {
+	USART_PMODE_DISABLED_gc = (0x00<<4),
+	USART_PMODE_EVEN_gc = (0x02<<4),
+	USART_PMODE_ODD_gc = (0x03<<4),
+} USART_PMODE_t;
+
+typedef enum USART_CHSIZE_enum {
+	USART_CHSIZE_5BIT_gc = (0x00<<0),
+	USART_CHSIZE_6BIT_gc = (0x01<<0),
+	USART_CHSIZE_7BIT_gc = (0x02<<0),
+	USART_CHSIZE_8BIT_gc = (0x03<<0),
+	USART_CHSIZE_9BIT_gc = (0x07<<0),
+} USART_CHSIZE_t;
+
+/*---------------------------------------------------------------------------------*/
+// Instances (ATxmega128A3U I/O map)
+/*---------------------------------------------------------------------------------*/
+#define VPORT0					(*(VPORT_t *) &mockIo[0x0010])
+#define VPORT1					(*(VPORT_t *) &mockIo[0x0014])
+#define VPORT2					(*(VPORT_t *) &mockIo[0x0018])
+#define VPORT3					(*(VPORT_t *) &mockIo[0x001C])
+#define CLK						(*(CLK_t *) &mockIo[0x0040])
+#define SLEEP					(*(SLEEP_t *) &mockIo[0x0048])
+#define OSC						(*(OSC_t *) &mockIo[0x0050])
+#define DFLLRC32M				(*(DFLL_t *) &mockIo[0x0060])
+#define DFLLRC2M				(*(DFLL_t *) &mockIo[0x0068])
+#define RST						(*(RST_t *) &mockIo[0x0078])
+#define PMIC					(*(PMIC_t *) &mockIo[0x00A0])
+#define PORTCFG					(*(PORTCFG_t *) &mockIo[0x00B0])
+#define EVSYS					(*(EVSYS_t *) &mockIo[0x0180])
+#define PORTA					(*(PORT_t *) &mockIo[0x0600])
+#define PORTB					(*(PORT_t *) &mockIo[0x0620])
+#define PORTC					(*(PORT_t *) &mockIo[0x0640])
+#define PORTD					(*(PORT_t *) &mockIo[0x0660])
+#define PORTE					(*(PORT_t *) &mockIo[0x0680])
+#define PORTF					(*(PORT_t *) &mockIo[0x06A0])
+#define PORTR					(*(PORT_t *) &mockIo[0x07E0])
+#define TCC0					(*(TC0_t *) &mockIo[0x0800])
+#define TCC1					(*(TC1_t *) &mockIo[0x0840])
+#define USARTC0					(*(USART_t *) &mockIo[0x08A0])
+#define USARTC1					(*(USART_t *) &mockIo[0x08B0])
+#define TCD0					(*(TC0_t *) &mockIo[0x0900])
+#define TCD1					(*(TC1_t *) &mockIo[0x0940])
+#define USARTD0					(*(USART_t *) &mockIo[0x09A0])
+#define USARTD1					(*(USART_t *) &mockIo[0x09B0])
+#define TCE0					(*(TC0_t *) &mockIo[0x0A00])
+#define TCE1					(*(TC1_t *) &mockIo[0x0A40])
+#define USARTE0					(*(USART_t *) &mockIo[0x0AA0])
+#define TCF0					(*(TC0_t *) &mockIo[0x0B00])
+#define USARTF0					(*(USART_t *) &mockIo[0x0BA0])
+
+#include "mockHal.h"
+
+#endif /* MOCK_AVR_IO_H_ */
@@ -0,0 +1,30 @@
+/*
+ * pgmspace.h
+ *
+ * Created: 19.10.2026 03:48:14
+ *  Author: agent
+ *
+ * Host replacement of <avr/pgmspace.h>, flash is ordinary memory on the host.
+ */
+
+
+#ifndef MOCK_AVR_PGMSPACE_H_
+#define MOCK_AVR_PGMSPACE_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#define PROGMEM
+#define PGM_P						const char *
+#define PSTR(s)						(s)
+#define pgm_read_byte(address)		(*(const uint8_t *) (address))
+#define pgm_read_word(address)		(*(const uint16_t *) (address))
+#define pgm_read_dword(address)		(*(const uint32_t *) (address))
+#define pgm_read_float(address)		(*(const float *) (address))
+#define pgm_read_ptr(address)		(*(void * const *) (address))
+#define memcpy_P					memcpy
+#define strcpy_P					strcpy
+#define strlen_P					strlen
+#define strcmp_P					strcmp
+
+#endif /* MOCK_AVR_PGMSPACE_H_ */
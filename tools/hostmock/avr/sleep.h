@@ -0,0 +1,23 @@
+/*
+ * sleep.h
+ *
+ * Created: 19.10.2026 03:48:14
+ *  Author: agent
+ *
+ * Host replacement of <avr/sleep.h>, see mockHal.h. sleep_cpu() runs the
+ * virtual clock until an interrupt has been served.
+ */
+
+
+#ifndef MOCK_AVR_SLEEP_H_
+#define MOCK_AVR_SLEEP_H_
+
+#include "avr/io.h"
+
+#define set_sleep_mode(mode)	(SLEEP.CTRL = (SLEEP.CTRL & ~SLEEP_SMODE_gm) | (mode))
+#define sleep_enable()			(SLEEP.CTRL |= SLEEP_SEN_bm)
+#define sleep_disable()			(SLEEP.CTRL &= ~SLEEP_SEN_bm)
+#define sleep_cpu()				vMockSleep()
+#define sleep_mode()			do { sleep_enable(); sleep_cpu(); sleep_disable(); } while(0)
+
+#endif /* MOCK_AVR_SLEEP_H_ */
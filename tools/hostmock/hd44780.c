@@ -0,0 +1,188 @@
+/*
+ * hd44780.c
+ *
+ * Created: 19.10.2026 05:06:57
+ *  Author: agent
+ *
+ * HD44780 model on the pin hook of the mock, see hd44780.h.
+ */
+#include <string.h>
+#include "mockHal.h"
+#include "hd44780.h"
+
+typedef struct {
+	uint8_t ddram[128];
+	uint8_t address;
+	uint8_t increment;
+	uint8_t cgram;
+	uint8_t fourBit;
+	uint8_t high;			//first nibble of a 4 bit transfer
+	uint8_t haveHigh;
+	uint8_t initCount;		//8 bit function sets seen
+	uint8_t control;		//PORTD levels
+	uint64_t readyNS;
+	uint32_t violations;
+	uint8_t stuck;			//busy on every read
+	uint8_t polling;		//busy flag reads since the last write
+	uint64_t pollStartNS;
+	uint64_t pollLastNS;
+	uint64_t longestPollNS;
+	uint32_t polls;
+} hd44780_t;
+
+static const uint8_t lineAddress[4] = {0x00, 0x40, 0x14, 0x54};
+
+static hd44780_t lcd;
+static hd44780ViolationHook_t violationHook = NULL;
+
+static void prvAdvance(void) {
+	if(lcd.increment) {
+		lcd.address = lcd.address == 0x27 ? 0x40 : lcd.address == 0x67 ? 0x00 : lcd.address + 1;
+	} else {
+		lcd.address = lcd.address == 0x40 ? 0x27 : lcd.address == 0x00 ? 0x67 : lcd.address - 1;
+	}
+}
+
+static void prvExecute(uint8_t rs, uint8_t value, uint64_t timeNS) {
+	uint64_t duration = HD44780_EXEC_COMMAND;
+
+	if(timeNS < lcd.readyNS) {
+		lcd.violations++;
+		if(violationHook != NULL) {
+			violationHook(rs, value, lcd.readyNS - timeNS, timeNS);
+		}
+	}
+	if(rs) {
+		if(!lcd.cgram) {
+			lcd.ddram[lcd.address & 0x7F] = value;
+			prvAdvance();
+		}
+		duration = HD44780_EXEC_DATA;
+	} else if(value == 0x01) {
+		memset(lcd.ddram, ' ', sizeof(lcd.ddram));
+		lcd.address = 0;
+		lcd.increment = 1;
+		lcd.cgram = 0;
+		duration = HD44780_EXEC_CLEAR;
+	} else if((value & 0xFE) == 0x02) {
+		lcd.address = 0;
+		lcd.cgram = 0;
+		duration = HD44780_EXEC_CLEAR;
+	} else if(value & 0x80) {
+		lcd.address = value & 0x7F;
+		lcd.cgram = 0;
+	} else if(value & 0x40) {
+		lcd.cgram = 1;
+	} else if(value & 0x20) {
+		lcd.fourBit = !(value & 0x10);
+	} else if((value & 0xFC) == 0x04) {
+		lcd.increment = (value & 0x02) != 0;
+	}
+	lcd.readyNS = timeNS + duration;
+}
+
+// Falling edge of E
+static void prvLatch(uint8_t nibble, uint64_t timeNS) {
+	uint8_t rs = (lcd.control & HD44780_RS) != 0;
+	uint8_t value;
+
+	if(lcd.control & HD44780_RW) {
+		// busy flag read, 2 nibbles in 4 bit mode
+		if(lcd.fourBit) {
+			lcd.haveHigh = !lcd.haveHigh;
+		}
+		if(!lcd.polling) {
+			lcd.polling = 1;
+			lcd.pollStartNS = timeNS;
+		}
+		lcd.pollLastNS = timeNS;
+		return;
+	}
+	if(lcd.polling) {
+		lcd.polling = 0;
+		lcd.polls++;
+		if(lcd.pollLastNS - lcd.pollStartNS > lcd.longestPollNS) {
+			lcd.longestPollNS = lcd.pollLastNS - lcd.pollStartNS;
+		}
+	}
+	if(!lcd.fourBit) {
+		// 8 bit mode after reset: DB3..0 are not connected, each nibble is an instruction
+		value = nibble << 4;
+		prvExecute(rs, value, timeNS);
+		if(!rs && value == 0x30) {
+			lcd.initCount++;
+			if(lcd.initCount == 1) {
+				lcd.readyNS = timeNS + HD44780_EXEC_INIT1;
+			} else if(lcd.initCount == 2) {
+				lcd.readyNS = timeNS + HD44780_EXEC_INIT2;
+			}
+		}
+		return;
+	}
+	if(!lcd.haveHigh) {
+		lcd.high = nibble;
+		lcd.haveHigh = 1;
+		return;
+	}
+	lcd.haveHigh = 0;
+	prvExecute(rs, (lcd.high << 4) | nibble, timeNS);
+}
+
+static void prvPinHook(const mockPinEvent_t *event) {
+	if(event->port != HD44780_PORT_CTRL) {
+		return;
+	}
+	if((event->changed & HD44780_E) && !(event->levels & HD44780_E)) {
+		prvLatch(ucMockPinLevels(HD44780_PORT_DATA) >> 4, event->timeNS);
+		vMockPinRelease(HD44780_PORT_DATA, HD44780_DB7);
+	}
+	lcd.control = event->levels;
+	if((lcd.control & (HD44780_RW | HD44780_E)) == (HD44780_RW | HD44780_E) && !(lcd.control & HD44780_RS)
+			&& !lcd.haveHigh) {
+		// busy flag on DB7 while the controller executes
+		vMockPinDrive(HD44780_PORT_DATA, HD44780_DB7,
+			lcd.stuck || event->timeNS < lcd.readyNS ? HD44780_DB7 : 0);
+	}
+}
+
+void vHd44780Reset(void) {
+	memset(&lcd, 0, sizeof(lcd));
+	memset(lcd.ddram, ' ', sizeof(lcd.ddram));
+	lcd.increment = 1;
+	vMockPinHook(prvPinHook);
+}
+
+void vHd44780ViolationHook(hd44780ViolationHook_t hook) {
+	violationHook = hook;
+}
+
+void vHd44780Text(uint8_t line, char *text) {
+	for(uint8_t i = 0; i < 20; i++) {
+		uint8_t c = lcd.ddram[lineAddress[line & 0x03] + i];
+		text[i] = c >= 0x20 && c < 0x7F ? c : '?';
+	}
+	text[20] = '\0';
+}
+
+uint32_t ulHd44780Violations(void) {
+	return lcd.violations;
+}
+
+uint8_t ucHd44780Address(void) {
+	return lcd.address;
+}
+
+void vHd44780Stuck(uint8_t stuck) {
+	lcd.stuck = stuck;
+}
+
+uint32_t ulHd44780Polls(uint64_t *longestNS) {
+	*longestNS = lcd.longestPollNS;
+	return lcd.polls;
+}
+
+void vHd44780PollClear(void) {
+	lcd.polls = 0;
+	lcd.longestPollNS = 0;
+}
+// EOF file hd44780.c
@@ -0,0 +1,56 @@
+/*
+ * hd44780.h
+ *
+ * Created: 19.10.2026 05:06:57
+ *  Author: agent
+ *
+ * HD44780 (ST7066U of the NHD-0420) on the pins of the register mock, wired
+ * like NHD0420Hal.h: DB7..4 = PA7..4, RS = PD0, RW = PD1, E = PD2. The display
+ * driver runs unchanged on top of it, in tools/hostsim and in
+ * tools/tests/test_hd44780.c. Same model as tools/hd44780emu.py, which replays
+ * a capture of the board instead.
+ *
+ * Every falling edge of E latches a nibble: the 8 bit function sets after
+ * power-on, then 4 bit transfers. The DDRAM follows the commands and data,
+ * every instruction latched before the previous one was executed counts as a
+ * violation and goes to the violation hook. While RW and E are high the busy
+ * flag is driven on DB7. Execution times are the datasheet values at 270kHz.
+ *
+ * Limits: CGRAM writes, display shift and the read of data are not modelled,
+ * the address counter is not driven on DB6..4.
+ */
+
+
+#ifndef HD44780_H_
+#define HD44780_H_
+
+#include <stdint.h>
+#include "mockHal.h"
+
+#define HD44780_PORT_DATA		MOCK_PORTA	//DB7..4 on PA7..4
+#define HD44780_PORT_CTRL		MOCK_PORTD
+#define HD44780_RS				0x01	//PD0
+#define HD44780_RW				0x02	//PD1
+#define HD44780_E				0x04	//PD2
+#define HD44780_DB7				0x80
+
+// Execution times in ns, as tools/hd44780emu.py
+#define HD44780_EXEC_CLEAR		1520000ULL	//clear display, return home
+#define HD44780_EXEC_COMMAND	37000ULL	//all other instructions
+#define HD44780_EXEC_DATA		41000ULL	//write data incl. tADD
+#define HD44780_EXEC_INIT1		4100000ULL	//after the first 8 bit function set
+#define HD44780_EXEC_INIT2		100000ULL	//after the second 8 bit function set
+
+// rs 1: data, earlyNS is the rest of the execution time of the previous instruction
+typedef void (*hd44780ViolationHook_t)(uint8_t rs, uint8_t value, uint64_t earlyNS, uint64_t timeNS);
+
+void vHd44780Reset(void);						//power-on state, blank DDRAM, attaches the pin hook of the mock
+void vHd44780ViolationHook(hd44780ViolationHook_t hook);
+void vHd44780Text(uint8_t line, char *text);	//line 0..3, 20 characters and '\0', '?' for the others
+uint32_t ulHd44780Violations(void);				//since the reset
+uint8_t ucHd44780Address(void);					//DDRAM address counter
+void vHd44780Stuck(uint8_t stuck);				//1: busy on every busy flag read
+uint32_t ulHd44780Polls(uint64_t *longestNS);	//busy flag polls (first to last read before a write) and the longest
+void vHd44780PollClear(void);
+
+#endif /* HD44780_H_ */
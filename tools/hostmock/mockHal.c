@@ -0,0 +1,1443 @@
+/*
+ * mockHal.c
+ *
+ * Created: 19.10.2026 03:48:14
+ *  Author: agent
+ *
+ * Peripheral models of the host mock, see mockHal.h.
+ *
+ * The firmware reads and writes mockIo like plain memory. shadow holds what
+ * the mock published there at the last tick, so every byte that differs from
+ * it was written by the firmware since. prvApply() hands these bytes to the
+ * models in address order, the models then update mockIo to what a read
+ * returns: strobe registers (OUTSET, CTRLFSET, CCP, ...) read 0, registers
+ * with flags cleared by writing one keep a reserved marker bit set, so the
+ * write of a single flag changes the byte and is seen.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "avr/io.h"
+
+#define MOCK_NEVER				UINT64_MAX
+#define MOCK_TIMER_COUNT		7
+#define MOCK_CCP_CYCLES			4
+#define MOCK_POLL_CYCLES		4		//lds, sbrs, rjmp and the nop of a polling loop
+#define MOCK_SYNC_BLOCK			64		//bytes compared at once by prvApply()
+
+// Reserved bits of the registers with flags cleared by writing one
+#define MOCK_MARK_TC			0x08	//TCxn.INTFLAGS
+#define MOCK_MARK_PORT			0x80	//PORTx.INTFLAGS, VPORTn.INTFLAGS
+#define MOCK_MARK_USART			0x02	//USARTxn.STATUS
+#define MOCK_MARK_RST			0x80	//RST.STATUS
+#define MOCK_MARK_XOSCFAIL		0x80	//OSC.XOSCFAIL
+
+typedef enum {
+	SOURCE_TC_OVF,
+	SOURCE_TC_ERR,
+	SOURCE_TC_CC,
+	SOURCE_PORT,
+	SOURCE_USART_RXC,
+	SOURCE_USART_DRE,
+	SOURCE_USART_TXC,
+} mockSourceKind_t;
+
+typedef struct {
+	void (*handler)(void);
+	const char *name;
+	uint8_t kind;
+	uint8_t unit;			//timer, port or USART index
+	uint8_t channel;		//CCx or INTn
+} mockSource_t;
+
+typedef struct {
+	uint16_t address;
+	uint8_t ccCount;
+	uint8_t eventMux;		//EVSYS.CHnMUX value of the overflow
+} mockTimerInfo_t;
+
+typedef struct {
+	uint32_t prescaler;		//clkPER cycles towards the next tick
+	uint64_t overflows;
+	uint8_t ctrlf;
+	uint8_t ctrlg;
+} mockTimer_t;
+
+typedef struct {
+	uint8_t pins;			//levels on the pins
+	uint8_t extMask;		//pins driven from outside
+	uint8_t extLevels;
+} mockPort_t;
+
+typedef struct {
+	uint64_t shiftDoneNS;
+	uint8_t shifting;
+	uint8_t buffered;
+	uint8_t buffer;
+	uint8_t rxCount;
+	uint8_t rx[2];
+} mockUart_t;
+
+// Interrupt sources in vector order, the order decides within a level
+#define MOCK_TIMER_VECTORS0(tc, unit)																		\
+	X(tc ## _OVF_vect, SOURCE_TC_OVF, unit, 0) X(tc ## _ERR_vect, SOURCE_TC_ERR, unit, 0)					\
+	X(tc ## _CCA_vect, SOURCE_TC_CC, unit, 0) X(tc ## _CCB_vect, SOURCE_TC_CC, unit, 1)					\
+	X(tc ## _CCC_vect, SOURCE_TC_CC, unit, 2) X(tc ## _CCD_vect, SOURCE_TC_CC, unit, 3)
+#define MOCK_TIMER_VECTORS1(tc, unit)																		\
+	X(tc ## _OVF_vect, SOURCE_TC_OVF, unit, 0) X(tc ## _ERR_vect, SOURCE_TC_ERR, unit, 0)					\
+	X(tc ## _CCA_vect, SOURCE_TC_CC, unit, 0) X(tc ## _CCB_vect, SOURCE_TC_CC, unit, 1)
+#define MOCK_PORT_VECTORS(port, unit)																		\
+	X(port ## _INT0_vect, SOURCE_PORT, unit, 0) X(port ## _INT1_vect, SOURCE_PORT, unit, 1)
+#define MOCK_USART_VECTORS(usart, unit)																		\
+	X(usart ## _RXC_vect, SOURCE_USART_RXC, unit, 0) X(usart ## _DRE_vect, SOURCE_USART_DRE, unit, 0)		\
+	X(usart ## _TXC_vect, SOURCE_USART_TXC, unit, 0)
+#define MOCK_VECTORS																						\
+	MOCK_PORT_VECTORS(PORTC, MOCK_PORTC) MOCK_PORT_VECTORS(PORTR, MOCK_PORTR)								\
+	MOCK_TIMER_VECTORS0(TCC0, 0) MOCK_TIMER_VECTORS1(TCC1, 1)												\
+	MOCK_USART_VECTORS(USARTC0, MOCK_USARTC0) MOCK_USART_VECTORS(USARTC1, MOCK_USARTC1)					\
+	MOCK_PORT_VECTORS(PORTB, MOCK_PORTB) MOCK_PORT_VECTORS(PORTE, MOCK_PORTE)								\
+	MOCK_TIMER_VECTORS0(TCE0, 4) MOCK_TIMER_VECTORS1(TCE1, 5)												\
+	MOCK_USART_VECTORS(USARTE0, MOCK_USARTE0)																\
+	MOCK_PORT_VECTORS(PORTD, MOCK_PORTD) MOCK_PORT_VECTORS(PORTA, MOCK_PORTA)								\
+	MOCK_TIMER_VECTORS0(TCD0, 2) MOCK_TIMER_VECTORS1(TCD1, 3)												\
+	MOCK_USART_VECTORS(USARTD0, MOCK_USARTD0) MOCK_USART_VECTORS(USARTD1, MOCK_USARTD1)					\
+	MOCK_PORT_VECTORS(PORTF, MOCK_PORTF)																	\
+	MOCK_TIMER_VECTORS0(TCF0, 6)																			\
+	MOCK_USART_VECTORS(USARTF0, MOCK_USARTF0)
+
+// The firmware defines the ISRs it needs, the others stay NULL
+#define X(name, kind, unit, channel)	extern void name(void) __attribute__((weak));
+MOCK_VECTORS
+#undef X
+extern void BADISR_vect(void) __attribute__((weak));
+
+#define X(name, kind, unit, channel)	{name, #name, kind, unit, channel},
+static const mockSource_t sources[] = {
+	MOCK_VECTORS
+};
+#undef X
+
+static const mockTimerInfo_t timerInfo[MOCK_TIMER_COUNT] = {
+	{0x0800, 4, EVSYS_CHMUX_TCC0_OVF_gc},
+	{0x0840, 2, EVSYS_CHMUX_TCC1_OVF_gc},
+	{0x0900, 4, EVSYS_CHMUX_TCD0_OVF_gc},
+	{0x0940, 2, EVSYS_CHMUX_TCD1_OVF_gc},
+	{0x0A00, 4, EVSYS_CHMUX_TCE0_OVF_gc},
+	{0x0A40, 2, EVSYS_CHMUX_TCE1_OVF_gc},
+	{0x0B00, 4, EVSYS_CHMUX_TCF0_OVF_gc},
+};
+
+static const uint16_t portAddress[MOCK_PORT_COUNT] = {0x0600, 0x0620, 0x0640, 0x0660, 0x0680, 0x06A0, 0x07E0};
+static const uint16_t uartAddress[MOCK_USART_COUNT] = {0x08A0, 0x08B0, 0x09A0, 0x09B0, 0x0AA0, 0x0BA0};
+static const uint16_t timerPrescaler[8] = {0, 1, 2, 4, 8, 64, 256, 1024};
+
+// Start-up times of RC2M, RC32M, RC32K, XOSC and PLL (bit order of OSC.CTRL).
+// Orders of magnitude from the datasheet, enough to make the ready polls wait.
+static const uint32_t oscStartupNS[5] = {5000, 5000, 1000000, 1000000, 64000};
+
+uint8_t mockIo[MOCK_IO_SIZE] __attribute__((aligned(MOCK_SYNC_BLOCK)));
+static uint8_t shadow[MOCK_IO_SIZE] __attribute__((aligned(MOCK_SYNC_BLOCK)));	//mockIo as published
+static uint32_t resets = 0;			//software resets, survives vMockReset()
+
+static struct {
+	uint64_t cycles;
+	uint64_t timeNS;
+	uint64_t nsRemainder;			//in 1/hz ns
+	uint32_t hz;
+	uint32_t xoscHz;
+	uint8_t ccpOpen;				//CCP written, the next protected write within MOCK_CCP_CYCLES passes
+	uint64_t ccpUntil;
+	uint32_t ccpViolations;
+	uint32_t interrupts;
+	uint64_t oscReadyNS[5];
+	uint8_t busy;					//inside the models, mockIo is not published
+	uint32_t activity;				//writes and API calls, vMockNop() skips only when nothing happened
+	uint32_t nopActivity;			//activity at the end of the last vMockNop()
+	uint8_t sourcesChanged;			//flags or levels may have changed since the last scan
+	uint8_t pendingLevels;			//levels with a pending source at the last scan (bit 0 = LO)
+	mockTimer_t timers[MOCK_TIMER_COUNT];
+	mockPort_t ports[MOCK_PORT_COUNT];
+	mockUart_t uarts[MOCK_USART_COUNT];
+} mock;
+
+static mockPinHook_t pinHook = NULL;
+static mockUartHook_t uartHook = NULL;
+static mockResetHook_t resetHook = NULL;
+static mockPinEvent_t pinLog[MOCK_PIN_LOG_SIZE];
+static uint32_t pinLogCount = 0;
+
+static void prvDispatch(void);
+
+/*---------------------------------------------------------------------------------*/
+// Clock system
+/*---------------------------------------------------------------------------------*/
+static uint32_t prvSourceHz(uint8_t sclksel) {
+	uint32_t reference;
+	switch(sclksel) {
+		case CLK_SCLKSEL_RC2M_gc:
+			return 2000000UL;
+		case CLK_SCLKSEL_RC32M_gc:
+			return 32000000UL;
+		case CLK_SCLKSEL_RC32K_gc:
+			return 32768UL;
+		case CLK_SCLKSEL_XOSC_gc:
+			return mock.xoscHz;
+		case CLK_SCLKSEL_PLL_gc:
+			switch(OSC.PLLCTRL & OSC_PLLSRC_gm) {
+				case OSC_PLLSRC_RC2M_gc:
+					reference = 2000000UL;
+					break;
+				case OSC_PLLSRC_RC32M_gc:
+					reference = 32000000UL / 4;
+					break;
+				default:
+					reference = mock.xoscHz;
+					break;
+			}
+			reference *= OSC.PLLCTRL & OSC_PLLFAC_gm;
+			return (OSC.PLLCTRL & OSC_PLLDIV_bm) ? reference / 2 : reference;
+	}
+	return 2000000UL;
+}
+
+// clkCPU = clkPER = clkSYS / A / B / C
+static void prvClockUpdate(void) {
+	static const uint8_t psbDivider[4] = {1, 1, 4, 2};
+	static const uint8_t pscDivider[4] = {1, 2, 1, 2};
+	uint8_t psctrl = CLK.PSCTRL;
+	uint8_t psadiv = (psctrl & CLK_PSADIV_gm) >> CLK_PSADIV_gp;
+	uint32_t hz = prvSourceHz(CLK.CTRL & CLK_SCLKSEL_gm);
+
+	hz >>= (psadiv + 1) / 2;
+	hz /= psbDivider[psctrl & CLK_PSBCDIV_gm] * pscDivider[psctrl & CLK_PSBCDIV_gm];
+	if(hz == 0) {
+		hz = 1;
+	}
+	if(hz != mock.hz) {
+		mock.nsRemainder = mock.nsRemainder * hz / mock.hz;
+		mock.hz = hz;
+	}
+}
+
+static void prvOscWrite(uint8_t old, uint8_t value) {
+	uint8_t keep = 1 << (CLK.CTRL & CLK_SCLKSEL_gm);
+	uint8_t enabled;
+
+	if((CLK.CTRL & CLK_SCLKSEL_gm) == CLK_SCLKSEL_PLL_gc) {
+		// the reference of the running PLL stays on as well
+		switch(OSC.PLLCTRL & OSC_PLLSRC_gm) {
+			case OSC_PLLSRC_RC2M_gc:
+				keep |= OSC_RC2MEN_bm;
+				break;
+			case OSC_PLLSRC_RC32M_gc:
+				keep |= OSC_RC32MEN_bm;
+				break;
+			default:
+				keep |= OSC_XOSCEN_bm;
+				break;
+		}
+	}
+	value |= old & keep;
+	enabled = value & ~old;
+	for(uint8_t b = 0; b < 5; b++) {
+		if(enabled & (1 << b)) {
+			mock.oscReadyNS[b] = mock.timeNS + oscStartupNS[b];
+		}
+	}
+	OSC.CTRL = value;
+	OSC.STATUS &= value;
+}
+
+static void prvOscUpdate(void) {
+	uint8_t pending = OSC.CTRL & ~OSC.STATUS;
+	uint8_t reference;
+
+	for(uint8_t b = 0; b < 5; b++) {
+		if((pending & (1 << b)) && mock.timeNS >= mock.oscReadyNS[b]) {
+			if(b == 4) {
+				switch(OSC.PLLCTRL & OSC_PLLSRC_gm) {
+					case OSC_PLLSRC_RC2M_gc:
+						reference = OSC_RC2MRDY_bm;
+						break;
+					case OSC_PLLSRC_RC32M_gc:
+						reference = OSC_RC32MRDY_bm;
+						break;
+					default:
+						reference = OSC_XOSCRDY_bm;
+						break;
+				}
+				if(!(OSC.STATUS & reference)) {
+					continue;
+				}
+			}
+			OSC.STATUS |= 1 << b;
+		}
+	}
+}
+
+// A CCP write opens one protected write
+static uint8_t prvCcpOpen(void) {
+	if(mock.ccpOpen && mock.cycles <= mock.ccpUntil) {
+		mock.ccpOpen = 0;
+		return 1;
+	}
+	mock.ccpViolations++;
+	return 0;
+}
+
+/*---------------------------------------------------------------------------------*/
+// Timer/counter
+/*---------------------------------------------------------------------------------*/
+static TC0_t *prvTimer(uint8_t t) {
+	return (TC0_t *) (mockIo + timerInfo[t].address);
+}
+
+static uint16_t prvTimerTop(TC0_t *tc) {
+	return ((tc->CTRLB & TC0_WGMODE_gm) == TC_WGMODE_FRQ_gc) ? tc->CCA : tc->PER;
+}
+
+static uint32_t prvTimerTicksToOverflow(TC0_t *tc) {
+	uint16_t cnt = tc->CNT;
+	uint16_t top = prvTimerTop(tc);
+	return (cnt <= top) ? (uint32_t) top - cnt + 1 : 0x10000UL - cnt;
+}
+
+// Timer that clocks t through the event system, -1 if there is none
+static int8_t prvTimerSource(uint8_t t) {
+	uint8_t clksel = prvTimer(t)->CTRLA & TC0_CLKSEL_gm;
+	uint8_t mux;
+
+	if(clksel < TC_CLKSEL_EVCH0_gc) {
+		return -1;
+	}
+	mux = mockIo[MOCK_IO(EVSYS.CH0MUX) + clksel - TC_CLKSEL_EVCH0_gc];
+	for(uint8_t s = 0; s < MOCK_TIMER_COUNT; s++) {
+		if(timerInfo[s].eventMux == mux && s != t) {
+			return s;
+		}
+	}
+	return -1;
+}
+
+// CCxIF of the compare values in (from, to]
+static uint8_t prvTimerMatches(uint8_t t, int32_t from, int32_t to) {
+	TC0_t *tc = prvTimer(t);
+	uint8_t flags = 0;
+
+	for(uint8_t c = 0; c < timerInfo[t].ccCount; c++) {
+		int32_t value = (&tc->CCA)[c];
+		if(value > from && value <= to) {
+			flags |= TC0_CCAIF_bm << c;
+		}
+	}
+	return flags;
+}
+
+static void prvTimerUpdate(uint8_t t, uint8_t force) {
+	TC0_t *tc = prvTimer(t);
+	mockTimer_t *timer = &mock.timers[t];
+
+	if((timer->ctrlf & TC0_LUPD_bm) && !force) {
+		return;
+	}
+	if(timer->ctrlg & TC0_PERBV_bm) {
+		tc->PER = tc->PERBUF;
+	}
+	for(uint8_t c = 0; c < timerInfo[t].ccCount; c++) {
+		if(timer->ctrlg & (TC0_CCABV_bm << c)) {
+			(&tc->CCA)[c] = (&tc->CCABUF)[c];
+		}
+	}
+	timer->ctrlg = 0;
+}
+
+static void prvTimerCount(uint8_t t, uint64_t ticks) {
+	TC0_t *tc = prvTimer(t);
+	mockTimer_t *timer = &mock.timers[t];
+
+	while(ticks > 0) {
+		uint16_t cnt = tc->CNT;
+		uint16_t top = prvTimerTop(tc);
+		uint32_t toOverflow = prvTimerTicksToOverflow(tc);
+
+		if(ticks < toOverflow) {
+			tc->INTFLAGS |= prvTimerMatches(t, cnt, cnt + (int32_t) ticks);
+			tc->CNT = cnt + (uint16_t) ticks;
+			return;
+		}
+		if(cnt <= top && timer->ctrlg == 0 && ticks - toOverflow > top) {
+			// whole periods: every compare value up to TOP matches
+			uint64_t rest = ticks - toOverflow;
+			timer->overflows += 1 + rest / ((uint32_t) top + 1);
+			tc->INTFLAGS |= prvTimerMatches(t, -1, top) | TC0_OVFIF_bm;
+			tc->CNT = rest % ((uint32_t) top + 1);
+			return;
+		}
+		tc->INTFLAGS |= prvTimerMatches(t, cnt, cnt + (int32_t) toOverflow - 1) | prvTimerMatches(t, -1, 0) | TC0_OVFIF_bm;
+		tc->CNT = 0;
+		timer->overflows++;
+		prvTimerUpdate(t, 0);
+		ticks -= toOverflow;
+	}
+}
+
+static void prvTimerCommand(uint8_t t, uint8_t cmd) {
+	TC0_t *tc = prvTimer(t);
+	mockTimer_t *timer = &mock.timers[t];
+
+	switch(cmd) {
+		case TC_CMD_UPDATE_gc:
+			prvTimerUpdate(t, 1);
+			break;
+		case TC_CMD_RESTART_gc:
+			tc->CNT = 0;
+			timer->prescaler = 0;
+			timer->ctrlf &= ~TC0_DIR_bm;
+			break;
+		case TC_CMD_RESET_gc:
+			if((tc->CTRLA & TC0_CLKSEL_gm) == TC_CLKSEL_OFF_gc) {
+				memset((void *) tc, 0, 0x40);
+				tc->INTFLAGS = MOCK_MARK_TC;
+				tc->PER = 0xFFFF;
+				tc->PERBUF = 0xFFFF;
+				timer->ctrlf = 0;
+				timer->ctrlg = 0;
+			}
+			break;
+	}
+}
+
+static uint8_t prvTimerInterrupts(uint8_t t) {
+	TC0_t *tc = prvTimer(t);
+	uint8_t ccMask = (timerInfo[t].ccCount == 4) ? 0xFF : 0x0F;
+	return (tc->INTCTRLA & TC0_OVFINTLVL_gm) || (tc->INTCTRLB & ccMask);
+}
+
+// Cycles until t has counted ticks more
+static uint64_t prvTimerCycles(uint8_t t, uint64_t ticks) {
+	TC0_t *tc = prvTimer(t);
+	uint8_t clksel = tc->CTRLA & TC0_CLKSEL_gm;
+	int8_t source;
+	uint64_t first;
+
+	if(clksel == TC_CLKSEL_OFF_gc) {
+		return MOCK_NEVER;
+	}
+	if(clksel < TC_CLKSEL_EVCH0_gc) {
+		return ticks * timerPrescaler[clksel] - mock.timers[t].prescaler;
+	}
+	source = prvTimerSource(t);
+	if(source < 0 || (prvTimer(source)->CTRLA & TC0_CLKSEL_gm) >= TC_CLKSEL_EVCH0_gc) {
+		return MOCK_NEVER;
+	}
+	first = prvTimerCycles(source, prvTimerTicksToOverflow(prvTimer(source)));
+	if(first == MOCK_NEVER) {
+		return MOCK_NEVER;
+	}
+	return first + (ticks - 1) * ((uint64_t) prvTimerTop(prvTimer(source)) + 1)
+		* timerPrescaler[prvTimer(source)->CTRLA & TC0_CLKSEL_gm];
+}
+
+// Cycles to the next overflow or compare match, of the enabled interrupts only
+// or of all channels
+static uint64_t prvTimerNextEvent(uint8_t t, uint8_t allChannels) {
+	TC0_t *tc = prvTimer(t);
+	uint32_t ticks = prvTimerTicksToOverflow(tc);
+
+	for(uint8_t c = 0; c < timerInfo[t].ccCount; c++) {
+		if(allChannels || (tc->INTCTRLB & (TC0_CCAINTLVL_gm << (2 * c)))) {
+			uint16_t value = (&tc->CCA)[c];
+			uint32_t distance = (value > tc->CNT && value <= prvTimerTop(tc))
+				? (uint32_t) value - tc->CNT : prvTimerTicksToOverflow(tc) + value;
+			if(distance < ticks) {
+				ticks = distance;
+			}
+		}
+	}
+	return prvTimerCycles(t, ticks);
+}
+
+static void prvTimerWrite(uint8_t t, uint16_t offset, uint8_t old, uint8_t value) {
+	mockTimer_t *timer = &mock.timers[t];
+	uint8_t *reg = mockIo + timerInfo[t].address + offset;
+
+	if(offset == MOCK_IO(TCC0.CTRLA) - MOCK_IO(TCC0)) {
+		if((old & TC0_CLKSEL_gm) == TC_CLKSEL_OFF_gc) {
+			timer->prescaler = 0;
+		}
+	} else if(offset == MOCK_IO(TCC0.CTRLFCLR) - MOCK_IO(TCC0) || offset == MOCK_IO(TCC0.CTRLFSET) - MOCK_IO(TCC0)) {
+		if(offset == MOCK_IO(TCC0.CTRLFCLR) - MOCK_IO(TCC0)) {
+			timer->ctrlf &= ~value;
+		} else {
+			timer->ctrlf |= value;
+		}
+		prvTimerCommand(t, timer->ctrlf & TC0_CMD_gm);
+		timer->ctrlf &= ~TC0_CMD_gm;
+		*reg = 0;
+	} else if(offset == MOCK_IO(TCC0.CTRLGCLR) - MOCK_IO(TCC0) || offset == MOCK_IO(TCC0.CTRLGSET) - MOCK_IO(TCC0)) {
+		if(offset == MOCK_IO(TCC0.CTRLGCLR) - MOCK_IO(TCC0)) {
+			timer->ctrlg &= ~value;
+		} else {
+			timer->ctrlg |= value;
+		}
+		*reg = 0;
+	} else if(offset == MOCK_IO(TCC0.INTFLAGS) - MOCK_IO(TCC0)) {
+		*reg = (old & ~value) | MOCK_MARK_TC;
+	} else if(offset >= MOCK_IO(TCC0.PERBUF) - MOCK_IO(TCC0)) {
+		// PERBUF, CCABUF.. CCDBUF: the buffer is valid until the next UPDATE
+		uint8_t buffer = (offset - (MOCK_IO(TCC0.PERBUF) - MOCK_IO(TCC0))) / 2;
+		if(buffer <= timerInfo[t].ccCount) {
+			timer->ctrlg |= TC0_PERBV_bm << buffer;
+		}
+	}
+}
+
+/*---------------------------------------------------------------------------------*/
+// I/O ports
+/*---------------------------------------------------------------------------------*/
+static PORT_t *prvPort(uint8_t p) {
+	return (PORT_t *) (mockIo + portAddress[p]);
+}
+
+// Virtual ports show DIR, OUT, IN and INTFLAGS of the port mapped by PORTCFG
+static int8_t prvVportMap(uint8_t v) {
+	uint8_t ctrl = (v < 2) ? PORTCFG.VPCTRLA : PORTCFG.VPCTRLB;
+	uint8_t map = (v & 1) ? ctrl >> 4 : ctrl & 0x0F;
+
+	if(map == 0x0F) {
+		return MOCK_PORTR;
+	}
+	return (map <= MOCK_PORTF) ? map : -1;
+}
+
+static void prvVportMirror(void) {
+	for(uint8_t v = 0; v < 4; v++) {
+		VPORT_t *vport = (VPORT_t *) (mockIo + MOCK_IO(VPORT0) + v * sizeof(VPORT_t));
+		int8_t p = prvVportMap(v);
+		if(p >= 0) {
+			vport->DIR = prvPort(p)->DIR;
+			vport->OUT = prvPort(p)->OUT;
+			vport->IN = prvPort(p)->IN;
+			vport->INTFLAGS = prvPort(p)->INTFLAGS;
+		}
+	}
+}
+
+static void prvPortUpdate(uint8_t p) {
+	PORT_t *port = prvPort(p);
+	mockPort_t *state = &mock.ports[p];
+	uint8_t pins = 0;
+	uint8_t in = 0;
+	uint8_t changed;
+
+	for(uint8_t b = 0; b < 8; b++) {
+		uint8_t mask = 1 << b;
+		uint8_t ctrl = (&port->PIN0CTRL)[b];
+		uint8_t level;
+
+		if(port->DIR & mask) {
+			level = port->OUT & mask;
+		} else if(state->extMask & mask) {
+			level = state->extLevels & mask;
+		} else if((ctrl & PORT_OPC_gm) == PORT_OPC_PULLUP_gc || (ctrl & PORT_OPC_gm) == PORT_OPC_WIREDANDPULL_gc) {
+			level = mask;
+		} else if((ctrl & PORT_OPC_gm) == PORT_OPC_PULLDOWN_gc || (ctrl & PORT_OPC_gm) == PORT_OPC_WIREDORPULL_gc) {
+			level = 0;
+		} else {
+			level = state->pins & mask;		//floating or bus keeper: stays where it was
+		}
+		pins |= level;
+		if(ctrl & PORT_INVEN_bm) {
+			level ^= mask;
+		}
+		if((ctrl & PORT_ISC_gm) != PORT_ISC_INPUT_DISABLE_gc) {
+			in |= level;
+		}
+	}
+
+	changed = in ^ port->IN;
+	for(uint8_t n = 0; n < 2; n++) {
+		uint8_t pinMask = n ? port->INT1MASK : port->INT0MASK;
+		for(uint8_t b = 0; b < 8; b++) {
+			uint8_t mask = 1 << b;
+			uint8_t sense = (&port->PIN0CTRL)[b] & PORT_ISC_gm;
+			uint8_t hit = 0;
+			if(!(pinMask & mask)) {
+				continue;
+			}
+			switch(sense) {
+				case PORT_ISC_BOTHEDGES_gc:
+					hit = changed & mask;
+					break;
+				case PORT_ISC_RISING_gc:
+					hit = changed & in & mask;
+					break;
+				case PORT_ISC_FALLING_gc:
+					hit = changed & ~in & mask;
+					break;
+				case PORT_ISC_LEVEL_gc:
+					hit = ~in & mask;
+					break;
+			}
+			if(hit) {
+				port->INTFLAGS |= PORT_INT0IF_bm << n;
+			}
+		}
+	}
+	port->IN = in;
+	mock.sourcesChanged = 1;
+
+	if(pins != state->pins) {
+		mockPinEvent_t event = {mock.timeNS, p, pins, pins ^ state->pins};
+		state->pins = pins;
+		if(pinLogCount < MOCK_PIN_LOG_SIZE) {
+			pinLog[pinLogCount++] = event;
+		}
+		if(pinHook != NULL) {
+			pinHook(&event);
+		}
+	}
+	prvVportMirror();
+}
+
+static void prvPortWrite(uint8_t p, uint16_t offset, uint8_t old, uint8_t value) {
+	PORT_t *port = prvPort(p);
+	uint8_t *reg = mockIo + portAddress[p] + offset;
+
+	switch(offset) {
+		case 0x01:
+			port->DIR |= value;
+			break;
+		case 0x02:
+			port->DIR &= ~value;
+			break;
+		case 0x03:
+			port->DIR ^= value;
+			break;
+		case 0x05:
+			port->OUT |= value;
+			break;
+		case 0x06:
+			port->OUT &= ~value;
+			break;
+		case 0x07:
+			port->OUT ^= value;
+			break;
+		case 0x08:
+			*reg = old;				//IN is read only
+			break;
+		case 0x0C:
+			*reg = (old & ~value) | MOCK_MARK_PORT;
+			break;
+		default:
+			if(offset >= 0x10 && offset < 0x18 && PORTCFG.MPCMASK) {
+				// multi-pin configuration: the write goes to every pin of MPCMASK
+				for(uint8_t b = 0; b < 8; b++) {
+					if(PORTCFG.MPCMASK & (1 << b)) {
+						(&port->PIN0CTRL)[b] = value;
+					}
+				}
+				PORTCFG.MPCMASK = 0;
+			}
+			break;
+	}
+	port->DIRSET = port->DIRCLR = port->DIRTGL = 0;
+	port->OUTSET = port->OUTCLR = port->OUTTGL = 0;
+	prvPortUpdate(p);
+}
+
+static void prvVportWrite(uint16_t address, uint8_t old, uint8_t value) {
+	uint8_t v = (address - MOCK_IO(VPORT0)) / sizeof(VPORT_t);
+	uint8_t offset = (address - MOCK_IO(VPORT0)) % sizeof(VPORT_t);
+	int8_t p = prvVportMap(v);
+
+	if(p < 0) {
+		return;
+	}
+	switch(offset) {
+		case 0:
+			prvPort(p)->DIR = value;
+			prvPortWrite(p, 0x00, old, value);
+			break;
+		case 1:
+			prvPort(p)->OUT = value;
+			prvPortWrite(p, 0x04, old, value);
+			break;
+		case 3:
+			prvPortWrite(p, 0x0C, prvPort(p)->INTFLAGS, value);
+			break;
+		default:
+			prvVportMirror();
+			break;
+	}
+}
+
+/*---------------------------------------------------------------------------------*/
+// USART
+/*---------------------------------------------------------------------------------*/
+static USART_t *prvUart(uint8_t u) {
+	return (USART_t *) (mockIo + uartAddress[u]);
+}
+
+static uint64_t prvUartFrameNS(uint8_t u) {
+	static const uint8_t dataBits[8] = {5, 6, 7, 8, 8, 8, 8, 9};
+	USART_t *usart = prvUart(u);
+	uint16_t bsel = ((usart->BAUDCTRLB & 0x0F) << 8) | usart->BAUDCTRLA;
+	int8_t bscale = (usart->BAUDCTRLB & USART_BSCALE_gm) >> USART_BSCALE_gp;
+	uint64_t samples = (usart->CTRLB & USART_CLK2X_bm) ? 8 : 16;
+	uint64_t bits = 1 + dataBits[usart->CTRLC & USART_CHSIZE_gm] + ((usart->CTRLC & USART_PMODE_gm) ? 1 : 0)
+		+ ((usart->CTRLC & USART_SBMODE_bm) ? 2 : 1);
+	uint64_t cycles;
+	uint64_t scale = 1;
+
+	if(bscale >= 8) {
+		bscale -= 16;
+	}
+	// cycles per bit: samples * (BSEL + 1) * 2^BSCALE, samples * (BSEL * 2^BSCALE + 1) below 0
+	if(bscale >= 0) {
+		cycles = samples * bits * ((uint64_t) bsel + 1) << bscale;
+	} else {
+		scale = 1ULL << -bscale;
+		cycles = samples * bits * ((uint64_t) bsel + scale);
+	}
+	return cycles * 1000000000ULL / ((uint64_t) mock.hz * scale);
+}
+
+static void prvUartShift(uint8_t u, uint8_t data, uint64_t startNS) {
+	mock.uarts[u].shifting = 1;
+	mock.uarts[u].shiftDoneNS = startNS + prvUartFrameNS(u);
+	if(uartHook != NULL) {
+		uartHook(u, data, startNS);
+	}
+}
+
+static void prvUartUpdate(void) {
+	for(uint8_t u = 0; u < MOCK_USART_COUNT; u++) {
+		mockUart_t *uart = &mock.uarts[u];
+		while(uart->shifting && mock.timeNS >= uart->shiftDoneNS) {
+			if(uart->buffered) {
+				uart->buffered = 0;
+				prvUart(u)->STATUS |= USART_DREIF_bm;
+				prvUartShift(u, uart->buffer, uart->shiftDoneNS);
+			} else {
+				uart->shifting = 0;
+				prvUart(u)->STATUS |= USART_TXCIF_bm;
+			}
+		}
+	}
+}
+
+static void prvUartWrite(uint8_t u, uint16_t offset, uint8_t old, uint8_t value) {
+	USART_t *usart = prvUart(u);
+	mockUart_t *uart = &mock.uarts[u];
+
+	if(offset == 0) {
+		usart->DATA = uart->rxCount ? uart->rx[0] : 0;
+		if(!(usart->CTRLB & USART_TXEN_bm)) {
+			return;
+		}
+		if(!uart->shifting) {
+			prvUartShift(u, value, mock.timeNS);
+		} else if(!uart->buffered) {
+			uart->buffered = 1;
+			uart->buffer = value;
+			usart->STATUS &= ~USART_DREIF_bm;
+		}
+	} else if(offset == 1) {
+		usart->STATUS = (old & ~(value & USART_TXCIF_bm)) | MOCK_MARK_USART;
+	} else if(offset == 4 && !(value & USART_RXEN_bm)) {
+		uart->rxCount = 0;
+		usart->STATUS &= ~USART_RXCIF_bm;
+	}
+}
+
+// The received byte was read: the RXC ISR returned or ucMockRegRead() of DATA
+static void prvUartPop(uint8_t u) {
+	USART_t *usart = prvUart(u);
+	mockUart_t *uart = &mock.uarts[u];
+
+	if(uart->rxCount == 0) {
+		return;
+	}
+	uart->rx[0] = uart->rx[1];
+	if(--uart->rxCount) {
+		usart->DATA = uart->rx[0];
+	} else {
+		usart->STATUS &= ~USART_RXCIF_bm;
+	}
+}
+
+static uint64_t prvUartNextEventNS(uint8_t u) {
+	USART_t *usart = prvUart(u);
+	if(mock.uarts[u].shifting && (usart->CTRLA & (USART_TXCINTLVL_gm | USART_DREINTLVL_gm))) {
+		return mock.uarts[u].shiftDoneNS;
+	}
+	return MOCK_NEVER;
+}
+
+/*---------------------------------------------------------------------------------*/
+// Time
+/*---------------------------------------------------------------------------------*/
+// Runs every model for cycles (at most one second), no interrupts
+static void prvRun(uint64_t cycles) {
+	uint64_t before[MOCK_TIMER_COUNT];
+	uint8_t done = 0;
+	uint64_t ns;
+
+	mock.cycles += cycles;
+	ns = mock.nsRemainder + cycles * 1000000000ULL;
+	mock.timeNS += ns / mock.hz;
+	mock.nsRemainder = ns % mock.hz;
+
+	for(uint8_t t = 0; t < MOCK_TIMER_COUNT; t++) {
+		uint8_t clksel = prvTimer(t)->CTRLA & TC0_CLKSEL_gm;
+		before[t] = mock.timers[t].overflows;
+		if(clksel != TC_CLKSEL_OFF_gc && clksel < TC_CLKSEL_EVCH0_gc) {
+			uint64_t total = mock.timers[t].prescaler + cycles;
+			mock.timers[t].prescaler = total % timerPrescaler[clksel];
+			prvTimerCount(t, total / timerPrescaler[clksel]);
+		}
+		if(clksel < TC_CLKSEL_EVCH0_gc) {
+			done |= 1 << t;
+		}
+	}
+	// event clocked timers after their source, one pass per cascade level
+	for(uint8_t pass = 0; pass < MOCK_TIMER_COUNT && done != (1 << MOCK_TIMER_COUNT) - 1; pass++) {
+		for(uint8_t t = 0; t < MOCK_TIMER_COUNT; t++) {
+			int8_t source = prvTimerSource(t);
+			if(done & (1 << t)) {
+				continue;
+			}
+			if(source < 0) {
+				done |= 1 << t;
+			} else if(done & (1 << source)) {
+				prvTimerCount(t, mock.timers[source].overflows - before[source]);
+				done |= 1 << t;
+			}
+		}
+	}
+	prvOscUpdate();
+	prvUartUpdate();
+	mock.sourcesChanged = 1;
+}
+
+// Cycles up to the next event that can raise an interrupt, at most limit
+static uint64_t prvNextEvent(uint64_t limit) {
+	uint64_t next = limit;
+
+	for(uint8_t t = 0; t < MOCK_TIMER_COUNT; t++) {
+		if(prvTimerInterrupts(t)) {
+			uint64_t cycles = prvTimerNextEvent(t, 0);
+			if(cycles < next) {
+				next = cycles;
+			}
+		}
+	}
+	for(uint8_t u = 0; u < MOCK_USART_COUNT; u++) {
+		uint64_t ns = prvUartNextEventNS(u);
+		if(ns != MOCK_NEVER) {
+			uint64_t cycles = (ns > mock.timeNS) ? ((ns - mock.timeNS) * mock.hz + 999999999ULL) / 1000000000ULL : 1;
+			if(cycles < next) {
+				next = cycles;
+			}
+		}
+	}
+	return next ? next : 1;
+}
+
+// Cycles up to the next change of a flag or status bit, at most limit
+static uint64_t prvNextChange(uint64_t limit) {
+	uint64_t next = prvNextEvent(limit);
+	uint8_t pending = OSC.CTRL & ~OSC.STATUS;
+
+	for(uint8_t t = 0; t < MOCK_TIMER_COUNT; t++) {
+		uint64_t cycles = prvTimerNextEvent(t, 1);
+		if(cycles < next) {
+			next = cycles;
+		}
+	}
+	for(uint8_t u = 0; u < MOCK_USART_COUNT; u++) {
+		if(mock.uarts[u].shifting && mock.uarts[u].shiftDoneNS > mock.timeNS) {
+			uint64_t cycles = ((mock.uarts[u].shiftDoneNS - mock.timeNS) * mock.hz + 999999999ULL) / 1000000000ULL;
+			if(cycles < next) {
+				next = cycles;
+			}
+		}
+	}
+	for(uint8_t b = 0; b < 5; b++) {
+		if((pending & (1 << b)) && mock.oscReadyNS[b] > mock.timeNS) {
+			uint64_t cycles = ((mock.oscReadyNS[b] - mock.timeNS) * mock.hz + 999999999ULL) / 1000000000ULL;
+			if(cycles < next) {
+				next = cycles;
+			}
+		}
+	}
+	return next ? next : 1;
+}
+
+/*---------------------------------------------------------------------------------*/
+// Interrupts
+/*---------------------------------------------------------------------------------*/
+static uint8_t prvSourcePending(const mockSource_t *source, uint8_t *level) {
+	TC0_t *tc;
+	PORT_t *port;
+	USART_t *usart;
+
+	switch(source->kind) {
+		case SOURCE_TC_OVF:
+			tc = prvTimer(source->unit);
+			*level = tc->INTCTRLA & TC0_OVFINTLVL_gm;
+			return tc->INTFLAGS & TC0_OVFIF_bm;
+		case SOURCE_TC_ERR:
+			tc = prvTimer(source->unit);
+			*level = (tc->INTCTRLA & TC0_ERRINTLVL_gm) >> 2;
+			return tc->INTFLAGS & TC0_ERRIF_bm;
+		case SOURCE_TC_CC:
+			tc = prvTimer(source->unit);
+			*level = (tc->INTCTRLB >> (2 * source->channel)) & 0x03;
+			return tc->INTFLAGS & (TC0_CCAIF_bm << source->channel);
+		case SOURCE_PORT:
+			port = prvPort(source->unit);
+			*level = (port->INTCTRL >> (2 * source->channel)) & 0x03;
+			return port->INTFLAGS & (PORT_INT0IF_bm << source->channel);
+		case SOURCE_USART_RXC:
+			usart = prvUart(source->unit);
+			*level = (usart->CTRLA & USART_RXCINTLVL_gm) >> 4;
+			return usart->STATUS & USART_RXCIF_bm;
+		case SOURCE_USART_DRE:
+			usart = prvUart(source->unit);
+			*level = usart->CTRLA & USART_DREINTLVL_gm;
+			return usart->STATUS & USART_DREIF_bm;
+		case SOURCE_USART_TXC:
+			usart = prvUart(source->unit);
+			*level = (usart->CTRLA & USART_TXCINTLVL_gm) >> 2;
+			return usart->STATUS & USART_TXCIF_bm;
+	}
+	return 0;
+}
+
+// Flags the hardware clears when the vector is executed. RXCIF stays set while
+// the ISR reads DATA, prvDispatch() moves the next byte up when it returns.
+static void prvSourceAcknowledge(const mockSource_t *source) {
+	switch(source->kind) {
+		case SOURCE_TC_OVF:
+			prvTimer(source->unit)->INTFLAGS &= ~TC0_OVFIF_bm;
+			break;
+		case SOURCE_TC_ERR:
+			prvTimer(source->unit)->INTFLAGS &= ~TC0_ERRIF_bm;
+			break;
+		case SOURCE_TC_CC:
+			prvTimer(source->unit)->INTFLAGS &= ~(TC0_CCAIF_bm << source->channel);
+			break;
+		case SOURCE_PORT:
+			prvPort(source->unit)->INTFLAGS &= ~(PORT_INT0IF_bm << source->channel);
+			prvVportMirror();
+			break;
+		case SOURCE_USART_TXC:
+			prvUart(source->unit)->STATUS &= ~USART_TXCIF_bm;
+			break;
+	}
+}
+
+
+static void prvPublish(void) {
+	memcpy(shadow, mockIo, MOCK_IO_SIZE);
+}
+
+static void prvWrite(uint16_t address, uint8_t old, uint8_t value);
+
+// CTRLFSET/CTRLFCLR of a timer: the command acts on the registers written with it
+static uint8_t prvTimerCommandRegister(uint16_t address) {
+	for(uint8_t t = 0; t < MOCK_TIMER_COUNT; t++) {
+		uint16_t offset = address - timerInfo[t].address;
+		if(offset == MOCK_IO(TCC0.CTRLFCLR) - MOCK_IO(TCC0) || offset == MOCK_IO(TCC0.CTRLFSET) - MOCK_IO(TCC0)) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+// Hands the bytes the firmware wrote since the last tick to the models, in
+// address order: CCP before CLK and OSC, MPCMASK before the PINnCTRL. The timer
+// commands come last, after the buffers they update. Waits for the outer call
+// inside the models (a hook).
+static void prvApply(void) {
+	static struct {
+		uint16_t address;
+		uint8_t old;
+		uint8_t value;
+	} writes[MOCK_IO_SIZE];
+	uint32_t resetsBefore = resets;
+	uint16_t count = 0;
+
+	if(mock.busy || memcmp(mockIo, shadow, MOCK_IO_SIZE) == 0) {
+		return;
+	}
+	for(uint16_t block = 0; block < MOCK_IO_SIZE; block += MOCK_SYNC_BLOCK) {
+		if(memcmp(mockIo + block, shadow + block, MOCK_SYNC_BLOCK) == 0) {
+			continue;
+		}
+		for(uint16_t address = block; address < block + MOCK_SYNC_BLOCK; address++) {
+			if(mockIo[address] != shadow[address]) {
+				writes[count].address = address;
+				writes[count].old = shadow[address];
+				writes[count].value = mockIo[address];
+				count++;
+			}
+		}
+	}
+	mock.busy = 1;
+	mock.activity++;
+	for(uint8_t commands = 0; commands < 2; commands++) {
+		for(uint16_t i = 0; i < count && resets == resetsBefore; i++) {
+			if(prvTimerCommandRegister(writes[i].address) != commands) {
+				continue;
+			}
+			// a model may have changed the byte for an earlier write, the firmware wrote last
+			mockIo[writes[i].address] = writes[i].value;
+			prvWrite(writes[i].address, writes[i].old, writes[i].value);
+		}
+	}
+	mock.busy = 0;
+	prvPublish();
+}
+
+// Serves pending interrupts, highest level first, a level interrupts only lower ones
+static void prvDispatch(void) {
+	if(mock.busy) {
+		return;
+	}
+	for(;;) {
+		const mockSource_t *best = NULL;
+		uint8_t bestLevel = 0;
+		uint8_t running = 0;
+		uint8_t status;
+
+		prvApply();
+		status = PMIC.STATUS;
+		if(!(SREG & CPU_I_bm)) {
+			return;
+		}
+		if(status & PMIC_HILVLEX_bm) {
+			running = 3;
+		} else if(status & PMIC_MEDLVLEX_bm) {
+			running = 2;
+		} else if(status & PMIC_LOLVLEX_bm) {
+			running = 1;
+		}
+		// nothing changed and nothing of an enabled level above the running one waits
+		if(!mock.sourcesChanged && !(mock.pendingLevels & PMIC.CTRL & (0x07 << running) & 0x07)) {
+			return;
+		}
+		mock.sourcesChanged = 0;
+		mock.pendingLevels = 0;
+		for(uint16_t s = 0; s < sizeof(sources) / sizeof(sources[0]); s++) {
+			uint8_t level = 0;
+			if(!prvSourcePending(&sources[s], &level) || level == 0) {
+				continue;
+			}
+			mock.pendingLevels |= 1 << (level - 1);
+			if(level > bestLevel && level > running && (PMIC.CTRL & (PMIC_LOLVLEN_bm << (level - 1)))) {
+				best = &sources[s];
+				bestLevel = level;
+			}
+		}
+		if(best == NULL) {
+			return;
+		}
+		prvSourceAcknowledge(best);
+		mock.sourcesChanged = 1;
+		PMIC.STATUS |= PMIC_LOLVLEX_bm << (bestLevel - 1);
+		mock.interrupts++;
+		mock.activity++;
+		prvPublish();
+		if(best->handler != NULL) {
+			best->handler();
+		} else if(BADISR_vect != NULL) {
+			BADISR_vect();
+		} else {
+			fprintf(stderr, "mockHal: %s enabled without ISR\n", best->name);
+			abort();
+		}
+		prvApply();		//the writes of the ISR, still on its level
+		PMIC.STATUS &= ~(PMIC_LOLVLEX_bm << (bestLevel - 1));
+		if(best->kind == SOURCE_USART_RXC) {
+			prvUartPop(best->unit);
+		}
+		prvPublish();
+	}
+}
+
+// Runs the models for cycles, interrupts are served at the events on the way
+static void prvAdvance(uint64_t cycles) {
+	prvApply();
+	while(cycles > 0) {
+		uint64_t step = prvNextEvent(cycles < mock.hz ? cycles : mock.hz);
+		mock.busy = 1;
+		prvRun(step);
+		mock.busy = 0;
+		prvPublish();
+		cycles -= step;
+		prvDispatch();
+	}
+}
+
+// API calls that change a model: the writes of the firmware first, the
+// interrupts after. Called from a hook, the outer call does both.
+static uint8_t prvBegin(void) {
+	if(mock.busy) {
+		return 0;
+	}
+	prvApply();
+	mock.activity++;
+	mock.busy = 1;
+	return 1;
+}
+
+static void prvEnd(uint8_t outer) {
+	if(outer) {
+		mock.busy = 0;
+		prvPublish();
+		prvDispatch();
+	}
+}
+
+static void prvSoftwareReset(void) {
+	if(resetHook == NULL) {
+		fprintf(stderr, "mockHal: software reset at %llu ns\n", (unsigned long long) mock.timeNS);
+		exit(EXIT_FAILURE);
+	}
+	resets++;
+	vMockReset();
+	RST.STATUS = RST_SRF_bm | MOCK_MARK_RST;
+	prvPublish();
+	resetHook();
+}
+
+/*---------------------------------------------------------------------------------*/
+// Register writes
+/*---------------------------------------------------------------------------------*/
+// SREG and PMIC: no model behind them and no interrupt flags
+static uint8_t prvCoreRegister(uint16_t address) {
+	return address == MOCK_IO(SREG) || (address >= MOCK_IO(PMIC) && address < MOCK_IO(PMIC) + sizeof(PMIC_t));
+}
+
+static void prvWrite(uint16_t address, uint8_t old, uint8_t value) {
+	if(!prvCoreRegister(address)) {
+		mock.sourcesChanged = 1;
+	}
+	for(uint8_t t = 0; t < MOCK_TIMER_COUNT; t++) {
+		if(address >= timerInfo[t].address && address < timerInfo[t].address + 0x40) {
+			prvTimerWrite(t, address - timerInfo[t].address, old, value);
+			return;
+		}
+	}
+	for(uint8_t p = 0; p < MOCK_PORT_COUNT; p++) {
+		if(address >= portAddress[p] && address < portAddress[p] + sizeof(PORT_t)) {
+			prvPortWrite(p, address - portAddress[p], old, value);
+			return;
+		}
+	}
+	for(uint8_t u = 0; u < MOCK_USART_COUNT; u++) {
+		if(address >= uartAddress[u] && address < uartAddress[u] + sizeof(USART_t)) {
+			prvUartWrite(u, address - uartAddress[u], old, value);
+			return;
+		}
+	}
+	if(address >= MOCK_IO(VPORT0) && address < MOCK_IO(VPORT0) + 4 * sizeof(VPORT_t)) {
+		prvVportWrite(address, old, value);
+	} else if(address == MOCK_IO(CCP)) {
+		if(value == CCP_IOREG_gc) {
+			mock.ccpOpen = 1;
+			mock.ccpUntil = mock.cycles + MOCK_CCP_CYCLES;
+		}
+		CCP = 0;
+	} else if(address == MOCK_IO(CLK.CTRL)) {
+		if(!prvCcpOpen() || (CLK.LOCK & CLK_LOCK_bm) || !(OSC.STATUS & (1 << (value & CLK_SCLKSEL_gm)))) {
+			CLK.CTRL = old;		//not ready sources are not selected
+		}
+		prvClockUpdate();
+	} else if(address == MOCK_IO(CLK.PSCTRL)) {
+		if(!prvCcpOpen() || (CLK.LOCK & CLK_LOCK_bm)) {
+			CLK.PSCTRL = old;
+		}
+		prvClockUpdate();
+	} else if(address == MOCK_IO(CLK.LOCK)) {
+		if(!prvCcpOpen()) {
+			CLK.LOCK = old;
+		}
+		CLK.LOCK |= old;
+	} else if(address == MOCK_IO(OSC.CTRL)) {
+		prvOscWrite(old, value);
+		prvOscUpdate();
+	} else if(address == MOCK_IO(OSC.STATUS)) {
+		OSC.STATUS = old;
+	} else if(address == MOCK_IO(OSC.PLLCTRL)) {
+		if(shadow[MOCK_IO(OSC.CTRL)] & OSC_PLLEN_bm) {
+			OSC.PLLCTRL = old;		//locked while the PLL runs, it was on before these writes
+		}
+	} else if(address == MOCK_IO(OSC.XOSCFAIL)) {
+		uint8_t enable = (prvCcpOpen() ? value : old) & OSC_XOSCFDEN_bm;
+		OSC.XOSCFAIL = ((old & ~value) & OSC_XOSCFDIF_bm) | enable | (old & OSC_XOSCFDEN_bm) | MOCK_MARK_XOSCFAIL;
+	} else if(address == MOCK_IO(PMIC.STATUS)) {
+		PMIC.STATUS = old;
+	} else if(address == MOCK_IO(PMIC.CTRL)) {
+		if(((old ^ value) & PMIC_IVSEL_bm) && !prvCcpOpen()) {
+			PMIC.CTRL = (value & ~PMIC_IVSEL_bm) | (old & PMIC_IVSEL_bm);
+		}
+	} else if(address == MOCK_IO(RST.STATUS)) {
+		RST.STATUS = (old & ~value) | MOCK_MARK_RST;
+	} else if(address == MOCK_IO(RST.CTRL)) {
+		RST.CTRL = 0;
+		if((value & RST_SWRST_bm) && prvCcpOpen()) {
+			prvSoftwareReset();
+		}
+	} else if(address == MOCK_IO(PORTCFG.VPCTRLA) || address == MOCK_IO(PORTCFG.VPCTRLB)) {
+		prvVportMirror();
+	}
+}
+
+__attribute__((constructor(101))) static void prvMockInit(void) {
+	mock.xoscHz = MOCK_XOSC_HZ;
+	vMockReset();
+}
+
+/*---------------------------------------------------------------------------------*/
+// API
+/*---------------------------------------------------------------------------------*/
+void vMockReset(void) {
+	uint32_t xoscHz = mock.xoscHz;
+
+	memset(mockIo, 0, MOCK_IO_SIZE);
+	memset(&mock, 0, sizeof(mock));
+	mock.xoscHz = xoscHz;
+	mock.hz = 2000000UL;
+	mock.sourcesChanged = 1;
+	mock.busy = 1;
+	pinLogCount = 0;
+
+	OSC.CTRL = OSC_RC2MEN_bm;
+	OSC.STATUS = OSC_RC2MRDY_bm;
+	OSC.XOSCFAIL = MOCK_MARK_XOSCFAIL;
+	RST.STATUS = RST_PORF_bm | MOCK_MARK_RST;
+	SP = RAMEND;
+	for(uint8_t t = 0; t < MOCK_TIMER_COUNT; t++) {
+		prvTimer(t)->INTFLAGS = MOCK_MARK_TC;
+		prvTimer(t)->PER = 0xFFFF;
+		prvTimer(t)->PERBUF = 0xFFFF;
+	}
+	for(uint8_t u = 0; u < MOCK_USART_COUNT; u++) {
+		prvUart(u)->STATUS = USART_DREIF_bm | MOCK_MARK_USART;
+	}
+	for(uint8_t p = 0; p < MOCK_PORT_COUNT; p++) {
+		prvPort(p)->INTFLAGS = MOCK_MARK_PORT;
+		prvPortUpdate(p);
+	}
+	prvClockUpdate();
+	mock.busy = 0;
+	prvPublish();
+}
+
+uint64_t ullMockCycles(void) {
+	return mock.cycles;
+}
+
+uint64_t ullMockTimeNS(void) {
+	return mock.timeNS;
+}
+
+uint32_t ulMockCpuHz(void) {
+	return mock.hz;
+}
+
+void vMockSync(void) {
+	prvDispatch();
+}
+
+void vMockNop(void) {
+	prvApply();
+	if(mock.activity != mock.nopActivity) {
+		prvAdvance(MOCK_POLL_CYCLES);
+	} else {
+		// Polled twice with nothing in between: nothing the loop can see changes
+		// before the next change of a model
+		prvAdvance(prvNextChange(mock.hz));
+	}
+	mock.nopActivity = mock.activity;
+}
+
+void vMockAdvanceCycles(uint64_t cycles) {
+	mock.activity++;
+	prvAdvance(cycles);
+}
+
+void vMockAdvanceNS(uint64_t ns) {
+	while(ns > 0) {
+		uint64_t part = ns < 1000000000ULL ? ns : 1000000000ULL;
+		// at the current clock, rounded up so that a delay is never shorter
+		vMockAdvanceCycles((part * mock.hz + 999999999ULL) / 1000000000ULL);
+		ns -= part;
+	}
+}
+
+void vMockSleep(void) {
+	prvApply();
+	if(SLEEP.CTRL & SLEEP_SEN_bm) {
+		vMockWaitForInterrupt();
+	}
+}
+
+void vMockWaitForInterrupt(void) {
+	uint32_t served = mock.interrupts;
+
+	mock.activity++;
+	prvDispatch();
+	while(mock.interrupts == served) {
+		uint64_t step = prvNextEvent(MOCK_NEVER);
+		if(step == MOCK_NEVER || !(SREG & CPU_I_bm)) {
+			fprintf(stderr, "mockHal: waiting without a wake-up source at %llu ns\n", (unsigned long long) mock.timeNS);
+			abort();
+		}
+		prvAdvance(step);
+	}
+}
+
+void vMockSetXoscHz(uint32_t hz) {
+	uint8_t outer = prvBegin();
+
+	mock.xoscHz = hz;
+	prvClockUpdate();
+	prvEnd(outer);
+}
+
+void vMockSei(void) {
+	uint8_t outer = prvBegin();
+
+	SREG |= CPU_I_bm;
+	prvEnd(outer);
+}
+
+void vMockCli(void) {
+	uint8_t outer = prvBegin();
+
+	SREG &= ~CPU_I_bm;
+	prvEnd(outer);
+}
+
+uint8_t ucMockRegRead(uint16_t address) {
+	uint8_t value;
+
+	if(prvCoreRegister(address)) {
+		return mockIo[address];
+	}
+	prvApply();
+	value = mockIo[address];
+	for(uint8_t u = 0; u < MOCK_USART_COUNT; u++) {
+		if(address == uartAddress[u]) {
+			uint8_t outer = prvBegin();
+			prvUartPop(u);
+			prvEnd(outer);
+		}
+	}
+	return value;
+}
+
+void vMockRegWrite(uint16_t address, uint8_t value) {
+	uint8_t outer;
+	uint8_t old;
+
+	if(prvCoreRegister(address)) {
+		// no model behind it: only this byte, the other writes wait for the next tick
+		old = mockIo[address];
+		mockIo[address] = value;
+		prvWrite(address, old, value);
+		shadow[address] = mockIo[address];
+		mock.activity++;
+		prvDispatch();
+		return;
+	}
+	outer = prvBegin();
+	old = mockIo[address];
+	mockIo[address] = value;
+	prvWrite(address, old, value);
+	prvEnd(outer);
+}
+
+uint32_t ulMockInterruptCount(void) {
+	return mock.interrupts;
+}
+
+uint32_t ulMockCcpViolations(void) {
+	return mock.ccpViolations;
+}
+
+void vMockResetHook(mockResetHook_t hook) {
+	resetHook = hook;
+}
+
+void vMockPinDrive(uint8_t port, uint8_t mask, uint8_t levels) {
+	uint8_t outer;
+
+	if(port >= MOCK_PORT_COUNT) {
+		return;
+	}
+	outer = prvBegin();
+	mock.ports[port].extMask |= mask;
+	mock.ports[port].extLevels = (mock.ports[port].extLevels & ~mask) | (levels & mask);
+	prvPortUpdate(port);
+	prvEnd(outer);
+}
+
+void vMockPinRelease(uint8_t port, uint8_t mask) {
+	uint8_t outer;
+
+	if(port >= MOCK_PORT_COUNT) {
+		return;
+	}
+	outer = prvBegin();
+	mock.ports[port].extMask &= ~mask;
+	prvPortUpdate(port);
+	prvEnd(outer);
+}
+
+uint8_t ucMockPinLevels(uint8_t port) {
+	return (port < MOCK_PORT_COUNT) ? mock.ports[port].pins : 0;
+}
+
+void vMockPinHook(mockPinHook_t hook) {
+	pinHook = hook;
+}
+
+uint32_t ulMockPinLog(const mockPinEvent_t **events) {
+	*events = pinLog;
+	return pinLogCount;
+}
+
+void vMockPinLogClear(void) {
+	pinLogCount = 0;
+}
+
+void vMockUartHook(mockUartHook_t hook) {
+	uartHook = hook;
+}
+
+uint8_t ucMockUartReceive(uint8_t usart, uint8_t data) {
+	mockUart_t *uart;
+	uint8_t outer;
+
+	if(usart >= MOCK_USART_COUNT || !(prvUart(usart)->CTRLB & USART_RXEN_bm)) {
+		return 0;
+	}
+	outer = prvBegin();
+	uart = &mock.uarts[usart];
+	if(uart->rxCount == sizeof(uart->rx)) {
+		prvUart(usart)->STATUS |= USART_BUFOVF_bm;
+		prvEnd(outer);
+		return 0;
+	}
+	uart->rx[uart->rxCount++] = data;
+	prvUart(usart)->DATA = uart->rx[0];
+	prvUart(usart)->STATUS |= USART_RXCIF_bm;
+	prvEnd(outer);
+	return 1;
+}
@@ -0,0 +1,144 @@
+/*
+ * mockHal.h
+ *
+ * Created: 19.10.2026 03:48:14
+ *  Author: agent
+ *
+ * Register-level mock of the ATxmega128A3U for host builds.
+ *
+ * The headers in tools/hostmock replace avr-libc, so driver/ and the code on
+ * top of it compile unchanged with gcc. The register blocks live in the plain
+ * array mockIo, the firmware reads and writes it like memory. The models run
+ * when they are ticked: vMockAdvanceCycles() and the other calls below, nop()
+ * in a polling loop and vMockSync(). A tick first applies what the firmware
+ * wrote since the last one (strobe registers, flags cleared by writing one,
+ * CCP protection, ...), then lets the time pass and serves the interrupts on
+ * the way. A read returns the state of the last tick. Everything runs on one
+ * thread and is deterministic.
+ *
+ * Models:
+ *   - CLK/OSC: oscillators get ready some time after they are enabled, the
+ *     system clock only switches to a ready source, PLL and prescalers set
+ *     the CPU clock (XOSC is 8MHz, see vMockSetXoscHz()). CCP and CLK.LOCK
+ *     are enforced.
+ *   - TCxn: up-counting with the prescaler or an event channel (overflows of
+ *     another timer through EVSYS.CHnMUX), PER/CCx buffers, compare and
+ *     overflow flags, the commands of CTRLF. Dual slope and capture are not
+ *     modelled.
+ *   - PORTx/VPORTn: DIR/OUT with the strobe registers, pull-ups, inversion,
+ *     pin interrupts. Every change of a pin level is logged with its time.
+ *   - USARTxn: TX bytes leave after one frame time at the programmed baud
+ *     rate (hook), RX bytes are injected with ucMockUartReceive().
+ *   - PMIC/SREG: three levels, a higher level interrupts a lower one.
+ *   - RST: reset flags, a software reset calls the reset hook.
+ *
+ * Build a driver on the host from the repository root, e.g.
+ *
+ *   gcc -O2 -DF_CPU=32000000UL -Itools/hostmock -IU_PiCalc_HS2023/includes \
+ *       -IU_PiCalc_HS2023/driver -o check check.c tools/hostmock/mockHal.c \
+ *       U_PiCalc_HS2023/driver/TC_driver.c U_PiCalc_HS2023/driver/clksys_driver.c
+ *
+ * Limits: code that jumps into the hardware with inline assembly (the naked
+ * tick ISR and the context switch of FreeRTOS/port.c) cannot run on the host.
+ * Writes between two ticks are applied in address order, the timer commands
+ * of CTRLFSET/CTRLFCLR after the others, and only the last value of a
+ * register counts: write a register twice, toggle twice with
+ * OUTTGL or write the value it reads (a read-modify-write of INTFLAGS) and the
+ * mock sees one write or none. Strobe registers (DIRSET, OUTCLR, CTRLFSET,
+ * CCP, ...) read 0, the INTFLAGS of TCxn and PORTx, USARTxn.STATUS,
+ * RST.STATUS and OSC.XOSCFAIL read with a reserved bit set. A loop that polls
+ * TCxn.CNT sees it move from one model event to the next. Reads have no side
+ * effect, the received byte leaves USARTxn.DATA when the RXC ISR returns.
+ */
+
+
+#ifndef MOCKHAL_H_
+#define MOCKHAL_H_
+
+#include <stdint.h>
+
+#define MOCK_XOSC_HZ			8000000UL
+#define MOCK_PIN_LOG_SIZE		4096
+#define MOCK_IO(reg)			((uint16_t) ((uintptr_t) &(reg) - (uintptr_t) mockIo))	//device address of a register
+
+#define MOCK_PORTA				0
+#define MOCK_PORTB				1
+#define MOCK_PORTC				2
+#define MOCK_PORTD				3
+#define MOCK_PORTE				4
+#define MOCK_PORTF				5
+#define MOCK_PORTR				6
+#define MOCK_PORT_COUNT			7
+
+#define MOCK_USARTC0			0
+#define MOCK_USARTC1			1
+#define MOCK_USARTD0			2
+#define MOCK_USARTD1			3
+#define MOCK_USARTE0			4
+#define MOCK_USARTF0			5
+#define MOCK_USART_COUNT		6
+
+typedef struct {
+	uint64_t timeNS;
+	uint8_t port;			//MOCK_PORTx
+	uint8_t levels;			//pin levels after the change
+	uint8_t changed;		//pins that changed
+} mockPinEvent_t;
+
+// Hooks run inside the models: they may drive and release pins, nothing else
+typedef void (*mockPinHook_t)(const mockPinEvent_t *event);
+typedef void (*mockUartHook_t)(uint8_t usart, uint8_t data, uint64_t timeNS);
+typedef void (*mockResetHook_t)(void);
+
+/*---------------------------------------------------------------------------------*/
+// Virtual time. The models only move when one of these is called, interrupts are
+// served on the way.
+/*---------------------------------------------------------------------------------*/
+void vMockReset(void);							//power-on state, time 0, the EEPROM is kept
+uint64_t ullMockCycles(void);					//CPU cycles since the reset
+uint64_t ullMockTimeNS(void);
+uint32_t ulMockCpuHz(void);
+void vMockSync(void);							//applies the writes and serves interrupts, no time passes
+void vMockNop(void);							//nop() of a polling loop, the second one in a row jumps to the next change
+void vMockAdvanceCycles(uint64_t cycles);
+void vMockAdvanceNS(uint64_t ns);
+void vMockSleep(void);							//sleep_cpu(): runs until an interrupt was served
+void vMockWaitForInterrupt(void);				//same without SLEEP.CTRL, a busy loop that only waits
+void vMockSetXoscHz(uint32_t hz);
+
+/*---------------------------------------------------------------------------------*/
+// Interrupts
+/*---------------------------------------------------------------------------------*/
+void vMockSei(void);
+void vMockCli(void);
+uint32_t ulMockInterruptCount(void);			//ISRs served since the reset
+uint32_t ulMockCcpViolations(void);				//protected writes without CCP, they were ignored
+void vMockResetHook(mockResetHook_t hook);		//software reset, without a hook the program exits
+
+/*---------------------------------------------------------------------------------*/
+// Register access for code that runs next to the firmware (tools/hostsim) and for
+// timed sequences (CCPWrite), without cycles. Applied right away, a read returns
+// the value after the pending writes, a write serves the interrupts it unmasks.
+// address is MOCK_IO(reg).
+/*---------------------------------------------------------------------------------*/
+uint8_t ucMockRegRead(uint16_t address);
+void vMockRegWrite(uint16_t address, uint8_t value);
+
+/*---------------------------------------------------------------------------------*/
+// Pins. Input pins follow the external level set here, undriven pins follow
+// the pull configuration of PINnCTRL.
+/*---------------------------------------------------------------------------------*/
+void vMockPinDrive(uint8_t port, uint8_t mask, uint8_t levels);
+void vMockPinRelease(uint8_t port, uint8_t mask);
+uint8_t ucMockPinLevels(uint8_t port);
+void vMockPinHook(mockPinHook_t hook);
+uint32_t ulMockPinLog(const mockPinEvent_t **events);	//events since the last clear, at most MOCK_PIN_LOG_SIZE
+void vMockPinLogClear(void);
+
+/*---------------------------------------------------------------------------------*/
+// USART
+/*---------------------------------------------------------------------------------*/
+void vMockUartHook(mockUartHook_t hook);		//called for every byte with the time it starts to shift out
+uint8_t ucMockUartReceive(uint8_t usart, uint8_t data);	//0 if the receiver is off or full
+
+#endif /* MOCKHAL_H_ */
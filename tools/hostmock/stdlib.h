@@ -0,0 +1,62 @@
+/*
+ * stdlib.h
+ *
+ * Created: 19.10.2026 04:08:09
+ *  Author: agent
+ *
+ * The C library's stdlib.h plus the conversions avr-libc adds to it (itoa,
+ * ultoa, ...), which the display, UART and profiler code use.
+ */
+
+
+#ifndef MOCK_STDLIB_H_
+#define MOCK_STDLIB_H_
+
+#include_next <stdlib.h>
+#include <stdint.h>
+
+static inline char *ultoa(unsigned long value, char *s, int radix) {
+	char digits[8 * sizeof(value) + 1];
+	uint8_t count = 0;
+	char *p = s;
+
+	if(radix < 2 || radix > 36) {
+		*s = '\0';
+		return s;
+	}
+	do {
+		uint8_t digit = value % radix;
+		digits[count++] = digit < 10 ? '0' + digit : 'a' + digit - 10;
+		value /= radix;
+	} while(value > 0);
+	while(count > 0) {
+		*p++ = digits[--count];
+	}
+	*p = '\0';
+	return s;
+}
+
+static inline char *ltoa(long value, char *s, int radix) {
+	// like avr-libc, only base 10 has a sign
+	if(value < 0 && radix == 10) {
+		*s = '-';
+		ultoa(-(unsigned long) value, s + 1, radix);
+		return s;
+	}
+	return ultoa((unsigned long) value, s, radix);
+}
+
+static inline char *utoa(unsigned int value, char *s, int radix) {
+	return ultoa(value, s, radix);
+}
+
+static inline char *itoa(int value, char *s, int radix) {
+	if(value < 0 && radix == 10) {
+		*s = '-';
+		ultoa(-(unsigned long) value, s + 1, radix);
+		return s;
+	}
+	return ultoa((unsigned int) value, s, radix);
+}
+
+#endif /* MOCK_STDLIB_H_ */
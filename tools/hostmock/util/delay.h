@@ -0,0 +1,24 @@
+/*
+ * delay.h
+ *
+ * Created: 19.10.2026 03:48:14
+ *  Author: agent
+ *
+ * Host replacement of <util/delay.h>, the busy wait advances the virtual clock.
+ */
+
+
+#ifndef MOCK_UTIL_DELAY_H_
+#define MOCK_UTIL_DELAY_H_
+
+#include "avr/io.h"
+
+static inline void _delay_us(double us) {
+	vMockAdvanceNS((uint64_t) (us * 1000.0 + 0.5));
+}
+
+static inline void _delay_ms(double ms) {
+	vMockAdvanceNS((uint64_t) (ms * 1000000.0 + 0.5));
+}
+
+#endif /* MOCK_UTIL_DELAY_H_ */
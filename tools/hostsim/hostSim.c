@@ -0,0 +1,454 @@
+/*
+ * hostSim.c
+ *
+ * Created: 19.10.2026 04:08:09
+ *  Author: agent
+ *
+ * Virtual time simulation of the whole firmware on the host. main.c runs
+ * unchanged on tools/hostmock with the FreeRTOS port of port.c: the tick,
+ * vTaskDelay, the display delays and the bench clock all follow the virtual
+ * clock of the mock, nothing sleeps, and an idle CPU jumps to the next
+ * interrupt. A minute of device time with the display and an engine running
+ * takes about a second. The run only depends on the scenario, the output is
+ * the same bit for bit on every run.
+ *
+ * Code that does not touch a register costs no virtual time by itself. The
+ * build instruments the firmware (-finstrument-functions), every call of a
+ * function in the cost table charges its cycles (SIM_COST_* in hostSim.h,
+ * "cost" lines of the scenario). The defaults cover the engine terms, so the
+ * BENCH, CLOCK and time-to-digits results are in virtual device time.
+ *
+ * Build from the repository root:
+ *
+ *   gcc -O2 -DF_CPU=32000000UL -DHOSTSIM=1 -fsingle-precision-constant \
+ *       -include tools/hostsim/portmacro.h -Itools/hostsim -Itools/hostmock \
+ *       -IU_PiCalc_HS2023/includes -IU_PiCalc_HS2023/driver \
+ *       -IU_PiCalc_HS2023/FreeRTOS/include -finstrument-functions \
+ *       -finstrument-functions-exclude-file-list=tools/,FreeRTOS/ -rdynamic \
+ *       -o hostsim tools/hostsim/{hostSim,port}.c tools/hostmock/{mockHal,hd44780}.c \
+ *       U_PiCalc_HS2023/{,driver/}*.c \
+ *       U_PiCalc_HS2023/FreeRTOS/{croutine,event_groups,heap_1,list,queue,stream_buffer,tasks,timers}.c
+ *
+ *   ./hostsim tools/hostsim/leibniz.scn
+ *
+ * tools/hosttests.py builds it like this and runs leibniz.scn, with
+ * -DCALC_USE_COROUTINES=1 coroutines.scn and with -DDISPLAY_USE_BUSY_FLAG=1
+ * -DDISPLAY_USE_TX_ENGINE=0 busyflag.scn.
+ *
+ * Scenario, one command per line, # starts a comment:
+ *
+ *   cost <function> <cycles>    cycles per call of a firmware function
+ *   <ms> <action>               action at a virtual time, +<ms> is relative
+ *                               to the previous action
+ *
+ *   press <1-4> [<held ms>]     press S1..S4, 100ms if no time is given
+ *   chord <a> <b> [<held ms>]   press two buttons together
+ *   expect <line> <text>        display line 0..3 must show text (trailing
+ *                               blanks ignored, a trailing * matches a prefix)
+ *   uart <text>                 the UART sent text after the match of the
+ *                               last uart check
+ *   screen                      print the display
+ *   lcd <stuck|ok>              stuck: the display reads busy on every busy
+ *                               flag read, ok: it follows its execution time
+ *   lcdpoll <min us> <max us>   the longest busy flag poll (first to last
+ *                               read before a write) since the last lcdpoll
+ *                               lasted min..max us
+ *   end                         print the summary and exit
+ *
+ * UART lines go to stdout with their virtual time, failed checks, display
+ * instructions sent before the previous one was executed and the summary too.
+ * Exit code 1 if a check failed or the display got an instruction too early.
+ *
+ * Limits: the cost table is an estimate, calibrate it against the BENCH and
+ * CLOCK reports of the board. double and float are both 32 bit on the AVR,
+ * -fsingle-precision-constant keeps the constants in float, but int is 32 bit
+ * on the host. Interrupts only happen when the mock is ticked, at calls and
+ * returns of the firmware, nop() and charged time, not within a long
+ * calculation of uncharged code.
+ */
+#include <dlfcn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "avr/io.h"
+#include "mockHal.h"
+#include "hd44780.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "hostSim.h"
+
+#define SIM_MAX_ACTIONS		1024
+#define SIM_TEXT_SIZE		64
+#define SIM_UART_SIZE		16384	//UART text kept for the uart check, the newest half survives an overflow
+#define SIM_PRESS_MS		100
+
+#define BUTTON_PINS			0xF0	//S1..S4 on PORTF 4..7, low active with external pull-ups
+
+
+typedef enum {
+	ACTION_PRESS,
+	ACTION_EXPECT,
+	ACTION_UART,
+	ACTION_SCREEN,
+	ACTION_LCD,
+	ACTION_LCD_POLL,
+	ACTION_END,
+} simActionKind_t;
+
+typedef struct {
+	uint32_t tick;
+	uint8_t kind;
+	uint8_t buttons;		//pin mask of press and chord
+	uint8_t line;
+	uint8_t prefix;
+	uint32_t heldMS;
+	uint8_t lcdStuck;
+	uint32_t minUS;
+	uint32_t maxUS;
+	char text[SIM_TEXT_SIZE];
+	uint32_t sourceLine;
+} simAction_t;
+
+typedef struct {
+	void *function;
+	uint32_t cycles;
+	char name[SIM_TEXT_SIZE];
+} simCost_t;
+
+static simAction_t actions[SIM_MAX_ACTIONS];
+static uint32_t actionCount = 0;
+static uint32_t nextAction = 0;
+static simCost_t costs[SIM_MAX_COSTS];
+static uint8_t costCount = 0;
+static uint32_t releaseTick[4];
+static uint32_t failures = 0;
+static char uartLine[256];
+static uint16_t uartLineLength = 0;
+static char uartText[SIM_UART_SIZE];
+static uint16_t uartTextLength = 0;
+static struct timespec hostStart;
+
+/*---------------------------------------------------------------------------------*/
+// Cost table
+/*---------------------------------------------------------------------------------*/
+static void prvCostSet(const char *name, uint32_t cycles) {
+	void *function = dlsym(RTLD_DEFAULT, name);
+
+	if(function == NULL) {
+		fprintf(stderr, "hostsim: cost: no function %s (build with -rdynamic)\n", name);
+		exit(EXIT_FAILURE);
+	}
+	for(uint8_t i = 0; i < costCount; i++) {
+		if(costs[i].function == function) {
+			costs[i].cycles = cycles;
+			return;
+		}
+	}
+	if(costCount == SIM_MAX_COSTS) {
+		fprintf(stderr, "hostsim: more than SIM_MAX_COSTS costs\n");
+		exit(EXIT_FAILURE);
+	}
+	costs[costCount].function = function;
+	costs[costCount].cycles = cycles;
+	snprintf(costs[costCount].name, SIM_TEXT_SIZE, "%s", name);
+	costCount++;
+}
+
+// Every call and return of the firmware ticks the mock without time, so the
+// register writes reach the models in order (the E edges of the display bus)
+void __cyg_profile_func_enter(void *function, void *caller) {
+	vMockSync();
+	for(uint8_t i = 0; i < costCount; i++) {
+		if(costs[i].function == function) {
+			vPortCharge(costs[i].cycles);
+			return;
+		}
+	}
+}
+
+void __cyg_profile_func_exit(void *function, void *caller) {
+	vMockSync();
+}
+
+/*---------------------------------------------------------------------------------*/
+// Display controller, tools/hostmock/hd44780.c
+/*---------------------------------------------------------------------------------*/
+static void prvLcdViolation(uint8_t rs, uint8_t value, uint64_t earlyNS, uint64_t timeNS) {
+	printf("[%10.3f ms] LCD %s 0x%02X sent %llu ns early\n", timeNS / 1e6, rs ? "data" : "command", value,
+		(unsigned long long) earlyNS);
+}
+
+/*---------------------------------------------------------------------------------*/
+// UART
+/*---------------------------------------------------------------------------------*/
+static void prvUartHook(uint8_t usart, uint8_t data, uint64_t timeNS) {
+	if(uartTextLength == SIM_UART_SIZE - 1) {
+		memmove(uartText, uartText + SIM_UART_SIZE / 2, uartTextLength - SIM_UART_SIZE / 2);
+		uartTextLength -= SIM_UART_SIZE / 2;
+	}
+	uartText[uartTextLength++] = data;
+	uartText[uartTextLength] = '\0';
+	if(data == '\r') {
+		return;
+	}
+	if(data == '\n' || uartLineLength > sizeof(uartLine) - 5) {
+		uartLine[uartLineLength] = '\0';
+		printf("[%10.3f ms] %s\n", timeNS / 1e6, uartLine);
+		uartLineLength = 0;
+		if(data == '\n') {
+			return;
+		}
+	}
+	if(data >= 0x20 && data < 0x7F) {
+		uartLine[uartLineLength++] = data;
+	} else {
+		uartLineLength += sprintf(uartLine + uartLineLength, "\\x%02X", data);
+	}
+}
+
+/*---------------------------------------------------------------------------------*/
+// Scenario
+/*---------------------------------------------------------------------------------*/
+static void prvSummary(void) {
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	printf("SIM END %llu ms, %lu ticks, %llu cycles, %lu interrupts, %lu lcd violations, %lu failures\n",
+		(unsigned long long) (ullMockTimeNS() / 1000000ULL), (unsigned long) xTaskGetTickCountFromISR(),
+		(unsigned long long) ullMockCycles(), (unsigned long) ulMockInterruptCount(),
+		(unsigned long) ulHd44780Violations(), (unsigned long) failures);
+	fprintf(stderr, "hostsim: %.3f s host time\n",
+		(now.tv_sec - hostStart.tv_sec) + (now.tv_nsec - hostStart.tv_nsec) / 1e9);
+	fflush(stdout);
+}
+
+static void prvFail(const simAction_t *action, const char *format, const char *text) {
+	failures++;
+	printf("[%10.3f ms] FAIL line %lu: ", ullMockTimeNS() / 1e6, (unsigned long) action->sourceLine);
+	printf(format, text);
+	printf("\n");
+}
+
+static void prvRun(const simAction_t *action, TickType_t tick) {
+	char text[SIM_TEXT_SIZE];
+	char *match;
+	uint64_t longestNS;
+	uint32_t polls;
+
+	switch(action->kind) {
+		case ACTION_PRESS:
+			vMockPinDrive(MOCK_PORTF, action->buttons, 0);
+			for(uint8_t b = 0; b < 4; b++) {
+				if(action->buttons & (0x10 << b)) {
+					releaseTick[b] = tick + action->heldMS / portTICK_PERIOD_MS;
+				}
+			}
+			break;
+		case ACTION_EXPECT:
+			vHd44780Text(action->line, text);
+			if(action->prefix ? strncmp(text, action->text, strlen(action->text)) != 0
+					: strcmp(text, action->text) != 0) {
+				for(int8_t i = 19; i >= 0 && text[i] == ' '; i--) {
+					text[i] = '\0';
+				}
+				prvFail(action, "display shows \"%s\"", text);
+			}
+			break;
+		case ACTION_UART:
+			match = strstr(uartText, action->text);
+			if(match == NULL) {
+				prvFail(action, "no \"%s\" on the UART", action->text);
+				uartTextLength = 0;
+			} else {
+				// the next check looks behind the match
+				match += strlen(action->text);
+				uartTextLength -= match - uartText;
+				memmove(uartText, match, uartTextLength);
+			}
+			uartText[uartTextLength] = '\0';
+			break;
+		case ACTION_SCREEN:
+			for(uint8_t line = 0; line < 4; line++) {
+				vHd44780Text(line, text);
+				printf("[%10.3f ms] |%s|\n", ullMockTimeNS() / 1e6, text);
+			}
+			break;
+		case ACTION_LCD:
+			vHd44780Stuck(action->lcdStuck);
+			break;
+		case ACTION_LCD_POLL:
+			polls = ulHd44780Polls(&longestNS);
+			snprintf(text, sizeof(text), "%lu polls, the longest %.3f us", (unsigned long) polls, longestNS / 1e3);
+			if(polls == 0 || longestNS < action->minUS * 1000ULL || longestNS > action->maxUS * 1000ULL) {
+				prvFail(action, "busy flag: %s", text);
+			}
+			vHd44780PollClear();
+			break;
+		case ACTION_END:
+			prvSummary();
+			exit(failures > 0 || ulHd44780Violations() > 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+	}
+}
+
+void vSimTickHook(TickType_t tick) {
+	for(uint8_t b = 0; b < 4; b++) {
+		if(releaseTick[b] != 0 && tick >= releaseTick[b]) {
+			releaseTick[b] = 0;
+			vMockPinDrive(MOCK_PORTF, 0x10 << b, 0x10 << b);
+		}
+	}
+	while(nextAction < actionCount && tick >= actions[nextAction].tick) {
+		prvRun(&actions[nextAction++], tick);
+	}
+}
+
+static uint8_t prvButtonPin(const char *button, uint32_t sourceLine) {
+	if(button == NULL || button[0] < '1' || button[0] > '4' || button[1] != '\0') {
+		fprintf(stderr, "hostsim: line %lu: button 1..4 expected\n", (unsigned long) sourceLine);
+		exit(EXIT_FAILURE);
+	}
+	return 0x10 << (button[0] - '1');
+}
+
+static void prvParse(const char *path) {
+	FILE *file = fopen(path, "r");
+	char buffer[256];
+	uint32_t sourceLine = 0;
+	uint32_t lastMS = 0;
+
+	if(file == NULL) {
+		perror(path);
+		exit(EXIT_FAILURE);
+	}
+	while(fgets(buffer, sizeof(buffer), file) != NULL) {
+		char *rest;
+		char *word;
+		simAction_t *action = &actions[actionCount];
+		uint32_t ms;
+
+		sourceLine++;
+		buffer[strcspn(buffer, "#\r\n")] = '\0';
+		word = strtok_r(buffer, " \t", &rest);
+		if(word == NULL) {
+			continue;
+		}
+		if(strcmp(word, "cost") == 0) {
+			char *name = strtok_r(NULL, " \t", &rest);
+			char *cycles = strtok_r(NULL, " \t", &rest);
+			if(name == NULL || cycles == NULL) {
+				fprintf(stderr, "hostsim: line %lu: cost <function> <cycles>\n", (unsigned long) sourceLine);
+				exit(EXIT_FAILURE);
+			}
+			prvCostSet(name, strtoul(cycles, NULL, 0));
+			continue;
+		}
+		if(actionCount == SIM_MAX_ACTIONS) {
+			fprintf(stderr, "hostsim: more than SIM_MAX_ACTIONS actions\n");
+			exit(EXIT_FAILURE);
+		}
+		ms = word[0] == '+' ? lastMS + strtoul(word + 1, NULL, 10) : strtoul(word, NULL, 10);
+		if(ms < lastMS) {
+			fprintf(stderr, "hostsim: line %lu: time goes backwards\n", (unsigned long) sourceLine);
+			exit(EXIT_FAILURE);
+		}
+		lastMS = ms;
+		memset(action, 0, sizeof(*action));
+		action->tick = ms / portTICK_PERIOD_MS;
+		action->sourceLine = sourceLine;
+		action->heldMS = SIM_PRESS_MS;
+		word = strtok_r(NULL, " \t", &rest);
+		if(word == NULL) {
+			fprintf(stderr, "hostsim: line %lu: action expected\n", (unsigned long) sourceLine);
+			exit(EXIT_FAILURE);
+		} else if(strcmp(word, "press") == 0 || strcmp(word, "chord") == 0) {
+			char *held;
+			action->kind = ACTION_PRESS;
+			action->buttons = prvButtonPin(strtok_r(NULL, " \t", &rest), sourceLine);
+			if(word[0] == 'c') {
+				action->buttons |= prvButtonPin(strtok_r(NULL, " \t", &rest), sourceLine);
+			}
+			held = strtok_r(NULL, " \t", &rest);
+			if(held != NULL) {
+				action->heldMS = strtoul(held, NULL, 10);
+			}
+		} else if(strcmp(word, "expect") == 0) {
+			char *line = strtok_r(NULL, " \t", &rest);
+			size_t length;
+			if(line == NULL || line[0] < '0' || line[0] > '3') {
+				fprintf(stderr, "hostsim: line %lu: expect <0-3> <text>\n", (unsigned long) sourceLine);
+				exit(EXIT_FAILURE);
+			}
+			action->kind = ACTION_EXPECT;
+			action->line = line[0] - '0';
+			rest += strspn(rest, " \t");
+			snprintf(action->text, 21, "%s", rest);
+			length = strlen(action->text);
+			if(length > 0 && action->text[length - 1] == '*') {
+				action->prefix = 1;
+				action->text[length - 1] = '\0';
+			} else {
+				// compare the whole line, the display pads with blanks
+				while(length > 0 && (action->text[length - 1] == ' ' || action->text[length - 1] == '\t')) {
+					length--;
+				}
+				memset(action->text + length, ' ', 20 - length);
+				action->text[20] = '\0';
+			}
+		} else if(strcmp(word, "uart") == 0) {
+			action->kind = ACTION_UART;
+			rest += strspn(rest, " \t");
+			snprintf(action->text, SIM_TEXT_SIZE, "%s", rest);
+		} else if(strcmp(word, "screen") == 0) {
+			action->kind = ACTION_SCREEN;
+		} else if(strcmp(word, "lcd") == 0) {
+			char *state = strtok_r(NULL, " \t", &rest);
+			if(state == NULL || (strcmp(state, "stuck") != 0 && strcmp(state, "ok") != 0)) {
+				fprintf(stderr, "hostsim: line %lu: lcd <stuck|ok>\n", (unsigned long) sourceLine);
+				exit(EXIT_FAILURE);
+			}
+			action->kind = ACTION_LCD;
+			action->lcdStuck = strcmp(state, "stuck") == 0;
+		} else if(strcmp(word, "lcdpoll") == 0) {
+			char *minUS = strtok_r(NULL, " \t", &rest);
+			char *maxUS = strtok_r(NULL, " \t", &rest);
+			if(minUS == NULL || maxUS == NULL) {
+				fprintf(stderr, "hostsim: line %lu: lcdpoll <min us> <max us>\n", (unsigned long) sourceLine);
+				exit(EXIT_FAILURE);
+			}
+			action->kind = ACTION_LCD_POLL;
+			action->minUS = strtoul(minUS, NULL, 10);
+			action->maxUS = strtoul(maxUS, NULL, 10);
+		} else if(strcmp(word, "end") == 0) {
+			action->kind = ACTION_END;
+		} else {
+			fprintf(stderr, "hostsim: line %lu: unknown action %s\n", (unsigned long) sourceLine, word);
+			exit(EXIT_FAILURE);
+		}
+		actionCount++;
+	}
+	fclose(file);
+	if(actionCount == 0 || actions[actionCount - 1].kind != ACTION_END) {
+		fprintf(stderr, "hostsim: the scenario has to end with an end action\n");
+		exit(EXIT_FAILURE);
+	}
+}
+
+// Runs before main() of the firmware, after the constructor of the mock. glibc
+// passes the arguments of the program to constructors.
+__attribute__((constructor(102))) static void prvSimInit(int argc, char **argv, char **envp) {
+	if(argc != 2) {
+		fprintf(stderr, "usage: %s <scenario>\n", argv[0]);
+		exit(EXIT_FAILURE);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &hostStart);
+	prvCostSet("fPiLeibnizTerm", SIM_COST_LEIBNIZ);
+	prvCostSet("fPiNilakanthaTerm", SIM_COST_NILAKANTHA);
+	prvParse(argv[1]);
+
+	vHd44780Reset();
+	vHd44780ViolationHook(prvLcdViolation);
+	vMockUartHook(prvUartHook);
+	vMockPinDrive(MOCK_PORTF, BUTTON_PINS, BUTTON_PINS);
+}
+// EOF file hostSim.c
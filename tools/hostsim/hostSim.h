@@ -0,0 +1,43 @@
+/*
+ * hostSim.h
+ *
+ * Created: 19.10.2026 04:08:09
+ *  Author: agent
+ *
+ * Interface between the host FreeRTOS port (port.c) and the scenario runner
+ * (hostSim.c) of the virtual time simulation, see hostSim.c.
+ */
+
+
+#ifndef HOSTSIM_H_
+#define HOSTSIM_H_
+
+#include <stdint.h>
+#include "FreeRTOS.h"
+
+#define SIM_MAX_TASKS			12				//xTaskCreate calls, incl. IDLE and the timer daemon
+#define SIM_TASK_STACK			(256 * 1024UL)	//host stack per task, the ISRs of the mock run on it too
+
+/*---------------------------------------------------------------------------------*/
+// Cycles charged for code that does not touch a register. Estimates for the
+// -Os build at 32MHz, calibrate them against the BENCH and CLOCK reports of the
+// board. Engine terms include the bookkeeping of the step in main.c.
+/*---------------------------------------------------------------------------------*/
+#define SIM_COST_CRITICAL		11		//portENTER_CRITICAL + portEXIT_CRITICAL (lds/push/sts, pop/sts)
+#define SIM_COST_SWITCH			190		//portSAVE_CONTEXT, vTaskSwitchContext, portRESTORE_CONTEXT
+#define SIM_COST_TICK			120		//tick ISR entry and exit, xTaskIncrementTick
+#define SIM_COST_LEIBNIZ		760		//fPiLeibnizTerm: (float) 2i+1, 4/x, add, 2 compares
+#define SIM_COST_NILAKANTHA		1250	//fPiNilakanthaTerm: 3 conversions, 2 mul, 4/x, add, 2 compares
+#define SIM_MAX_COSTS			32
+
+/*---------------------------------------------------------------------------------*/
+// port.c
+/*---------------------------------------------------------------------------------*/
+void vPortCharge(uint32_t cycles);		//advances the virtual clock for work of the current task
+
+/*---------------------------------------------------------------------------------*/
+// hostSim.c
+/*---------------------------------------------------------------------------------*/
+void vSimTickHook(TickType_t tick);		//called by the tick ISR after the tick count was incremented
+
+#endif /* HOSTSIM_H_ */
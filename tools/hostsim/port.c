@@ -0,0 +1,328 @@
+/*
+ * port.c
+ *
+ * Created: 19.10.2026 04:08:09
+ *  Author: agent
+ *
+ * FreeRTOS port of the host simulation, replaces FreeRTOS/port.c. Every task
+ * runs on its own host stack (makecontext for the start, _longjmp for the
+ * switches), all of them on one thread. The tick
+ * is the TCC0 overflow of tools/hostmock, set up like the xmega port does it,
+ * so it follows the virtual clock and the clock profiles of init.c.
+ *
+ * The tick ISR (and every other ISR) only runs when the mock is ticked: a
+ * vMockAdvanceCycles(), the sync at every function entry and exit of the
+ * firmware (hostSim.c) or the nop() of a polling loop. It never
+ * switches there: it marks the switch pending and the switch happens at the
+ * next point where the task could have been interrupted on the target with
+ * the kernel level enabled - the end of a critical section, a charge of
+ * cycles or the idle hook. The task stack arrays of the firmware only hold a
+ * frame of the size the xmega port puts there, so the stack monitor and the
+ * profiler find what they expect.
+ */
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ucontext.h>
+#include "avr_compiler.h"
+#include "TC_driver.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "hostSim.h"
+
+#define portFRAME_SIZE			40		//3 markers, 3 byte PC, r31, SREG, PMIC.CTRL, r0..r30 (FreeRTOS/port.c)
+#define portFRAME_SLOT			7		//offset of R24 in the frame, the index into tasks[] here
+#define portCLOCK_PRESCALER_TIMER0	( ( unsigned portLONG ) 64 )
+
+#if configMAX_SYSCALL_INTERRUPT_PRIORITY == 0
+	#define PMIC_BITS (PMIC_LOLVLEN_bm)
+#elif configMAX_SYSCALL_INTERRUPT_PRIORITY == 1
+	#define PMIC_BITS (PMIC_LOLVLEN_bm | PMIC_MEDLVLEN_bm)
+#elif configMAX_SYSCALL_INTERRUPT_PRIORITY == 2
+	#define PMIC_BITS (PMIC_LOLVLEN_bm | PMIC_MEDLVLEN_bm | PMIC_HILVLEN_bm)
+#endif
+#define ALL_PMIC_BITS	(PMIC_LOLVLEN_bm | PMIC_MEDLVLEN_bm | PMIC_HILVLEN_bm)
+#define PMIC_EXECUTING	(PMIC_LOLVLEX_bm | PMIC_MEDLVLEX_bm | PMIC_HILVLEX_bm)
+
+typedef struct {
+	ucontext_t context;			//first start only
+	jmp_buf jump;				//switches, without the signal mask syscalls of swapcontext
+	uint8_t started;
+	TaskFunction_t code;
+	void *parameters;
+	UBaseType_t criticalNesting;
+	uint8_t criticalCtrl;		//PMIC.CTRL before the outermost critical section
+	uint8_t pmicCtrl;			//PMIC.CTRL while the task is switched out
+} simTask_t;
+
+/* We require the address of the pxCurrentTCB variable, but don't want to know
+any details of its type. */
+typedef void tskTCB;
+extern volatile tskTCB * volatile pxCurrentTCB;
+
+static simTask_t tasks[SIM_MAX_TASKS + 1];	//[0] is main() until the scheduler starts
+static uint8_t taskCount = 1;
+static simTask_t *current = &tasks[0];
+static uint8_t schedulerRunning = 0;
+static volatile uint8_t switchPending = 0;
+
+static void prvSetupTimerInterrupt( void );
+
+static uint8_t prvPmicRead( void )
+{
+	return ucMockRegRead( MOCK_IO( PMIC.CTRL ) );
+}
+
+static void prvPmicWrite( uint8_t value )
+{
+	vMockRegWrite( MOCK_IO( PMIC.CTRL ), value );
+}
+
+static simTask_t *prvCurrentTask( void )
+{
+	StackType_t *pxTopOfStack = *( StackType_t * volatile * ) pxCurrentTCB;	//first TCB member
+	return &tasks[ pxTopOfStack[ portFRAME_SLOT ] ];
+}
+
+// Could the tick ISR be taken right now on the target?
+static uint8_t prvCanSwitch( void )
+{
+	return schedulerRunning && current->criticalNesting == 0
+		&& ( ucMockRegRead( MOCK_IO( SREG ) ) & CPU_I_bm )
+		&& !( ucMockRegRead( MOCK_IO( PMIC.STATUS ) ) & PMIC_EXECUTING )
+		&& ( prvPmicRead() & ( PMIC_LOLVLEN_bm << configKERNEL_INTERRUPT_PRIORITY ) );
+}
+
+static void prvSafePoint( void )
+{
+	if( switchPending && prvCanSwitch() )
+	{
+		vPortYield();
+	}
+}
+
+static void prvResume( simTask_t *task )
+{
+	if( task->started )
+	{
+		_longjmp( task->jump, 1 );
+	}
+	task->started = 1;
+	setcontext( &task->context );
+}
+
+static void prvTaskEntry( void )
+{
+	simTask_t *task = current;
+
+	// the first context of the xmega port has SREG.I and all levels enabled
+	vMockRegWrite( MOCK_IO( SREG ), ucMockRegRead( MOCK_IO( SREG ) ) | CPU_I_bm );
+	prvPmicWrite( task->pmicCtrl );
+	prvSafePoint();
+	task->code( task->parameters );
+	fprintf( stderr, "hostsim: a task returned\n" );
+	abort();
+}
+
+//-----------------------------------------------------------
+
+portSTACK_TYPE *pxPortInitialiseStack( portSTACK_TYPE *pxTopOfStack, pdTASK_CODE pxCode, void *pvParameters )
+{
+	simTask_t *task;
+
+	if( taskCount > SIM_MAX_TASKS )
+	{
+		fprintf( stderr, "hostsim: more than SIM_MAX_TASKS tasks\n" );
+		exit( EXIT_FAILURE );
+	}
+	task = &tasks[ taskCount ];
+	task->code = pxCode;
+	task->parameters = pvParameters;
+	task->criticalNesting = 0;
+#if configENABLE_ROUND_ROBIN == 1
+	task->pmicCtrl = ALL_PMIC_BITS | PMIC_RREN_bm;
+#else
+	task->pmicCtrl = ALL_PMIC_BITS;
+#endif
+	getcontext( &task->context );
+	task->context.uc_stack.ss_sp = malloc( SIM_TASK_STACK );
+	task->context.uc_stack.ss_size = SIM_TASK_STACK;
+	task->context.uc_link = NULL;
+	if( task->context.uc_stack.ss_sp == NULL )
+	{
+		perror( "hostsim: task stack" );
+		exit( EXIT_FAILURE );
+	}
+	makecontext( &task->context, prvTaskEntry, 0 );
+
+	pxTopOfStack -= portFRAME_SIZE;
+	memset( pxTopOfStack + 1, 0, portFRAME_SIZE );
+	pxTopOfStack[ portFRAME_SLOT ] = taskCount++;
+	return pxTopOfStack;
+}
+
+BaseType_t xPortStartScheduler( void )
+{
+	/* Setup the hardware to generate the tick. */
+	prvSetupTimerInterrupt();
+
+	schedulerRunning = 1;
+	tasks[ 0 ].pmicCtrl = prvPmicRead();
+	current = prvCurrentTask();
+	if( _setjmp( tasks[ 0 ].jump ) == 0 )
+	{
+		prvResume( current );
+	}
+
+	/* Should not get here. */
+	return pdTRUE;
+}
+
+void vPortEndScheduler( void )
+{
+	/* Like the xmega port, the simulation ends with exit(). */
+}
+
+//-----------------------------------------------------------
+//
+// Manual context switch, also the deferred switch of the tick ISR. Another
+// tick during the switch makes the loop switch again.
+//
+void vPortYield( void )
+{
+	if( ucMockRegRead( MOCK_IO( PMIC.STATUS ) ) & PMIC_EXECUTING )
+	{
+		switchPending = 1;
+		return;
+	}
+	do
+	{
+		simTask_t *from = current;
+
+		from->pmicCtrl = prvPmicRead();
+		prvPmicWrite( from->pmicCtrl & ~PMIC_BITS );
+		switchPending = 0;
+		vMockAdvanceCycles( SIM_COST_SWITCH );
+		vTaskSwitchContext();
+		current = prvCurrentTask();
+		if( current != from && _setjmp( from->jump ) == 0 )
+		{
+			prvResume( current );
+		}
+		prvPmicWrite( from->pmicCtrl );
+	} while( switchPending && prvCanSwitch() );
+}
+
+void vPortYieldFromISR( BaseType_t xSwitchRequired )
+{
+	if( xSwitchRequired != pdFALSE )
+	{
+		switchPending = 1;
+	}
+}
+
+void vPortCharge( uint32_t cycles )
+{
+	vMockAdvanceCycles( cycles );
+	prvSafePoint();
+}
+
+//-----------------------------------------------------------
+
+void vPortEnterCritical( void )
+{
+	uint8_t ctrl = prvPmicRead();
+
+	prvPmicWrite( ctrl & ~PMIC_BITS );
+	if( current->criticalNesting++ == 0 )
+	{
+		current->criticalCtrl = ctrl;
+	}
+}
+
+void vPortExitCritical( void )
+{
+	if( current->criticalNesting > 0 && --current->criticalNesting == 0 )
+	{
+		prvPmicWrite( current->criticalCtrl );
+	}
+	vPortCharge( SIM_COST_CRITICAL );
+}
+
+UBaseType_t uxPortSetInterruptMask( void )
+{
+	uint8_t ctrl = prvPmicRead();
+
+	prvPmicWrite( ctrl & ~PMIC_BITS );
+	return ctrl;
+}
+
+void vPortClearInterruptMask( UBaseType_t uxSavedInterruptStatus )
+{
+	prvPmicWrite( uxSavedInterruptStatus );
+	prvSafePoint();
+}
+
+void vPortEnableInterrupts( void )
+{
+#if configENABLE_ROUND_ROBIN == 1
+	prvPmicWrite( prvPmicRead() | PMIC_BITS | PMIC_RREN_bm );
+#else
+	prvPmicWrite( prvPmicRead() | PMIC_BITS );
+#endif
+	prvSafePoint();
+}
+
+void vPortDisableInterrupts( void )
+{
+	prvPmicWrite( prvPmicRead() & ~PMIC_BITS );
+}
+
+//-----------------------------------------------------------
+//
+// The xmega port switches at the end of every tick ISR, here it is deferred.
+//
+ISR(TCC0_OVF_vect)
+{
+	UBaseType_t uxSavedPmicCtrlReg;
+
+	vMockAdvanceCycles( SIM_COST_TICK );
+	uxSavedPmicCtrlReg = uxPortSetInterruptMask();
+	xTaskIncrementTick();
+	vPortClearInterruptMask( uxSavedPmicCtrlReg );
+	switchPending = 1;
+	vSimTickHook( xTaskGetTickCountFromISR() );
+}
+
+// The idle task of the target spins until the next interrupt, here the clock
+// jumps there.
+void vApplicationIdleHook( void )
+{
+	vMockWaitForInterrupt();
+	prvSafePoint();
+}
+
+//-----------------------------------------------------------
+//
+// Setup of 16bit timer C0 to generate a tick interrupt in case of overflow,
+// as in FreeRTOS/port.c.
+//
+static void prvSetupTimerInterrupt( void )
+{
+	unsigned portLONG ulOvfMatch;
+
+	ulOvfMatch = configCPU_CLOCK_HZ / configTICK_RATE_HZ;
+	ulOvfMatch /= portCLOCK_PRESCALER_TIMER0;
+	ulOvfMatch -= ( unsigned portLONG ) 1;
+	TC_SetPeriod( &TCC0, ulOvfMatch);
+	TC0_ConfigClockSource( &TCC0, TC_CLKSEL_DIV64_gc);
+#if   configKERNEL_INTERRUPT_PRIORITY == 0
+	TC0_SetOverflowIntLevel( &TCC0, TC_OVFINTLVL_LO_gc);
+#elif configKERNEL_INTERRUPT_PRIORITY == 1
+	TC0_SetOverflowIntLevel( &TCC0, TC_OVFINTLVL_MED_gc);
+#elif configKERNEL_INTERRUPT_PRIORITY == 2
+	TC0_SetOverflowIntLevel( &TCC0, TC_OVFINTLVL_HI_gc);
+#endif
+}
+// EOF file port.c
@@ -0,0 +1,81 @@
+/*
+ * portmacro.h
+ *
+ * Created: 19.10.2026 04:08:09
+ *  Author: agent
+ *
+ * FreeRTOS port macros of the host simulation (tools/hostsim/port.c). The build
+ * pre-includes this file with -include, it takes the include guard of
+ * FreeRTOS/include/portmacro.h so the xmega macros are never seen.
+ *
+ * The types are the ones of the xmega port (8 bit stacks and base types, 32 bit
+ * ticks), so stack sizes and the kernel behave as on the target. Critical
+ * sections mask the interrupt levels in PMIC.CTRL of tools/hostmock like the
+ * xmega port does, but nest with a counter per task instead of the stack.
+ * No includes: the file comes first in every unit, also in mockHal.c, which
+ * needs _GNU_SOURCE before the first system header.
+ */
+
+
+#ifndef PORTMACRO_H
+#define PORTMACRO_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Type definitions. */
+#define portCHAR		char
+#define portFLOAT		float
+#define portDOUBLE		double
+#define portLONG		long
+#define portSHORT		int
+#define portSTACK_TYPE	unsigned portCHAR
+#define portBASE_TYPE	char
+#define portPOINTER_SIZE_TYPE __UINTPTR_TYPE__
+
+typedef portSTACK_TYPE StackType_t;
+typedef signed char BaseType_t;
+typedef unsigned char UBaseType_t;
+
+typedef __UINT32_TYPE__ portTickType;
+typedef __UINT32_TYPE__ TickType_t;
+#define portMAX_DELAY ( portTickType ) 0xffffffff
+
+/* Critical section management, see port.c. */
+void vPortEnterCritical( void );
+void vPortExitCritical( void );
+UBaseType_t uxPortSetInterruptMask( void );
+void vPortClearInterruptMask( UBaseType_t uxSavedInterruptStatus );
+void vPortEnableInterrupts( void );
+void vPortDisableInterrupts( void );
+
+#define portENTER_CRITICAL()		vPortEnterCritical()
+#define portEXIT_CRITICAL()			vPortExitCritical()
+#define portENABLE_INTERRUPTS()		vPortEnableInterrupts()
+#define portDISABLE_INTERRUPTS()	vPortDisableInterrupts()
+#define portSET_INTERRUPT_MASK_FROM_ISR()	uxPortSetInterruptMask()
+#define portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus )	vPortClearInterruptMask( uxSavedInterruptStatus )
+
+/* Architecture specifics. */
+#define portSTACK_GROWTH			( -1 )
+#define portBYTE_ALIGNMENT			8		//the co-routine blocks in the heap hold host pointers
+#define configTOTAL_HEAP_SIZE		( ( size_t ) 256 )	//two CRCB_t of 8 byte pointers, the 80 of FreeRTOSConfig.h fit the xmega ones
+#define RTOS_RAM_BUDGET				5000	//StaticTask_t is 128 bytes here, about 40 on the xmega
+#define portNOP()
+
+/* Kernel utilities. Called from an ISR the switch is deferred like on the target. */
+void vPortYield( void );
+#define portYIELD()					vPortYield()
+#define portEND_SWITCHING_ISR( xSwitchRequired )	vPortYieldFromISR( xSwitchRequired )
+void vPortYieldFromISR( BaseType_t xSwitchRequired );
+
+/* Task function macros as described on the FreeRTOS.org WEB site. */
+#define portTASK_FUNCTION_PROTO( vFunction, pvParameters ) void vFunction( void *pvParameters )
+#define portTASK_FUNCTION( vFunction, pvParameters ) void vFunction( void *pvParameters )
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PORTMACRO_H */
@@ -0,0 +1,108 @@
+#!/usr/bin/env python3
+"""Build and run everything that runs on the host, the check before a commit.
+
+Usage: hosttests.py [-k] [name ...]
+
+Run from the repository root, needs gcc. Every entry of BUILDS is compiled
+into a temporary directory and run, a build error or an exit code other
+than 0 fails it. The hostsim entries run the firmware in both engine modes
+(CALC_USE_COROUTINES 0 and 1) and with the display busy flag, each with its
+scenario, the test_ entries are the unit tests of tools/tests. With names only
+those entries run, -k keeps the binaries and prints the directory.
+"""
+import glob
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+
+CFLAGS = ["-O2", "-Wall", "-DF_CPU=32000000UL"]
+
+FREERTOS = ["U_PiCalc_HS2023/FreeRTOS/" + name + ".c" for name in
+            ("croutine", "event_groups", "heap_1", "list", "queue", "stream_buffer", "tasks", "timers")]
+
+# Build line of tools/hostsim/hostSim.c
+HOSTSIM_FLAGS = ["-DHOSTSIM=1", "-fsingle-precision-constant",
+                 "-include", "tools/hostsim/portmacro.h", "-Itools/hostsim", "-Itools/hostmock",
+                 "-IU_PiCalc_HS2023/includes", "-IU_PiCalc_HS2023/driver", "-IU_PiCalc_HS2023/FreeRTOS/include",
+                 "-finstrument-functions", "-finstrument-functions-exclude-file-list=tools/,FreeRTOS/", "-rdynamic"]
+
+TEST_FLAGS = ["-Itools/tests", "-IU_PiCalc_HS2023/includes"]
+
+# Unit tests of drivers on the register mock
+MOCK_TEST_FLAGS = TEST_FLAGS + ["-Itools/hostmock", "-IU_PiCalc_HS2023/driver"]
+
+# Same for code that includes FreeRTOS.h, with the port macros of the host simulation
+RTOS_TEST_FLAGS = MOCK_TEST_FLAGS + ["-DHOSTSIM=1", "-include", "tools/hostsim/portmacro.h", "-Itools/hostsim",
+                                     "-IU_PiCalc_HS2023/FreeRTOS/include"]
+
+
+def hostsim_sources():
+    return (["tools/hostsim/hostSim.c", "tools/hostsim/port.c", "tools/hostmock/mockHal.c",
+             "tools/hostmock/hd44780.c"]
+            + sorted(glob.glob("U_PiCalc_HS2023/*.c")) + sorted(glob.glob("U_PiCalc_HS2023/driver/*.c"))
+            + FREERTOS)
+
+
+# name, sources, extra compiler flags, arguments of the run
+BUILDS = [
+    ("hostsim-tasks", hostsim_sources, HOSTSIM_FLAGS, ["tools/hostsim/leibniz.scn"]),
+    ("hostsim-coroutines", hostsim_sources, HOSTSIM_FLAGS + ["-DCALC_USE_COROUTINES=1"],
+     ["tools/hostsim/coroutines.scn"]),
+    ("hostsim-busyflag", hostsim_sources, HOSTSIM_FLAGS + ["-DDISPLAY_USE_BUSY_FLAG=1", "-DDISPLAY_USE_TX_ENGINE=0"],
+     ["tools/hostsim/busyflag.scn"]),
+    ("pibench", lambda: ["tools/pibench_host.c", "U_PiCalc_HS2023/piBench.c", "U_PiCalc_HS2023/benchClock.c"],
+     ["-IU_PiCalc_HS2023/includes"], []),
+    # Unit tests of tools/tests, the build line is in each file
+    ("test_buttonEngine", lambda: ["tools/tests/test_buttonEngine.c", "U_PiCalc_HS2023/buttonEngine.c"],
+     TEST_FLAGS, []),
+    ("test_TC_driver", lambda: ["tools/tests/test_TC_driver.c", "tools/hostmock/mockHal.c",
+                                "U_PiCalc_HS2023/driver/TC_driver.c"], MOCK_TEST_FLAGS, []),
+    ("test_clksys_driver", lambda: ["tools/tests/test_clksys_driver.c", "tools/hostmock/mockHal.c",
+                                    "U_PiCalc_HS2023/driver/clksys_driver.c"], MOCK_TEST_FLAGS, []),
+    ("test_clockProfile", lambda: ["tools/tests/test_clockProfile.c", "U_PiCalc_HS2023/init.c",
+                                   "U_PiCalc_HS2023/uartDriver.c", "tools/hostmock/mockHal.c",
+                                   "U_PiCalc_HS2023/driver/TC_driver.c", "U_PiCalc_HS2023/driver/clksys_driver.c"],
+     RTOS_TEST_FLAGS, []),
+    ("test_hd44780", lambda: ["tools/tests/test_hd44780.c", "tools/hostmock/mockHal.c", "tools/hostmock/hd44780.c"],
+     RTOS_TEST_FLAGS, []),
+    ("test_memCheck", lambda: ["tools/tests/test_memCheck.c", "U_PiCalc_HS2023/mem_check.c"],
+     RTOS_TEST_FLAGS + ["-ffunction-sections", "-Wl,--gc-sections"], []),
+]
+
+
+def run(name, sources, flags, args, directory):
+    binary = os.path.join(directory, name)
+    build = subprocess.run(["gcc"] + CFLAGS + flags + ["-o", binary] + sources() + ["-lm"],
+                           capture_output=True, text=True)
+    if build.returncode != 0:
+        return "build failed\n" + build.stderr
+    result = subprocess.run([binary] + args, capture_output=True, text=True)
+    if result.returncode != 0:
+        return "exit code %d\n%s%s" % (result.returncode, result.stdout, result.stderr)
+    return None
+
+
+def main(argv):
+    keep = "-k" in argv
+    names = [arg for arg in argv if arg != "-k"]
+    directory = tempfile.mkdtemp(prefix="hosttests")
+    failed = 0
+    for name, sources, flags, args in BUILDS:
+        if names and name not in names:
+            continue
+        error = run(name, sources, flags, args, directory)
+        print("%-24s %s" % (name, "FAIL" if error else "ok"))
+        if error:
+            print(error)
+            failed += 1
+    if keep:
+        print("binaries in " + directory)
+    else:
+        shutil.rmtree(directory)
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
@@ -0,0 +1,30 @@
+/*
+ * pibench_host.c
+ *
+ * Runs the time-to-N-digits suite of piBench.c on the host, the bench clock is
+ * CLOCK_MONOTONIC (ns). Iterations are the same as on the target, the times are
+ * the host's. Build and run from the repository root:
+ *
+ *   gcc -O2 -IU_PiCalc_HS2023/includes -o pibench tools/pibench_host.c \
+ *       U_PiCalc_HS2023/piBench.c U_PiCalc_HS2023/benchClock.c && ./pibench
+ *
+ * Set PI_BENCH_JSON to 1 in U_PiCalc_HS2023/includes/piBench.h for JSON output.
+ */
+#include <stdio.h>
+#include "benchClock.h"
+#include "piBench.h"
+
+static void print(const char *s) {
+	fputs(s, stdout);
+}
+
+int main(void) {
+	piBenchResult_t results[PI_ENGINE_COUNT];
+
+	vBenchClockInit();
+	for(uint8_t e = 0; e < PI_ENGINE_COUNT; e++) {
+		vPiBenchRun(e, &results[e]);
+	}
+	vPiBenchReport(results, PI_ENGINE_COUNT, print);
+	return 0;
+}
@@ -0,0 +1,86 @@
+#!/usr/bin/env python3
+"""Resolve a vProfilerDump() capture (profiler.c) against the firmware ELF.
+
+Usage: profile2folded.py <uart capture> <U_PiCalc_HS2023.elf> [--nm avr-nm] [--top N]
+
+Writes folded stacks ("task;function count") to stdout, ready for
+flamegraph.pl (https://github.com/brendangregg/FlameGraph):
+
+    profile2folded.py capture.txt Debug/U_PiCalc_HS2023.elf | flamegraph.pl > profile.svg
+
+A flat top list per function goes to stderr.
+"""
+import argparse
+import bisect
+import subprocess
+import sys
+from collections import Counter
+
+
+def load_symbols(elf, nm):
+    out = subprocess.run([nm, "-n", "--defined-only", elf], check=True, capture_output=True, text=True).stdout
+    addrs, names = [], []
+    for line in out.splitlines():
+        parts = line.split()
+        if len(parts) == 3 and parts[1] in "tTwW":
+            addrs.append(int(parts[0], 16))
+            names.append(parts[2])
+    return addrs, names
+
+
+def resolve(addr, addrs, names):
+    i = bisect.bisect_right(addrs, addr) - 1
+    return names[i] if i >= 0 else "0x%x" % addr
+
+
+def parse(lines):
+    header, tasks, samples = None, {}, []
+    for line in lines:
+        parts = line.strip().split()
+        if not parts:
+            continue
+        if parts[0] == "PROF1":
+            header = [int(x) for x in parts[1:5]]
+            tasks, samples = {}, []
+        elif header is None:
+            continue
+        elif parts[0] == "T":
+            tasks[int(parts[1])] = parts[2] if len(parts) > 2 else parts[1]
+        elif parts[0] == "S":
+            samples.append((int(parts[1]), int(parts[2], 16), int(parts[3])))
+        elif parts[0] == "END":
+            break
+    if header is None:
+        raise ValueError("no PROF1 block found")
+    return header, tasks, samples
+
+
+def main():
+    ap = argparse.ArgumentParser()
+    ap.add_argument("capture")
+    ap.add_argument("elf")
+    ap.add_argument("--nm", default="avr-nm")
+    ap.add_argument("--top", type=int, default=20)
+    args = ap.parse_args()
+
+    with open(args.capture, errors="replace") as f:
+        (divisor, shift, total, dropped), tasks, samples = parse(f)
+    addrs, names = load_symbols(args.elf, args.nm)
+
+    folded = Counter()
+    flat = Counter()
+    for task, addr, count in samples:
+        func = resolve(addr, addrs, names)
+        folded["%s;%s" % (tasks.get(task, "task%d" % task), func)] += count
+        flat[func] += count
+
+    for stack, count in sorted(folded.items()):
+        print("%s %d" % (stack, count))
+
+    sys.stderr.write("samples: %d (every %d ticks), dropped: %d\n" % (total, divisor, dropped))
+    for func, count in flat.most_common(args.top):
+        sys.stderr.write("%6.2f%%  %6d  %s\n" % (100.0 * count / max(total, 1), count, func))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,56 @@
+/*
+ * hostTest.h
+ *
+ * Created: 19.10.2026 04:35:03
+ *  Author: agent
+ *
+ * Checks of the host tests in tools/tests. A failed check prints the file, the
+ * line and the values and the test goes on, HOST_TEST_EXIT() returns 1 if any
+ * check failed. tools/hosttests.py builds and runs every test.
+ */
+
+
+#ifndef HOSTTEST_H_
+#define HOSTTEST_H_
+
+#include <stdio.h>
+#include <string.h>
+
+static unsigned hostTestChecks = 0;
+static unsigned hostTestFailures = 0;
+
+#define CHECK(condition) do {																\
+		hostTestChecks++;																	\
+		if(!(condition)) {																	\
+			printf("%s:%d: %s failed\n", __FILE__, __LINE__, #condition);					\
+			hostTestFailures++;																\
+		}																					\
+	} while(0)
+
+#define CHECK_EQ(actual, expected) do {														\
+		long long actualValue = (long long) (actual);										\
+		long long expectedValue = (long long) (expected);									\
+		hostTestChecks++;																	\
+		if(actualValue != expectedValue) {													\
+			printf("%s:%d: %s is %lld, expected %lld\n", __FILE__, __LINE__, #actual,		\
+				actualValue, expectedValue);												\
+			hostTestFailures++;																\
+		}																					\
+	} while(0)
+
+#define CHECK_STR(actual, expected) do {													\
+		const char *actualText = (actual);													\
+		const char *expectedText = (expected);												\
+		hostTestChecks++;																	\
+		if(strcmp(actualText, expectedText) != 0) {											\
+			printf("%s:%d: %s is \"%s\", expected \"%s\"\n", __FILE__, __LINE__, #actual,	\
+				actualText, expectedText);													\
+			hostTestFailures++;																\
+		}																					\
+	} while(0)
+
+// Summary line, value for main() to return
+#define HOST_TEST_EXIT() (printf("%s: %u checks, %u failed\n", __FILE__, hostTestChecks, hostTestFailures), \
+	hostTestFailures > 0 ? 1 : 0)
+
+#endif /* HOSTTEST_H_ */
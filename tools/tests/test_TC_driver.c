@@ -0,0 +1,148 @@
+/*
+ * test_TC_driver.c
+ *
+ * Created: 19.10.2026 04:57:52
+ *  Author: agent
+ *
+ * driver/TC_driver.c on the register mock of tools/hostmock: counting with
+ * the prescaler, the overflow flag, buffered period and compare values, the
+ * reset command, a compare interrupt and the event cascade of benchClock.c.
+ * Every test starts from vMockReset() at 2MHz. Build and run from the
+ * repository root:
+ *
+ *   gcc -O2 -Wall -DF_CPU=32000000UL -Itools/tests -IU_PiCalc_HS2023/includes -Itools/hostmock \
+ *       -IU_PiCalc_HS2023/driver -o test_TC_driver tools/tests/test_TC_driver.c \
+ *       tools/hostmock/mockHal.c U_PiCalc_HS2023/driver/TC_driver.c && ./test_TC_driver
+ */
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "TC_driver.h"
+#include "mockHal.h"
+#include "hostTest.h"
+
+static uint32_t compareCount = 0;
+
+ISR(TCC0_CCA_vect) {
+	compareCount++;
+}
+
+// 64 cycles per count, the flag is set when CNT wraps from PER to 0
+static void prvPrescaler(void) {
+	vMockReset();
+	TC_SetPeriod(&TCC0, 99);
+	TC0_ConfigClockSource(&TCC0, TC_CLKSEL_DIV64_gc);
+	vMockAdvanceCycles(64 * 50);
+	CHECK_EQ(TCC0.CNT, 50);
+	CHECK(!TC_GetOverflowFlag(&TCC0));
+	vMockAdvanceCycles(64 * 50 - 1);
+	CHECK_EQ(TCC0.CNT, 99);
+	CHECK(!TC_GetOverflowFlag(&TCC0));
+	vMockAdvanceCycles(1);
+	CHECK_EQ(TCC0.CNT, 0);
+	CHECK(TC_GetOverflowFlag(&TCC0));
+}
+
+// Writing the flag clears it, the other flags stay
+static void prvClearFlag(void) {
+	vMockReset();
+	TC_SetPeriod(&TCC0, 9);
+	TC_SetCompareA(&TCC0, 5);
+	TC0_ConfigClockSource(&TCC0, TC_CLKSEL_DIV1_gc);
+	vMockAdvanceCycles(10);		//the overflow loads CCA from the buffer
+	vMockAdvanceCycles(10);
+	CHECK(TC_GetOverflowFlag(&TCC0));
+	CHECK(TC_GetCCAFlag(&TCC0));
+	TC_ClearOverflowFlag(&TCC0);
+	vMockSync();
+	CHECK(!TC_GetOverflowFlag(&TCC0));
+	CHECK(TC_GetCCAFlag(&TCC0));
+	vMockAdvanceCycles(10);
+	CHECK(TC_GetOverflowFlag(&TCC0));
+}
+
+// A buffered period takes effect at the next overflow, not before
+static void prvBufferedPeriod(void) {
+	vMockReset();
+	TC_SetPeriod(&TCC0, 99);
+	TC0_ConfigClockSource(&TCC0, TC_CLKSEL_DIV1_gc);
+	vMockAdvanceCycles(40);
+	TC_SetPeriodBuffered(&TCC0, 49);
+	vMockAdvanceCycles(50);
+	CHECK_EQ(TCC0.PER, 99);
+	CHECK_EQ(TCC0.CNT, 90);
+	vMockAdvanceCycles(10);
+	CHECK_EQ(TCC0.PER, 49);
+	CHECK_EQ(TCC0.CNT, 0);
+	TC_ClearOverflowFlag(&TCC0);
+	vMockAdvanceCycles(49);
+	CHECK(!TC_GetOverflowFlag(&TCC0));
+	vMockAdvanceCycles(1);
+	CHECK(TC_GetOverflowFlag(&TCC0));
+}
+
+// TC0_Reset() stops the timer and restores the reset values
+static void prvReset(void) {
+	vMockReset();
+	TC_SetPeriod(&TCC0, 99);
+	TC0_ConfigWGM(&TCC0, TC_WGMODE_NORMAL_gc);
+	TC0_SetOverflowIntLevel(&TCC0, TC_OVFINTLVL_LO_gc);
+	TC0_ConfigClockSource(&TCC0, TC_CLKSEL_DIV1_gc);
+	vMockAdvanceCycles(130);
+	CHECK_EQ(TCC0.CNT, 30);
+	TC0_Reset(&TCC0);
+	vMockSync();
+	CHECK_EQ(TCC0.CTRLA & TC0_CLKSEL_gm, TC_CLKSEL_OFF_gc);
+	CHECK_EQ(TCC0.CNT, 0);
+	CHECK_EQ(TCC0.PER, 0xFFFF);
+	CHECK_EQ(TCC0.INTCTRLA, 0);
+	CHECK(!TC_GetOverflowFlag(&TCC0));
+	vMockAdvanceCycles(100);
+	CHECK_EQ(TCC0.CNT, 0);
+}
+
+// Compare A interrupt once per period at the low level, only with interrupts on
+static void prvCompareInterrupt(void) {
+	vMockReset();
+	compareCount = 0;
+	TC_SetPeriod(&TCC0, 99);
+	TC_SetCompareA(&TCC0, 10);
+	TC0_EnableCCChannels(&TCC0, TC0_CCAEN_bm);
+	TC0_SetCCAIntLevel(&TCC0, TC_CCAINTLVL_LO_gc);
+	TC_ForceUpdate(&TCC0);
+	TC0_ConfigClockSource(&TCC0, TC_CLKSEL_DIV1_gc);
+	PMIC.CTRL |= PMIC_LOLVLEN_bm;
+	vMockAdvanceCycles(1000);
+	CHECK_EQ(TCC0.CCA, 10);
+	CHECK_EQ(compareCount, 0);
+	CHECK(TC_GetCCAFlag(&TCC0));
+	sei();
+	CHECK_EQ(compareCount, 1);		//the pending flag right away
+	CHECK(!TC_GetCCAFlag(&TCC0));
+	vMockAdvanceCycles(1000);
+	CHECK_EQ(compareCount, 11);
+	cli();
+	vMockAdvanceCycles(1000);
+	CHECK_EQ(compareCount, 11);
+}
+
+// benchClock.c: TCD1 counts the overflows of TCD0 through event channel 0
+static void prvEventCascade(void) {
+	vMockReset();
+	TC_SetPeriod(&TCD0, 999);
+	EVSYS.CH0MUX = EVSYS_CHMUX_TCD0_OVF_gc;
+	TC1_ConfigClockSource(&TCD1, TC_CLKSEL_EVCH0_gc);
+	TC0_ConfigClockSource(&TCD0, TC_CLKSEL_DIV8_gc);
+	vMockAdvanceCycles(8UL * 1000 * 25 + 8 * 17);
+	CHECK_EQ(TCD1.CNT, 25);
+	CHECK_EQ(TCD0.CNT, 17);
+}
+
+int main(void) {
+	prvPrescaler();
+	prvClearFlag();
+	prvBufferedPeriod();
+	prvReset();
+	prvCompareInterrupt();
+	prvEventCascade();
+	return HOST_TEST_EXIT();
+}
@@ -0,0 +1,203 @@
+/*
+ * test_buttonEngine.c
+ *
+ * Created: 19.10.2026 04:35:03
+ *  Author: agent
+ *
+ * Scripted sample traces through buttonEngine.c. Each trace is a list of
+ * (sample, count) steps, the events it produces are written as text and
+ * compared: P<n> press, R<n> release, S<n> short, L<n> long, T<n> repeat,
+ * C<mask> chord (hex). Traces with edge times check the timestamps of the
+ * events against the first edge of each change. Build and run from the
+ * repository root:
+ *
+ *   gcc -O2 -Wall -Itools/tests -IU_PiCalc_HS2023/includes -o test_buttonEngine \
+ *       tools/tests/test_buttonEngine.c U_PiCalc_HS2023/buttonEngine.c && ./test_buttonEngine
+ */
+#include <stdio.h>
+#include <string.h>
+#include "buttonEngine.h"
+#include "hostTest.h"
+
+// Samples of ButtonHandler.c at 5ms: long 500ms, repeat 200ms, chord 100ms
+#define TEST_LONG		100
+#define TEST_REPEAT		40
+#define TEST_CHORD		20
+#define TEST_EVENTS		(3 * BUTTON_ENGINE_MAX)
+
+typedef struct {
+	uint8_t sample;
+	uint16_t count;
+} traceStep_t;
+
+static const char eventNames[] = "PRSLTC";
+
+// Runs the trace on a fresh engine, returns the events as "P0 R0 S0"
+static const char *prvRun(const traceStep_t *trace, uint8_t steps) {
+	static char text[256];
+	buttonEngine_t engine;
+	buttonEvent_t events[TEST_EVENTS];
+	uint32_t now = 0;
+	size_t length = 0;
+
+	text[0] = '\0';
+	buttonEngineInit(&engine, 4, TEST_LONG, TEST_REPEAT, TEST_CHORD);
+	for(uint8_t s = 0; s < steps; s++) {
+		for(uint16_t i = 0; i < trace[s].count; i++) {
+			uint8_t n = buttonEngineSample(&engine, trace[s].sample, now, now, events, TEST_EVENTS);
+			now++;
+			for(uint8_t e = 0; e < n && length + 8 < sizeof(text); e++) {
+				length += snprintf(text + length, sizeof(text) - length, length ? " %c%x" : "%c%x",
+					eventNames[events[e].type], events[e].button);
+			}
+		}
+	}
+	CHECK(buttonEngineIdle(&engine));
+	return text;
+}
+
+#define RUN(trace) prvRun(trace, sizeof(trace) / sizeof(trace[0]))
+
+// Contact bounce on both edges, a single short press
+static void prvBouncyTap(void) {
+	static const traceStep_t trace[] = {
+		{0x01, 1}, {0x00, 1}, {0x01, 2}, {0x00, 1}, {0x01, 10},
+		{0x00, 2}, {0x01, 1}, {0x00, 1}, {0x01, 1}, {0x00, 10}
+	};
+	CHECK_STR(RUN(trace), "P0 R0 S0");
+}
+
+// Debounce needs 4 equal samples, 3 are ignored
+static void prvGlitch(void) {
+	static const traceStep_t trace[] = {{0x02, 3}, {0x00, 10}};
+	CHECK_STR(RUN(trace), "");
+}
+
+// LONG after the long time, a REPEAT every repeat time, no SHORT on release
+static void prvLongHold(void) {
+	static const traceStep_t trace[] = {{0x04, 4 + TEST_LONG + 2 * TEST_REPEAT}, {0x00, 10}};
+	CHECK_STR(RUN(trace), "P2 L2 T2 T2 R2");
+}
+
+// Held one sample less than the long time, the 3 samples of the release
+// debounce count as held: still a short press. One more sample makes it long.
+static void prvLongEdge(void) {
+	static const traceStep_t shortTrace[] = {{0x04, TEST_LONG}, {0x00, 10}};
+	static const traceStep_t longTrace[] = {{0x04, TEST_LONG + 1}, {0x00, 10}};
+	CHECK_STR(RUN(shortTrace), "P2 R2 S2");
+	CHECK_STR(RUN(longTrace), "P2 L2 R2");
+}
+
+// Second button within the chord time, one CHORD and neither SHORT nor LONG
+static void prvStaggeredChord(void) {
+	static const traceStep_t trace[] = {{0x01, 10}, {0x09, 4 + TEST_LONG + TEST_REPEAT}, {0x08, 10}, {0x00, 10}};
+	CHECK_STR(RUN(trace), "P0 P3 C9 R0 R3");
+}
+
+// Both edges debounced in the same sample, the second press must not undo the chord
+static void prvSimultaneousChord(void) {
+	static const traceStep_t trace[] = {{0x09, 30}, {0x00, 10}};
+	CHECK_STR(RUN(trace), "P0 C9 P3 R0 R3");
+}
+
+// Same for two neighbouring inputs, S2 and S3 of the handler
+static void prvSimultaneousChordMiddle(void) {
+	static const traceStep_t trace[] = {{0x06, 30}, {0x02, 5}, {0x00, 10}};
+	CHECK_STR(RUN(trace), "P1 C6 P2 R2 R1");
+}
+
+// Second button after the chord time: two separate presses
+static void prvLateSecond(void) {
+	static const traceStep_t trace[] = {{0x01, 4 + TEST_CHORD + 1}, {0x03, 10}, {0x00, 10}};
+	CHECK_STR(RUN(trace), "P0 P1 R0 S0 R1 S1");
+}
+
+// A chord of one press does not carry over into the next press of the same button
+static void prvChordThenTap(void) {
+	static const traceStep_t trace[] = {{0x09, 30}, {0x00, 10}, {0x01, 10}, {0x00, 10}};
+	CHECK_STR(RUN(trace), "P0 C9 P3 R0 R3 P0 R0 S0");
+}
+
+// Samples 10 time units apart, edge is the first edge before the first sample of the
+// step (0: none, the sample time is passed like the handler does)
+typedef struct {
+	uint8_t sample;
+	uint16_t count;
+	uint32_t edge;
+} edgeStep_t;
+
+#define TEST_SAMPLE_TIME	10
+
+// Runs the trace, returns the events as "P0@1003 R0@2005" with their timestamps
+static const char *prvRunEdges(const edgeStep_t *trace, uint8_t steps) {
+	static char text[256];
+	buttonEngine_t engine;
+	buttonEvent_t events[TEST_EVENTS];
+	uint32_t now = TEST_SAMPLE_TIME;
+	size_t length = 0;
+
+	text[0] = '\0';
+	buttonEngineInit(&engine, 4, TEST_LONG, TEST_REPEAT, TEST_CHORD);
+	for(uint8_t s = 0; s < steps; s++) {
+		for(uint16_t i = 0; i < trace[s].count; i++) {
+			uint32_t edge = i == 0 && trace[s].edge != 0 ? trace[s].edge : now;
+			uint8_t n = buttonEngineSample(&engine, trace[s].sample, now, edge, events, TEST_EVENTS);
+			for(uint8_t e = 0; e < n && length + 16 < sizeof(text); e++) {
+				length += snprintf(text + length, sizeof(text) - length, length ? " %c%x@%u" : "%c%x@%u",
+					eventNames[events[e].type], events[e].button, (unsigned) events[e].timestamp);
+			}
+			now += TEST_SAMPLE_TIME;
+		}
+	}
+	return text;
+}
+
+#define RUN_EDGES(trace) prvRunEdges(trace, sizeof(trace) / sizeof(trace[0]))
+
+// The bounces bring later edges, the events keep the first one of the press and
+// of the release, 30 and 40 units before their debounced sample
+static void prvEdgeBouncyTap(void) {
+	static const edgeStep_t trace[] = {
+		{0x01, 1, 5}, {0x00, 1, 13}, {0x01, 2, 22}, {0x00, 1, 37}, {0x01, 10, 45},
+		{0x00, 2, 151}, {0x01, 1, 163}, {0x00, 1, 172}, {0x01, 1, 185}, {0x00, 10, 191}
+	};
+	CHECK_STR(RUN_EDGES(trace), "P0@5 R0@151 S0@151");
+}
+
+// A glitch settles for 4 samples, the edge of the next change replaces its edge
+static void prvEdgeAfterGlitch(void) {
+	static const edgeStep_t trace[] = {{0x02, 3, 4}, {0x00, 4, 35}, {0x02, 10, 77}, {0x00, 10, 175}};
+	CHECK_STR(RUN_EDGES(trace), "P1@77 R1@175 S1@175");
+}
+
+// 3 agreeing samples are still a bounce, the edge of the glitch stays
+static void prvEdgeShortGap(void) {
+	static const edgeStep_t trace[] = {{0x02, 3, 4}, {0x00, 3, 35}, {0x02, 10, 66}, {0x00, 10, 0}};
+	CHECK_STR(RUN_EDGES(trace), "P1@4 R1@170 S1@170");
+}
+
+// LONG and REPEAT have no edge, they carry the time of their sample. The chord
+// has the edge of the press that completed it.
+static void prvEdgeHoldAndChord(void) {
+	static const edgeStep_t longTrace[] = {{0x04, 4 + TEST_LONG + TEST_REPEAT, 3}, {0x00, 10, 0}};
+	static const edgeStep_t chordTrace[] = {{0x01, 10, 6}, {0x09, 10, 104}, {0x00, 10, 0}};
+	CHECK_STR(RUN_EDGES(longTrace), "P2@3 L2@1040 T2@1440 R2@1450");
+	CHECK_STR(RUN_EDGES(chordTrace), "P0@6 P3@104 C9@104 R0@210 R3@210");
+}
+
+int main(void) {
+	prvBouncyTap();
+	prvGlitch();
+	prvLongHold();
+	prvLongEdge();
+	prvStaggeredChord();
+	prvSimultaneousChord();
+	prvSimultaneousChordMiddle();
+	prvLateSecond();
+	prvChordThenTap();
+	prvEdgeBouncyTap();
+	prvEdgeAfterGlitch();
+	prvEdgeShortGap();
+	prvEdgeHoldAndChord();
+	return HOST_TEST_EXIT();
+}
@@ -0,0 +1,104 @@
+/*
+ * test_clksys_driver.c
+ *
+ * Created: 19.10.2026 04:57:52
+ *  Author: agent
+ *
+ * driver/clksys_driver.c on the register mock of tools/hostmock: the start-up
+ * of the oscillators, the source switch through CCPWrite(), the PLL with the
+ * 8MHz crystal, the prescalers and the lock. Every test starts from
+ * vMockReset() on RC2M. Build and run from the repository root:
+ *
+ *   gcc -O2 -Wall -DF_CPU=32000000UL -Itools/tests -IU_PiCalc_HS2023/includes -Itools/hostmock \
+ *       -IU_PiCalc_HS2023/driver -o test_clksys_driver tools/tests/test_clksys_driver.c \
+ *       tools/hostmock/mockHal.c U_PiCalc_HS2023/driver/clksys_driver.c && ./test_clksys_driver
+ */
+#include <avr/io.h>
+#include "clksys_driver.h"
+#include "mockHal.h"
+#include "hostTest.h"
+
+// Polls like init.c, returns the time it took
+static uint64_t prvWaitReady(uint8_t ready) {
+	uint64_t start = ullMockTimeNS();
+
+	do { nop(); } while ( CLKSYS_IsReady( ready ) == 0 );
+	return ullMockTimeNS() - start;
+}
+
+// RC32M needs its start-up time, a select before that is ignored
+static void prvRc32mStartup(void) {
+	uint64_t waited;
+
+	vMockReset();
+	CHECK_EQ(ulMockCpuHz(), 2000000UL);
+	CLKSYS_Enable( OSC_RC32MEN_bm );
+	CHECK_EQ(CLKSYS_Main_ClockSource_Select( CLK_SCLKSEL_RC32M_gc ), 0);
+	CHECK_EQ(CLK.CTRL & CLK_SCLKSEL_gm, CLK_SCLKSEL_RC2M_gc);
+	CHECK_EQ(ulMockCpuHz(), 2000000UL);
+	waited = prvWaitReady( OSC_RC32MRDY_bm );
+	CHECK(waited >= 5000);
+	CHECK(waited < 6000);
+	CHECK(CLKSYS_Main_ClockSource_Select( CLK_SCLKSEL_RC32M_gc ) != 0);
+	CHECK_EQ(ulMockCpuHz(), 32000000UL);
+	CHECK_EQ(ulMockCcpViolations(), 0);
+}
+
+// A protected register written without CCP keeps its value
+static void prvWithoutCcp(void) {
+	vMockReset();
+	CLKSYS_Enable( OSC_RC32MEN_bm );
+	prvWaitReady( OSC_RC32MRDY_bm );
+	CLK.CTRL = CLK_SCLKSEL_RC32M_gc;
+	vMockSync();
+	CHECK_EQ(CLK.CTRL & CLK_SCLKSEL_gm, CLK_SCLKSEL_RC2M_gc);
+	CHECK_EQ(ulMockCcpViolations(), 1);
+	CHECK_EQ(ulMockCpuHz(), 2000000UL);
+}
+
+// init.c XOSC-PLL profile: 8MHz crystal times 4, then the prescaler halves it
+static void prvXoscPll(void) {
+	vMockReset();
+	CLKSYS_XOSC_Config( OSC_FRQRANGE_2TO9_gc, false, OSC_XOSCSEL_XTAL_256CLK_gc );
+	CLKSYS_Enable( OSC_XOSCEN_bm );
+	CHECK(prvWaitReady( OSC_XOSCRDY_bm ) >= 1000000);
+	CLKSYS_PLL_Config( OSC_PLLSRC_XOSC_gc, 4 );
+	CLKSYS_Enable( OSC_PLLEN_bm );
+	CHECK(prvWaitReady( OSC_PLLRDY_bm ) >= 64000);
+	CHECK(CLKSYS_Main_ClockSource_Select( CLK_SCLKSEL_PLL_gc ) != 0);
+	CHECK_EQ(ulMockCpuHz(), 32000000UL);
+	CLKSYS_Prescalers_Config( CLK_PSADIV_2_gc, CLK_PSBCDIV_1_1_gc );
+	CHECK_EQ(ulMockCpuHz(), 16000000UL);
+	CLKSYS_Prescalers_Config( CLK_PSADIV_1_gc, CLK_PSBCDIV_1_1_gc );
+	CHECK_EQ(ulMockCpuHz(), 32000000UL);
+
+	// the running source and its reference stay on, the PLL factor is locked
+	CLKSYS_Disable( OSC_XOSCEN_bm | OSC_PLLEN_bm | OSC_RC2MEN_bm );
+	CLKSYS_PLL_Config( OSC_PLLSRC_XOSC_gc, 6 );
+	vMockSync();
+	CHECK_EQ(OSC.CTRL, OSC_XOSCEN_bm | OSC_PLLEN_bm);
+	CHECK_EQ(OSC.PLLCTRL & OSC_PLLFAC_gm, 4);
+	CHECK_EQ(ulMockCpuHz(), 32000000UL);
+	CHECK_EQ(ulMockCcpViolations(), 0);
+}
+
+// After the lock neither the source nor the prescalers change
+static void prvLock(void) {
+	vMockReset();
+	CLKSYS_Enable( OSC_RC32MEN_bm );
+	prvWaitReady( OSC_RC32MRDY_bm );
+	CLKSYS_Configuration_Lock();
+	CHECK(CLK.LOCK & CLK_LOCK_bm);
+	CHECK_EQ(CLKSYS_Main_ClockSource_Select( CLK_SCLKSEL_RC32M_gc ), 0);
+	CLKSYS_Prescalers_Config( CLK_PSADIV_4_gc, CLK_PSBCDIV_1_1_gc );
+	CHECK_EQ(CLK.PSCTRL, 0);
+	CHECK_EQ(ulMockCpuHz(), 2000000UL);
+}
+
+int main(void) {
+	prvRc32mStartup();
+	prvWithoutCcp();
+	prvXoscPll();
+	prvLock();
+	return HOST_TEST_EXIT();
+}
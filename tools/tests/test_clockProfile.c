@@ -0,0 +1,177 @@
+/*
+ * test_clockProfile.c
+ *
+ * Created: 19.10.2026 04:59:10
+ *  Author: agent
+ *
+ * The clock profiles of init.c on the register mock of tools/hostmock. Every
+ * profile is switched to, also from each other, and checked against the clock
+ * the mock derives from the oscillator registers: the CPU clock, the 1:1
+ * prescalers (clkPER = clkCPU), the 1ms tick of TCC0, the baud rate of USARTC0,
+ * the display waits of TCF0 and ulClockUSToCounts / ulClockCountsToUS.
+ * Build and run from the repository root:
+ *
+ *   gcc -O2 -Wall -DF_CPU=32000000UL -DHOSTSIM=1 -include tools/hostsim/portmacro.h -Itools/tests \
+ *       -IU_PiCalc_HS2023/includes -Itools/hostsim -Itools/hostmock -IU_PiCalc_HS2023/driver \
+ *       -IU_PiCalc_HS2023/FreeRTOS/include -o test_clockProfile tools/tests/test_clockProfile.c \
+ *       U_PiCalc_HS2023/init.c U_PiCalc_HS2023/uartDriver.c tools/hostmock/mockHal.c \
+ *       U_PiCalc_HS2023/driver/TC_driver.c U_PiCalc_HS2023/driver/clksys_driver.c && ./test_clockProfile
+ */
+#include <avr/io.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include "init.h"
+#include "uartDriver.h"
+#include "TC_driver.h"
+#include "mockHal.h"
+#include "hostTest.h"
+
+#define TEST_BAUD		115200UL
+#define TEST_INIT_US	4100	//longest delayUS() of the display, 16 bit at DIV64
+#define TEST_CLEAR_US	1520	//longest TX engine wait of the display, 8 bit at DIV64 or DIV1024
+
+static uint64_t uartStartNS[2];
+static uint8_t uartBytes = 0;
+
+// init.c only needs the critical section of the port, no scheduler runs here
+void vPortEnterCritical(void) {
+	vMockCli();
+}
+
+void vPortExitCritical(void) {
+	vMockSei();
+}
+
+// The UART lock of uartDriver.c is skipped without a running scheduler, the
+// mutex functions are never reached
+BaseType_t xTaskGetSchedulerState(void) {
+	return taskSCHEDULER_NOT_STARTED;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+	return NULL;
+}
+
+QueueHandle_t xQueueCreateMutexStatic(const uint8_t ucQueueType, StaticQueue_t *pxStaticQueue) {
+	return NULL;
+}
+
+BaseType_t xQueueSemaphoreTake(QueueHandle_t xQueue, TickType_t xTicksToWait) {
+	return pdFAIL;
+}
+
+BaseType_t xQueueGenericSend(QueueHandle_t xQueue, const void * const pvItemToQueue, TickType_t xTicksToWait,
+		const BaseType_t xCopyPosition) {
+	return pdFAIL;
+}
+
+static void prvUartHook(uint8_t usart, uint8_t data, uint64_t timeNS) {
+	if(usart == MOCK_USARTC0 && uartBytes < 2) {
+		uartStartNS[uartBytes] = timeNS;
+	}
+	uartBytes++;
+}
+
+// The tick timer like port.c and TCC1 as the reference, both at CPU clock / 64
+static void prvStartTick(void) {
+	TC0_ConfigClockSource(&TCC0, TC_CLKSEL_DIV64_gc);
+	TC1_ConfigClockSource(&TCC1, TC_CLKSEL_DIV64_gc);
+}
+
+// The profile runs at its frequency, the tick lasts 1ms and the UART sends at 115200
+static void prvCheckProfile(uint8_t profile) {
+	uint32_t hz = ulClockProfileHz(profile);
+	uint32_t mhz = hz / 1000000UL;
+	uint16_t bsel;
+	uint64_t frameNS;
+	uint32_t counts;
+	uint16_t prescaler = 64;
+
+	vClockSetProfile(profile);
+	vMockSync();
+	CHECK_EQ(ucClockGetProfile(), profile);
+	CHECK_EQ(ulClockCpuHz(), hz);
+	CHECK_EQ(ulMockCpuHz(), hz);
+	CHECK_EQ(CLK.PSCTRL, CLK_PSADIV_1_gc | CLK_PSBCDIV_1_1_gc);
+
+	// the tick: PER + 1 counts of 64 cycles are 1ms
+	CHECK_EQ(TCC0.PER, hz / CLOCK_TICK_PRESCALER / 1000 - 1);
+	TC_Restart(&TCC0);
+	TC_ClearOverflowFlag(&TCC0);
+	vMockAdvanceNS(999000);
+	CHECK(!TC_GetOverflowFlag(&TCC0));
+	vMockAdvanceNS(1000);
+	CHECK(TC_GetOverflowFlag(&TCC0));
+
+	// BSEL with BSCALE -7: f / (16 * (BSEL / 128 + 1)), within 0.1%
+	bsel = USARTC0.BAUDCTRLA | (uint16_t) (USARTC0.BAUDCTRLB & 0x0F) << 8;
+	CHECK_EQ(USARTC0.BAUDCTRLB >> USART_BSCALE_gp, 0x09);
+	CHECK(8ULL * hz * 1000 / (bsel + 128) > TEST_BAUD * 999);
+	CHECK(8ULL * hz * 1000 / (bsel + 128) < TEST_BAUD * 1001);
+
+	// hostsim ticks the mock at every return, here it is done by hand
+	uartBytes = 0;
+	vUartPutChar('A');
+	vMockSync();
+	vUartPutChar('B');
+	vMockSync();
+	vMockAdvanceNS(1000000);
+	CHECK_EQ(uartBytes, 2);
+	frameNS = uartStartNS[1] - uartStartNS[0];
+	CHECK(frameNS * TEST_BAUD > 10ULL * 999000000);
+	CHECK(frameNS * TEST_BAUD < 10ULL * 1001000000);
+
+	// the conversions against TCC1 counting at CPU clock / 64
+	for(uint32_t us = 1; us <= 2000; us += 111) {
+		uint64_t cycles = (uint64_t) us * mhz;
+		uint32_t counts = ulClockUSToCounts(us, CLOCK_TICK_PRESCALER);
+
+		TC_Restart(&TCC1);
+		vMockAdvanceCycles(cycles);
+		CHECK_EQ(TCC1.CNT, cycles / CLOCK_TICK_PRESCALER);
+		CHECK_EQ(counts, (cycles + CLOCK_TICK_PRESCALER - 1) / CLOCK_TICK_PRESCALER);
+		CHECK(ulClockCountsToUS(counts, CLOCK_TICK_PRESCALER) >= us);
+		CHECK(ulClockCountsToUS(counts - 1, CLOCK_TICK_PRESCALER) < us);
+	}
+	CHECK_EQ(ulClockCountsToUS(mhz * 1000, 1), 1000);
+
+	// TCF0 of the display: the waits fit the timer and last at least as long
+	counts = ulClockUSToCounts(TEST_INIT_US, 64);
+	CHECK(counts < 0xFFFF);
+	counts = ulClockUSToCounts(TEST_CLEAR_US, 64);
+	if(counts > 255) {
+		counts = ulClockUSToCounts(TEST_CLEAR_US, 1024);
+		prescaler = 1024;
+	}
+	CHECK(counts <= 255);
+	TC_SetPeriod(&TCF0, counts);
+	TC0_ConfigClockSource(&TCF0, prescaler == 1024 ? TC_CLKSEL_DIV1024_gc : TC_CLKSEL_DIV64_gc);
+	TC_Restart(&TCF0);
+	TC_ClearOverflowFlag(&TCF0);
+	vMockAdvanceNS((TEST_CLEAR_US - 1) * 1000ULL);
+	CHECK(!TC_GetOverflowFlag(&TCF0));
+	vMockAdvanceCycles((uint64_t) (counts + 1) * prescaler);
+	CHECK(TC_GetOverflowFlag(&TCF0));
+	TC0_ConfigClockSource(&TCF0, TC_CLKSEL_OFF_gc);
+	CHECK_EQ(ulMockCcpViolations(), 0);
+}
+
+int main(void) {
+	static const uint8_t sequence[] = {
+		CLOCK_PROFILE_XOSC_PLL, CLOCK_PROFILE_RC32M_DFLL, CLOCK_PROFILE_XOSC_PLL48,
+		CLOCK_PROFILE_XOSC_PLL, CLOCK_PROFILE_XOSC_PLL48, CLOCK_PROFILE_RC32M_DFLL,
+		CLOCK_PROFILE_XOSC_PLL
+	};
+
+	vMockUartHook(prvUartHook);
+	vInitClock();
+	prvStartTick();
+	vInitUart();
+	for(uint8_t i = 0; i < sizeof(sequence); i++) {
+		prvCheckProfile(sequence[i]);
+	}
+	vClockSetProfile(CLOCK_PROFILE_COUNT);		//ignored
+	CHECK_EQ(ucClockGetProfile(), CLOCK_PROFILE_XOSC_PLL);
+	return HOST_TEST_EXIT();
+}
@@ -0,0 +1,251 @@
+/*
+ * test_hd44780.c
+ *
+ * Created: 19.10.2026 05:06:57
+ *  Author: agent
+ *
+ * The display bus of NHD0420Hal.h on the register mock with the HD44780 model
+ * of tools/hostmock/hd44780.c: the power-on init, text at the line addresses,
+ * clear, instructions sent too early and the busy flag. The bus cycles are the
+ * ones of NHD0420Driver.c (1us E pulse, 1us between the nibbles), every HAL
+ * call is followed by vMockSync() like the instrumentation of hostsim does.
+ * Build and run from the repository root:
+ *
+ *   gcc -O2 -Wall -DF_CPU=32000000UL -DHOSTSIM=1 -include tools/hostsim/portmacro.h -Itools/tests \
+ *       -IU_PiCalc_HS2023/includes -Itools/hostsim -Itools/hostmock -IU_PiCalc_HS2023/driver \
+ *       -IU_PiCalc_HS2023/FreeRTOS/include -o test_hd44780 tools/tests/test_hd44780.c \
+ *       tools/hostmock/mockHal.c tools/hostmock/hd44780.c && ./test_hd44780
+ */
+#include <string.h>
+#include <avr/io.h>
+#include "FreeRTOS.h"
+#include "NHD0420Hal.h"
+#include "mockHal.h"
+#include "hd44780.h"
+#include "hostTest.h"
+
+#define TEST_US			1000ULL		//ns
+#define TEST_MS			1000000ULL	//ns
+
+static uint8_t lastRs;
+static uint8_t lastValue;
+static uint64_t lastEarlyNS;
+
+static void prvViolationHook(uint8_t rs, uint8_t value, uint64_t earlyNS, uint64_t timeNS) {
+	lastRs = rs;
+	lastValue = value;
+	lastEarlyNS = earlyNS;
+}
+
+static void prvNibble(uint8_t rs, uint8_t nibble) {
+	halDisplayPort(nibble);
+	vMockSync();
+	halDisplayRS(rs);
+	vMockSync();
+	halDisplayRW(0);
+	vMockSync();
+	halDisplayE(1);
+	vMockAdvanceNS(TEST_US);
+	halDisplayE(0);
+	vMockSync();
+}
+
+// Latches the low nibble 3us after the call
+static void prvSend(uint8_t rs, uint8_t value) {
+	prvNibble(rs, value >> 4);
+	vMockAdvanceNS(TEST_US);
+	prvNibble(rs, value & 0x0F);
+}
+
+static void prvCommand(uint8_t value, uint64_t waitNS) {
+	prvSend(0, value);
+	vMockAdvanceNS(waitNS);
+}
+
+static void prvWrite(const char *text) {
+	while(*text) {
+		prvSend(1, *text++);
+		vMockAdvanceNS(HD44780_EXEC_DATA);
+	}
+}
+
+// Like _displayReadBusy() of NHD0420Driver.c
+static uint8_t prvReadBusy(void) {
+	uint8_t status;
+
+	PORTA.DIRCLR = PIN4_bm | PIN5_bm | PIN6_bm | PIN7_bm;
+	vMockSync();
+	halDisplayRS(0);
+	vMockSync();
+	halDisplayRW(1);
+	vMockSync();
+	halDisplayE(1);
+	vMockAdvanceNS(TEST_US);
+	status = PORTA.IN & PIN7_bm;
+	halDisplayE(0);
+	vMockAdvanceNS(TEST_US);
+	halDisplayE(1);
+	vMockAdvanceNS(TEST_US);
+	halDisplayE(0);
+	vMockSync();
+	halDisplayRW(0);
+	vMockSync();
+	PORTA.DIRSET = PIN4_bm | PIN5_bm | PIN6_bm | PIN7_bm;
+	vMockSync();
+	return status != 0;
+}
+
+static void prvPowerOn(void) {
+	vMockReset();
+	vHd44780Reset();
+	vHd44780ViolationHook(prvViolationHook);
+	lastEarlyNS = 0;
+	PORTA.DIRSET = PIN4_bm | PIN5_bm | PIN6_bm | PIN7_bm;
+	PORTD.DIRSET = PIN0_bm | PIN1_bm | PIN2_bm;
+	vMockAdvanceNS(40 * TEST_MS);
+}
+
+// Datasheet init with the minimum waits: 3x 0x30 in 8 bit mode, 4 bit, 2 lines,
+// display on, clear, entry mode increment
+static void prvInit(void) {
+	prvPowerOn();
+	prvNibble(0, 0x03);
+	vMockAdvanceNS(HD44780_EXEC_INIT1);
+	prvNibble(0, 0x03);
+	vMockAdvanceNS(HD44780_EXEC_INIT2);
+	prvNibble(0, 0x03);
+	vMockAdvanceNS(HD44780_EXEC_COMMAND);
+	prvNibble(0, 0x02);
+	vMockAdvanceNS(HD44780_EXEC_COMMAND);
+	prvCommand(0x28, HD44780_EXEC_COMMAND);
+	prvCommand(0x08, HD44780_EXEC_COMMAND);
+	prvCommand(0x0C, HD44780_EXEC_COMMAND);
+	prvCommand(0x01, HD44780_EXEC_CLEAR);
+	prvCommand(0x06, HD44780_EXEC_COMMAND);
+}
+
+static void prvCheckLine(uint8_t line, const char *expected) {
+	char text[21];
+
+	vHd44780Text(line, text);
+	CHECK_STR(text, expected);
+}
+
+static void prvInitSequence(void) {
+	prvInit();
+	CHECK_EQ(ulHd44780Violations(), 0);
+	CHECK_EQ(ucHd44780Address(), 0);
+	for(uint8_t line = 0; line < 4; line++) {
+		prvCheckLine(line, "                    ");
+	}
+
+	// the second 0x30 160us after the first, 4.1ms are needed
+	prvPowerOn();
+	prvNibble(0, 0x03);
+	vMockAdvanceNS(160 * TEST_US);
+	prvNibble(0, 0x03);
+	CHECK_EQ(ulHd44780Violations(), 1);
+	CHECK_EQ(lastValue, 0x30);
+	CHECK_EQ(lastEarlyNS, HD44780_EXEC_INIT1 - 160 * TEST_US - 1 * TEST_US);
+}
+
+// Set DDRAM address per line, line 0 runs on in line 2, the last position of
+// line 3 wraps to 0, clear blanks everything and homes the cursor
+static void prvText(void) {
+	prvInit();
+	prvCommand(0x80 | (0x40 + 3), HD44780_EXEC_COMMAND);
+	prvWrite("PI");
+	prvCommand(0x80 | (0x54 + 15), HD44780_EXEC_COMMAND);
+	prvWrite("3.14159");
+	prvCheckLine(1, "   PI               ");
+	prvCheckLine(3, "               3.141");
+	prvCheckLine(0, "59                  ");
+	prvCommand(0x80, HD44780_EXEC_COMMAND);
+	prvWrite("01234567890123456789AB");
+	prvCheckLine(0, "01234567890123456789");
+	prvCheckLine(2, "AB                  ");
+	CHECK_EQ(ucHd44780Address(), 0x16);
+	CHECK_EQ(ulHd44780Violations(), 0);
+
+	prvCommand(0x01, HD44780_EXEC_CLEAR);
+	for(uint8_t line = 0; line < 4; line++) {
+		prvCheckLine(line, "                    ");
+	}
+	CHECK_EQ(ucHd44780Address(), 0);
+	prvWrite("X");
+	prvCheckLine(0, "X                   ");
+	CHECK_EQ(ulHd44780Violations(), 0);
+}
+
+// The violation is the rest of the execution time of the previous instruction
+static void prvEarly(void) {
+	prvInit();
+	prvCommand(0x80, 10 * TEST_US);
+	prvSend(1, 'A');
+	CHECK_EQ(ulHd44780Violations(), 1);
+	CHECK_EQ(lastRs, 1);
+	CHECK_EQ(lastValue, 'A');
+	CHECK_EQ(lastEarlyNS, HD44780_EXEC_COMMAND - 13 * TEST_US);
+	prvCheckLine(0, "A                   ");	//executed anyway
+
+	vMockAdvanceNS(HD44780_EXEC_DATA);
+	prvCommand(0x01, 1 * TEST_MS);
+	prvCommand(0xC0, HD44780_EXEC_COMMAND);
+	CHECK_EQ(ulHd44780Violations(), 2);
+	CHECK_EQ(lastRs, 0);
+	CHECK_EQ(lastValue, 0xC0);
+	CHECK_EQ(lastEarlyNS, HD44780_EXEC_CLEAR - 1 * TEST_MS - 3 * TEST_US);
+
+	// exactly the execution time is in time
+	prvCommand(0x0C, HD44780_EXEC_COMMAND - 3 * TEST_US);
+	prvCommand(0x0C, HD44780_EXEC_COMMAND);
+	CHECK_EQ(ulHd44780Violations(), 2);
+}
+
+// Busy while the controller executes, the polls until the next write are one
+// poll, reads are no violation, stuck reads busy forever
+static void prvBusyFlag(void) {
+	uint64_t start;
+	uint64_t longestNS;
+	uint32_t reads = 0;
+
+	prvInit();
+	CHECK(!prvReadBusy());
+	prvSend(0, 0x01);
+	CHECK_EQ(ulHd44780Polls(&longestNS), 1);		//the read before
+	vHd44780PollClear();
+	start = ullMockTimeNS();
+	CHECK(prvReadBusy());
+	while(prvReadBusy()) {
+		reads++;
+		vMockAdvanceNS(10 * TEST_US);
+	}
+	CHECK(ullMockTimeNS() - start >= HD44780_EXEC_CLEAR);
+	CHECK(ullMockTimeNS() - start < HD44780_EXEC_CLEAR + 20 * TEST_US);
+	CHECK(reads > 100);
+	CHECK_EQ(ulHd44780Polls(&longestNS), 0);		//counted at the next write
+	prvWrite("B");
+	CHECK_EQ(ulHd44780Polls(&longestNS), 1);
+	CHECK(longestNS >= HD44780_EXEC_CLEAR - 20 * TEST_US);
+	CHECK(longestNS <= HD44780_EXEC_CLEAR + 20 * TEST_US);
+	prvCheckLine(0, "B                   ");
+	CHECK_EQ(ulHd44780Violations(), 0);
+	vHd44780PollClear();
+	CHECK_EQ(ulHd44780Polls(&longestNS), 0);
+	CHECK_EQ(longestNS, 0);
+
+	vHd44780Stuck(1);
+	vMockAdvanceNS(10 * TEST_MS);
+	CHECK(prvReadBusy());
+	vHd44780Stuck(0);
+	CHECK(!prvReadBusy());
+	CHECK_EQ(PORTA.DIR, PIN4_bm | PIN5_bm | PIN6_bm | PIN7_bm);
+}
+
+int main(void) {
+	prvInitSequence();
+	prvText();
+	prvEarly();
+	prvBusyFlag();
+	return HOST_TEST_EXIT();
+}
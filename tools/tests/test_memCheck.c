@@ -0,0 +1,123 @@
+/*
+ * test_memCheck.c
+ *
+ * Created: 19.10.2026 04:59:58
+ *  Author: agent
+ *
+ * mem_unused_painted() of mem_check.c against a linear scan. A painted buffer
+ * is touched from the top down like a stack, with untouched gaps in the
+ * touched part, with and without the cache of an earlier probe. The rest of
+ * mem_check.c needs the kernel, -ffunction-sections and --gc-sections leave it
+ * out. Build and run from the repository root:
+ *
+ *   gcc -O2 -Wall -DF_CPU=32000000UL -DHOSTSIM=1 -include tools/hostsim/portmacro.h -Itools/tests \
+ *       -IU_PiCalc_HS2023/includes -Itools/hostsim -Itools/hostmock -IU_PiCalc_HS2023/driver \
+ *       -IU_PiCalc_HS2023/FreeRTOS/include -ffunction-sections -Wl,--gc-sections -o test_memCheck \
+ *       tools/tests/test_memCheck.c U_PiCalc_HS2023/mem_check.c && ./test_memCheck
+ */
+#include <stdio.h>
+#include <string.h>
+#include "mem_check.h"
+#include "hostTest.h"
+
+#define TEST_FILL		0xA5
+#define TEST_SIZE_MAX	1024
+
+static uint8_t buffer[TEST_SIZE_MAX];
+
+// Bytes at the start that still hold the fill pattern
+static uint16_t prvLinear(uint16_t size) {
+	uint16_t unused = 0;
+	while(unused < size && buffer[unused] == TEST_FILL) {
+		unused++;
+	}
+	return unused;
+}
+
+// Painted, then [edge, size) written like a stack, except gap bytes from gapStart
+static void prvPaint(uint16_t size, uint16_t edge, uint16_t gapStart, uint16_t gap) {
+	memset(buffer, TEST_FILL, size);
+	for(uint16_t i = edge; i < size; i++) {
+		if(i < gapStart || i >= gapStart + gap) {
+			buffer[i] = (uint8_t) (i * 7) == TEST_FILL ? 0 : (uint8_t) (i * 7);
+		}
+	}
+}
+
+// Untouched, fully touched and an edge at every byte, without a cache
+static void prvEdges(void) {
+	static const uint16_t sizes[] = {1, 2, 3, 16, 17, 255, TEST_SIZE_MAX};
+
+	for(uint8_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+		uint16_t size = sizes[s];
+		for(uint16_t edge = 0; edge <= size; edge++) {
+			uint16_t cache = 0xFFFF;
+			prvPaint(size, edge, 0, 0);
+			CHECK_EQ(mem_unused_painted(buffer, size, TEST_FILL, &cache), edge);
+			CHECK_EQ(cache, edge);
+		}
+	}
+}
+
+// A gap of up to MEM_PROBE_GUARD - 1 words anywhere in the touched part is found
+// by the walk below the edge, the search result matches the linear scan
+static void prvGaps(void) {
+	uint16_t size = 200;
+
+	for(uint16_t edge = 0; edge < size; edge++) {
+		for(uint16_t gap = 1; gap < 2 * MEM_PROBE_GUARD - 1; gap++) {
+			for(uint16_t gapStart = edge + 1; gapStart + gap < size; gapStart += 3) {
+				uint16_t cache = 0xFFFF;
+				prvPaint(size, edge, gapStart, gap);
+				CHECK_EQ(mem_unused_painted(buffer, size, TEST_FILL, &cache), prvLinear(size));
+			}
+		}
+	}
+}
+
+// A deeper gap can hide the edge below it: the result never reports less
+// unused memory than the linear scan
+static void prvDeepGap(void) {
+	uint16_t size = 512;
+	uint16_t edge = 100;
+	uint16_t cache = 0xFFFF;
+	uint16_t unused;
+
+	prvPaint(size, edge, edge + 2, 2 * MEM_PROBE_GUARD + 40);
+	unused = mem_unused_painted(buffer, size, TEST_FILL, &cache);
+	CHECK(unused >= prvLinear(size));
+	CHECK(unused <= edge + 2 + 2 * MEM_PROBE_GUARD + 40);
+}
+
+// The stack only grows: every probe starts from the cache of the last one and
+// still matches the linear scan, repainted memory does not shrink the usage
+static void prvCache(void) {
+	uint16_t size = TEST_SIZE_MAX;
+	uint16_t cache = 0xFFFF;
+	uint16_t unused;
+
+	for(uint16_t edge = size; edge > 0; edge -= (edge > 37) ? 37 : edge) {
+		prvPaint(size, edge, edge + 11, (edge % 7) * 2);
+		unused = mem_unused_painted(buffer, size, TEST_FILL, &cache);
+		CHECK_EQ(unused, prvLinear(size));
+		CHECK_EQ(cache, unused);
+	}
+	prvPaint(size, 0, 0, 0);
+	CHECK_EQ(mem_unused_painted(buffer, size, TEST_FILL, &cache), 0);
+
+	cache = 301;
+	prvPaint(size, 700, 0, 0);
+	CHECK_EQ(mem_unused_painted(buffer, size, TEST_FILL, &cache), 301);
+	CHECK_EQ(cache, 301);
+	prvPaint(size, 300, 0, 0);
+	CHECK_EQ(mem_unused_painted(buffer, size, TEST_FILL, &cache), 300);
+	CHECK_EQ(cache, 300);
+}
+
+int main(void) {
+	prvEdges();
+	prvGaps();
+	prvDeepGap();
+	prvCache();
+	return HOST_TEST_EXIT();
+}
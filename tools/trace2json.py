@@ -0,0 +1,104 @@
+#!/usr/bin/env python3
+"""Convert a trace dump from vTraceDump() (traceRecorder.c) into Chrome/Perfetto trace JSON.
+
+Usage: trace2json.py <uart capture> [out.json]
+
+The capture may contain other UART output, the first "TRC1" block is used.
+Open the result in chrome://tracing or https://ui.perfetto.dev.
+"""
+import json
+import struct
+import sys
+
+EVT_TASK_SWITCH = 1
+EVT_QUEUE_SEND = 2
+EVT_EG_SET_BITS = 3
+EVT_ISR_ENTER = 4
+EVT_ISR_EXIT = 5
+
+MAX_TASK_NAME_LEN = 8  # configMAX_TASK_NAME_LEN
+
+QUEUE_NAMES = {0: "timerQueue", 1: "displayLineQueue"}
+EG_NAMES = {0: "eventGroup", 1: "egDisplayTiming", 2: "evButtonEvents", 3: "evCalcTaskEvents"}
+ISR_NAMES = {1: "TCF0_OVF (delayUS)"}
+
+
+def parse(data):
+    start = data.find(b"TRC1")
+    if start < 0:
+        raise ValueError("no TRC1 block found")
+    pos = start + 4
+    record_size, subtick_hz, count, total, task_count = struct.unpack_from("<BIHIB", data, pos)
+    pos += 12
+    tasks = {}
+    for _ in range(task_count):
+        number = data[pos]
+        name = data[pos + 1:pos + 1 + MAX_TASK_NAME_LEN].split(b"\0")[0].decode("ascii", "replace")
+        tasks[number] = name
+        pos += 1 + MAX_TASK_NAME_LEN
+    records = []
+    for _ in range(count):
+        event, arg, tick, sub = struct.unpack_from("<BBHH", data, pos)
+        records.append((event, arg, tick, sub))
+        pos += record_size
+    return tasks, records, total, subtick_hz
+
+
+def timestamps(records, subtick_hz):
+    """Unwraps the 16 bit tick counter and returns microseconds per record, the
+    sub-tick counts at the rate from the dump header (CPU clock / 64)."""
+    result = []
+    wraps = 0
+    last = None
+    for _, _, tick, sub in records:
+        if last is not None and tick < last:
+            wraps += 1
+        last = tick
+        result.append((wraps * 65536 + tick) * 1000 + sub * 1000000.0 / subtick_hz)
+    return result
+
+
+def to_events(tasks, records, subtick_hz):
+    events = [{"name": "process_name", "ph": "M", "pid": 0, "args": {"name": "U_PiCalc"}}]
+    for number, name in tasks.items():
+        events.append({"name": "thread_name", "ph": "M", "pid": 0, "tid": number, "args": {"name": name}})
+    events.append({"name": "thread_name", "ph": "M", "pid": 0, "tid": 1000, "args": {"name": "ISR"}})
+
+    times = timestamps(records, subtick_hz)
+    running = None
+    for (event, arg, _, _), ts in zip(records, times):
+        if event == EVT_TASK_SWITCH:
+            if running is not None:
+                events.append({"name": tasks.get(running[0], "task %d" % running[0]), "ph": "X", "pid": 0,
+                               "tid": running[0], "ts": running[1], "dur": ts - running[1]})
+            running = (arg, ts)
+        elif event == EVT_QUEUE_SEND:
+            events.append({"name": "send " + QUEUE_NAMES.get(arg, "queue %d" % arg), "ph": "i", "s": "t",
+                           "pid": 0, "tid": running[0] if running else 1000, "ts": ts})
+        elif event == EVT_EG_SET_BITS:
+            events.append({"name": "set " + EG_NAMES.get(arg, "eg %d" % arg), "ph": "i", "s": "t",
+                           "pid": 0, "tid": running[0] if running else 1000, "ts": ts})
+        elif event in (EVT_ISR_ENTER, EVT_ISR_EXIT):
+            events.append({"name": ISR_NAMES.get(arg, "isr %d" % arg), "ph": "B" if event == EVT_ISR_ENTER else "E",
+                           "pid": 0, "tid": 1000, "ts": ts})
+    return events
+
+
+def main():
+    if len(sys.argv) < 2:
+        sys.exit(__doc__)
+    with open(sys.argv[1], "rb") as f:
+        tasks, records, total, subtick_hz = parse(f.read())
+    out = {"traceEvents": to_events(tasks, records, subtick_hz), "displayTimeUnit": "ns",
+           "otherData": {"records": len(records), "recordedTotal": total}}
+    if len(sys.argv) > 2:
+        with open(sys.argv[2], "w") as f:
+            json.dump(out, f, indent=1)
+    else:
+        json.dump(out, sys.stdout, indent=1)
+    if total > len(records):
+        sys.stderr.write("note: %d older records were overwritten in the ring buffer\n" % (total - len(records)))
+
+
+if __name__ == "__main__":
+    main()